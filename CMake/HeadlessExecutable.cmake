@@ -0,0 +1,95 @@
+################################################################################
+# Console programs built on the core classes, with no window or renderer -
+# like the benchmarks, which want the same compiler settings as the game
+#     add_headless_executable(<target> <sources...>)
+# Input:
+#     target  - Name of the executable
+#     sources - Its source files
+################################################################################
+function(add_headless_executable TARGET)
+    add_executable(${TARGET} ${ARGN})
+
+    use_props(${TARGET} "${CMAKE_CONFIGURATION_TYPES}" "${DEFAULT_CXX_PROPS}")
+
+    set_target_properties(${TARGET} PROPERTIES
+        VS_GLOBAL_KEYWORD "Win32Proj"
+    )
+    set_target_properties(${TARGET} PROPERTIES
+        INTERPROCEDURAL_OPTIMIZATION_RELEASE "TRUE"
+    )
+
+    ############################################################################
+    # Compile definitions
+    ############################################################################
+    if(MSVC)
+        target_compile_definitions(${TARGET} PRIVATE
+            "UNICODE;"
+            "_UNICODE"
+            "WIN32_LEAN_AND_MEAN"
+            "_WINSOCKAPI_"
+            "_WINSOCK2API_"
+            "_WINSOCK_DEPRECATED_NO_WARNINGS"
+        )
+    endif()
+
+    target_precompile_headers(${TARGET} PRIVATE
+        <vector>
+        <map>
+        <stack>
+        <string>
+        <list>
+        <thread>
+        <atomic>
+        <functional>
+        <iostream>
+        <set>
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector2.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector3.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector4.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Quaternion.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Plane.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Matrix2.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Matrix3.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Matrix4.h"
+    )
+
+    ############################################################################
+    # Compile and link options
+    ############################################################################
+    if(MSVC)
+        target_compile_options(${TARGET} PRIVATE
+            $<$<CONFIG:Release>:
+                /Oi;
+                /Gy
+            >
+            /permissive-;
+            /std:c++latest;
+            /sdl;
+            /W3;
+            ${DEFAULT_CXX_DEBUG_INFORMATION_FORMAT};
+            ${DEFAULT_CXX_EXCEPTION_HANDLING};
+            /Y-
+        )
+        target_link_options(${TARGET} PRIVATE
+            $<$<CONFIG:Release>:
+                /OPT:REF;
+                /OPT:ICF
+            >
+        )
+    endif()
+
+    ############################################################################
+    # Dependencies
+    ############################################################################
+    if(MSVC)
+        target_link_libraries(${TARGET} LINK_PUBLIC "Winmm.lib" "Psapi.lib")
+    endif()
+
+    target_include_directories(${TARGET} PRIVATE
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/"
+        "${CMAKE_SOURCE_DIR}/CSC8503CoreClasses/"
+    )
+
+    target_link_libraries(${TARGET} LINK_PUBLIC NCLCoreClasses)
+    target_link_libraries(${TARGET} LINK_PUBLIC CSC8503CoreClasses)
+endfunction()
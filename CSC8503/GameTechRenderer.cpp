@@ -42,6 +42,8 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 	lightRadius = 1000.0f;
 	lightPosition = Vector3(-200.0f, 60.0f, -200.0f);
 
+	objectListReady = false;
+
 	//Skybox!
 	skyboxShader = new OGLShader("skybox.vert", "skybox.frag");
 	skyboxMesh = new OGLMesh();
@@ -111,7 +113,10 @@ void GameTechRenderer::LoadSkybox() {
 void GameTechRenderer::RenderFrame() {
 	glEnable(GL_CULL_FACE);
 	glClearColor(1, 1, 1, 1);
-	BuildObjectList();
+	if (!objectListReady) {
+		BuildObjectList();
+	}
+	objectListReady = false;
 	SortObjectList();
 	RenderShadowMap();
 	RenderSkybox();
@@ -128,18 +133,23 @@ void GameTechRenderer::RenderFrame() {
 }
 
 void GameTechRenderer::BuildObjectList() {
-	activeObjects.clear();
-
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsActive()) {
-				const RenderObject* g = o->GetRenderObject();
-				if (g) {
-					activeObjects.emplace_back(g);
-				}
+	//Each object fills in its own entry, so they can be copied out in parallel - inactive ones are left without a mesh, and taken out after
+	activeObjects.resize(gameWorld.GetComponentCount<RenderObject>());
+	gameWorld.ParallelForEach<RenderObject>(
+		[&](int i, GameObject* owner, RenderObject* o) {
+			if (owner->IsActive()) {
+				activeObjects[i] = RenderListEntry{ o->GetMesh(), o->GetDefaultTexture(), o->GetShader(), o->GetTransform()->GetMatrix(), o->GetColour() };
+			}
+			else {
+				activeObjects[i].mesh = nullptr;
 			}
 		}
 	);
+	std::erase_if(activeObjects, [](const RenderListEntry& e) { return e.mesh == nullptr; });
+
+	debugLines		= Debug::GetDebugLines();
+	debugStrings	= Debug::GetDebugStrings();
+	objectListReady = true;
 }
 
 void GameTechRenderer::SortObjectList() {
@@ -165,11 +175,10 @@ void GameTechRenderer::RenderShadowMap() {
 	shadowMatrix = biasMatrix * mvMatrix; //we'll use this one later on
 
 	for (const auto&i : activeObjects) {
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		Matrix4 mvpMatrix	= mvMatrix * modelMatrix;
+		Matrix4 mvpMatrix	= mvMatrix * i.modelMatrix;
 		glUniformMatrix4fv(mvpLocation, 1, false, (float*)&mvpMatrix);
-		BindMesh((*i).GetMesh());
-		int layerCount = (*i).GetMesh()->GetSubMeshCount();
+		BindMesh(i.mesh);
+		int layerCount = i.mesh->GetSubMeshCount();
 		for (int i = 0; i < layerCount; ++i) {
 			DrawBoundMesh(i);
 		}
@@ -237,10 +246,10 @@ void GameTechRenderer::RenderCamera() {
 	glBindTexture(GL_TEXTURE_2D, shadowTex);
 
 	for (const auto&i : activeObjects) {
-		OGLShader* shader = (OGLShader*)(*i).GetShader();
+		OGLShader* shader = (OGLShader*)i.shader;
 		BindShader(shader);
 
-		BindTextureToShader((OGLTexture*)(*i).GetDefaultTexture(), "mainTex", 0);
+		BindTextureToShader((OGLTexture*)i.texture, "mainTex", 0);
 
 		if (activeShader != shader) {
 			projLocation	= glGetUniformLocation(shader->GetProgramID(), "projMatrix");
@@ -273,21 +282,19 @@ void GameTechRenderer::RenderCamera() {
 			activeShader = shader;
 		}
 
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		glUniformMatrix4fv(modelLocation, 1, false, (float*)&modelMatrix);			
+		glUniformMatrix4fv(modelLocation, 1, false, (float*)&i.modelMatrix);			
 		
-		Matrix4 fullShadowMat = shadowMatrix * modelMatrix;
+		Matrix4 fullShadowMat = shadowMatrix * i.modelMatrix;
 		glUniformMatrix4fv(shadowLocation, 1, false, (float*)&fullShadowMat);
 
-		Vector4 colour = i->GetColour();
-		glUniform4fv(colourLocation, 1, colour.array);
+		glUniform4fv(colourLocation, 1, i.colour.array);
 
-		glUniform1i(hasVColLocation, !(*i).GetMesh()->GetColourData().empty());
+		glUniform1i(hasVColLocation, !i.mesh->GetColourData().empty());
 
-		glUniform1i(hasTexLocation, (OGLTexture*)(*i).GetDefaultTexture() ? 1:0);
+		glUniform1i(hasTexLocation, (OGLTexture*)i.texture ? 1:0);
 
-		BindMesh((*i).GetMesh());
-		int layerCount = (*i).GetMesh()->GetSubMeshCount();
+		BindMesh(i.mesh);
+		int layerCount = i.mesh->GetSubMeshCount();
 		for (int i = 0; i < layerCount; ++i) {
 			DrawBoundMesh(i);
 		}
@@ -302,7 +309,7 @@ MeshGeometry* GameTechRenderer::LoadMesh(const string& name) {
 }
 
 void GameTechRenderer::NewRenderLines() {
-	const std::vector<Debug::DebugLineEntry>& lines = Debug::GetDebugLines();
+	const std::vector<Debug::DebugLineEntry>& lines = debugLines;
 	if (lines.empty()) {
 		return;
 	}
@@ -335,7 +342,7 @@ void GameTechRenderer::NewRenderLines() {
 }
 
 void GameTechRenderer::NewRenderText() {
-	const std::vector<Debug::DebugStringEntry>& strings = Debug::GetDebugStrings();
+	const std::vector<Debug::DebugStringEntry>& strings = debugStrings;
 	if (strings.empty()) {
 		return;
 	}
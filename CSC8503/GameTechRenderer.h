@@ -5,6 +5,7 @@
 #include "OGLMesh.h"
 
 #include "GameWorld.h"
+#include "Debug.h"
 
 namespace NCL {
 	class Maths::Vector3;
@@ -21,7 +22,27 @@ namespace NCL {
 			TextureBase*	LoadTexture(const string& name);
 			ShaderBase*		LoadShader(const string& vertex, const string& fragment);
 
+			/*
+			Copies out everything drawing the next frame will need - each
+			object's mesh, texture, shader, colour and model matrix, and the
+			debug lines and text - so that once it's done, the frame can be
+			drawn without looking at the world or the Debug lists again, even
+			while they're being changed on other threads.
+
+			RenderFrame calls this itself, unless it's already been called
+			since the last frame was drawn.
+			*/
+			void BuildObjectList();
+
 		protected:
+			struct RenderListEntry {
+				MeshGeometry*	mesh;
+				TextureBase*	texture;
+				ShaderBase*		shader;
+				Matrix4			modelMatrix;
+				Vector4			colour;
+			};
+
 			void NewRenderLines();
 			void NewRenderText();
 
@@ -31,7 +52,6 @@ namespace NCL {
 
 			GameWorld&	gameWorld;
 
-			void BuildObjectList();
 			void SortObjectList();
 			void RenderShadowMap();
 			void RenderCamera(); 
@@ -42,7 +62,11 @@ namespace NCL {
 			void SetDebugStringBufferSizes(size_t newVertCount);
 			void SetDebugLineBufferSizes(size_t newVertCount);
 
-			vector<const RenderObject*> activeObjects;
+			vector<RenderListEntry>	activeObjects;
+			bool					objectListReady;
+
+			vector<Debug::DebugLineEntry>	debugLines;
+			vector<Debug::DebugStringEntry>	debugStrings;
 
 			OGLShader*  debugShader;
 			OGLShader*  skyboxShader;
@@ -14,6 +14,7 @@
 
 #include "TutorialGame.h"
 #include "NetworkedGame.h"
+#include "PhysicsObject.h"
 
 #include "PushdownMachine.h"
 
@@ -29,12 +29,20 @@ void StateGameObject::Update(float dt) {
 	stateMachine->Update(dt);
 }
 
+//Adding a force can wake the body up, which isn't safe while other objects are updating
+void StateGameObject::ApplyCommands() {
+	if (queuedForce != Vector3()) {
+		GetPhysicsObject()->AddForce(queuedForce);
+		queuedForce = Vector3();
+	}
+}
+
 void StateGameObject::MoveLeft(float dt) {
-	GetPhysicsObject()->AddForce(Vector3(-100, 0, 0));
+	QueueForce(Vector3(-100, 0, 0));
 	counter += dt;
 }
 
 void StateGameObject::MoveRight(float dt) {
-	GetPhysicsObject()->AddForce(Vector3(100, 0, 0));
+	QueueForce(Vector3(100, 0, 0));
 	counter -= dt;
 }
\ No newline at end of file
@@ -15,12 +15,24 @@ namespace NCL {
 
             virtual void Update(float dt);
 
+            /*
+            Update doesn't push anything around itself, so that it can run
+            alongside other objects' Updates - it just keeps hold of what it
+            wants done, and this does it, from one thread, before physics.
+            */
+            virtual void ApplyCommands();
+
         protected:
             void MoveLeft(float dt);
             void MoveRight(float dt);
 
+            void QueueForce(const Vector3& force) {
+                queuedForce += force;
+            }
+
             StateMachine* stateMachine;
             float counter;
+            Vector3 queuedForce;
         };
     }
 }
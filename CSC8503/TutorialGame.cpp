@@ -28,7 +28,7 @@ PathfindingObject::PathfindingObject(NavigationGrid* grid, Vector3 startPos,
 	
 	stateMachine = new StateMachine();
 	time = 0;
-	this->player = player;
+	this->player = player->GetWorldHandle();
 	this->world = world;
 	this->mazeTargets = mazeTargets;
 	this->mazeBullets = mazeBullets;
@@ -71,7 +71,7 @@ PathfindingObject::PathfindingObject(NavigationGrid* grid, Vector3 startPos,
 				this->grid->FindPath(GetTransform().GetPosition(), dest, path);
 				path.PopWaypoint(destWaypoint);
 			}
-			GetPhysicsObject()->AddForce((this->destWaypoint - position).Normalised() * 100);
+			QueueForce((this->destWaypoint - position).Normalised() * 100);
 			time += dt;
 			Debug::DrawLine(dest, dest + Vector3(0, 1, 0),Vector4(0,1,0,1));
 			Debug::DrawLine(destWaypoint, destWaypoint + Vector3(0, 1, 0),Vector4(1,0,0,1));
@@ -81,12 +81,14 @@ PathfindingObject::PathfindingObject(NavigationGrid* grid, Vector3 startPos,
 	);
 	State* chasingPlayer = new State(
 		[&](float dt)->void {
+			GameObject* target = this->world->GetGameObject(this->player);
+			if (!target)return;
 			Vector3 position = GetTransform().GetPosition();
-			Vector3 deltaPos = this->player->GetTransform().GetPosition() - position;
-			GetPhysicsObject()->AddForce(deltaPos.Normalised() * 50);
+			Vector3 deltaPos = target->GetTransform().GetPosition() - position;
+			QueueForce(deltaPos.Normalised() * 50);
 			lastShotTime += dt;
 			if (lastShotTime >= invFireRate) {
-				Shoot(deltaPos.Normalised());
+				queuedShots.push_back(deltaPos.Normalised());
 				lastShotTime = 0;
 			}
 			
@@ -96,8 +98,8 @@ PathfindingObject::PathfindingObject(NavigationGrid* grid, Vector3 startPos,
 	stateMachine->AddState(movingForward);
 	stateMachine->AddState(chasingPlayer);
 
-	stateMachine->AddTransition(new StateTransition(movingForward, chasingPlayer, [&]()->bool {return CanSeePlayer(); }));
-	stateMachine->AddTransition(new StateTransition(chasingPlayer, movingForward, [&]()->bool {return !CanSeePlayer(); }));
+	stateMachine->AddTransition(new StateTransition(movingForward, chasingPlayer, [&]()->bool {return canSeePlayer; }));
+	stateMachine->AddTransition(new StateTransition(chasingPlayer, movingForward, [&]()->bool {return !canSeePlayer; }));
 	
 }
 
@@ -129,6 +131,7 @@ void PathfindingObject::Shoot(Vector3 direction) {
 
 	capsule->GetPhysicsObject()->SetInverseMass(0);
 	capsule->GetPhysicsObject()->InitCubeInertia();
+	capsule->GetPhysicsObject()->UseContinuousCollision(true); //So it can't skip through the maze walls
 
 	world->AddGameObject(capsule);
 
@@ -143,38 +146,42 @@ void PathfindingObject::Respawn() {
 }
 
 void PathfindingObject::Update(float dt) {
+	canSeePlayer = CanSeePlayer();
 	stateMachine->Update(dt);
 	//std::cout << CanSeePlayer();
 }
 
+//Bullets come out of the object pools and go into the world, so they're only fired from here
+void PathfindingObject::ApplyCommands() {
+	StateGameObject::ApplyCommands();
+	for (const Vector3& direction : queuedShots) {
+		Shoot(direction);
+	}
+	queuedShots.clear();
+}
+
 bool PathfindingObject::CanSeePlayer() {
-	Vector3 dirToPlayer = player->GetTransform().GetPosition() - GetTransform().GetPosition();
+	GameObject* target = world->GetGameObject(player);
+	if (!target)return false;
+	Vector3 dirToPlayer = target->GetTransform().GetPosition() - GetTransform().GetPosition();
 	dirToPlayer.Normalise();
 	Ray ray(GetTransform().GetPosition(),dirToPlayer);
 	RayCollision closestCollision;
-	if (world->Raycast(ray, closestCollision, true,this)) {
-		if (closestCollision.node == player) {
-			return true;
-		}
-		else return false;
-	}
-
-
+	GameObject* self = this;
+	//A batch of one ray for now, that goes straight through us
+	world->RaycastBatch(std::span<const Ray>(&ray, 1), std::span<RayCollision>(&closestCollision, 1), std::span<GameObject* const>(&self, 1));
+	return closestCollision.node == target;
 }
 
 Target* NCL::CSC8503::PathfindingObject::GetNearestMazeTarget(Vector3 from)
 {
 	if (mazeTargets->size() == 0)return nullptr;
-	Target* target = mazeTargets->at(0);
-	float lowestDist = (from - target->GetTransform().GetPosition()).LengthSquared();
-	for (int i = 1; i < mazeTargets->size(); i++)
-	{
-		float dist = (from - mazeTargets->at(i)->GetTransform().GetPosition()).LengthSquared();
-		if (dist < lowestDist) {
-			lowestDist = dist;
-			target = mazeTargets->at(i);
-		}
-	}
+	GameObject* nearest = nullptr;
+	world->FindNearest(from, std::span<GameObject*>(&nearest, 1), FLT_MAX, [&](GameObject* o) {
+		Target* t = dynamic_cast<Target*>(o);
+		return t && t->parentVector == mazeTargets;
+	});
+	Target* target = nearest ? (Target*)nearest : mazeTargets->at(0);
 	target->GetRenderObject()->SetColour(Vector4(1, 0, 0, 1));
 	return target;
 }
@@ -218,6 +225,11 @@ TutorialGame::TutorialGame()	{
 #endif
 
 	physics		= new PhysicsSystem(*world);
+	world->SetThreadPool(&physics->GetThreadPool());
+
+	jobs		= new JobSystem();
+	physics->GetThreadPool().UseJobSystem(jobs);
+	InitFrameGraph();
 
 	forceMagnitude	= 10.0f;
 	useGravity		= false;
@@ -261,10 +273,70 @@ TutorialGame::~TutorialGame()	{
 	delete basicShader;
 
 	delete physics;
+	delete jobs;
 	delete renderer;
 	delete world;
 }
 
+/*
+Everything UpdateGame does after input and the camera, as a graph of tasks
+for the job system. The renderer takes a copy of everything it needs first,
+and then draws it on the main thread, while the AI and physics update the
+world on the other threads - so each frame shows the world as it was at the
+start of that frame, and what physics does shows up in the next one.
+
+The AI tasks run side by side, so they don't change the world themselves.
+Adding a force can wake a body up, which moves it around in the physics
+body store everyone shares, and the pathfinder's bullets come out of the
+object pools and go into the world - none of which is safe from two threads
+at once. Instead, each AI object keeps hold of the forces and shots it
+wants, and the physics task applies them all before it steps.
+*/
+void TutorialGame::InitFrameGraph() {
+	TaskGraph::TaskID renderList = frameGraph.AddTask("Render List", [&]() {
+#ifndef USEVULKAN
+		renderer->BuildObjectList();
+		Debug::UpdateRenderables(frameDT);
+#endif
+	});
+	TaskGraph::TaskID stateObjects = frameGraph.AddTask("State Objects", [&]() {
+		if (testStateObject) {
+			testStateObject->Update(frameDT);
+		}
+	});
+	TaskGraph::TaskID pathfinding = frameGraph.AddTask("Pathfinding", [&]() {
+		if (pathfinder) {
+			pathfinder->Update(frameDT);
+		}
+	});
+	TaskGraph::TaskID physicsUpdate = frameGraph.AddTask("Physics", [&]() {
+		if (testStateObject) {
+			testStateObject->ApplyCommands();
+		}
+		if (pathfinder) {
+			pathfinder->ApplyCommands();
+		}
+		physics->Update(frameDT);
+	});
+	TaskGraph::TaskID render = frameGraph.AddTask("Render", [&]() {
+		renderer->Render();
+#ifdef USEVULKAN
+		Debug::UpdateRenderables(frameDT);
+#endif
+	}, true);
+
+	frameGraph.AddDependency(renderList, stateObjects);
+	frameGraph.AddDependency(renderList, pathfinding);
+	frameGraph.AddDependency(stateObjects, physicsUpdate);
+	frameGraph.AddDependency(pathfinding, physicsUpdate);
+#ifdef USEVULKAN
+	//The Vulkan renderer still reads the world while it draws, so it has to wait for it to be finished with
+	frameGraph.AddDependency(physicsUpdate, render);
+#else
+	frameGraph.AddDependency(renderList, render);
+#endif
+}
+
 void TutorialGame::UpdateRLCam() {
 	Vector3 objPos = lockedObject->GetTransform().GetPosition();
 
@@ -374,16 +446,9 @@ void TutorialGame::UpdateGame(float dt) {
 
 	world->UpdateWorld(dt);
 	renderer->Update(dt);
-	physics->Update(dt);
-
-	renderer->Render();
-	Debug::UpdateRenderables(dt);
-
 
-	if (testStateObject)testStateObject->Update(dt);
-	if (pathfinder != NULL && pathfinder != nullptr) {
-		pathfinder->Update(dt);
-	}
+	frameDT = dt;
+	frameGraph.Run(*jobs);
 }
 
 void TutorialGame::UpdateKeys(float dt) {
@@ -429,6 +494,8 @@ void TutorialGame::UpdateKeys(float dt) {
 		world->ShuffleObjects(false);
 	}
 
+	UpdatePhysicsKeys();
+
 	if (lockedObject) {
 		LockedObjectMovement(dt);
 	}
@@ -437,6 +504,34 @@ void TutorialGame::UpdateKeys(float dt) {
 	}
 }
 
+/*
+The physics system doesn't read the keyboard itself, so that it can run
+without a window (on a server, or in the benchmark) - these are its debug
+toggles.
+*/
+void TutorialGame::UpdatePhysicsKeys() {
+	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::B)) {
+		physics->UseBroadPhase(!physics->IsUsingBroadPhase());
+		std::cout << "Setting broadphase to " << physics->IsUsingBroadPhase() << std::endl;
+	}
+	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::N)) {
+		switch (physics->GetBroadPhaseContainer()) {
+			case BroadPhaseContainer::QuadTree:		physics->SetBroadPhaseContainer(BroadPhaseContainer::DynamicTree); break;
+			case BroadPhaseContainer::DynamicTree:	physics->SetBroadPhaseContainer(BroadPhaseContainer::SweepAndPrune); break;
+			case BroadPhaseContainer::SweepAndPrune:physics->SetBroadPhaseContainer(BroadPhaseContainer::QuadTree); break;
+		}
+		std::cout << "Setting broad container to " << (int)physics->GetBroadPhaseContainer() << std::endl;
+	}
+	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::I)) {
+		physics->SetConstraintIterationCount(physics->GetConstraintIterationCount() - 1);
+		std::cout << "Setting constraint iterations to " << physics->GetConstraintIterationCount() << std::endl;
+	}
+	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::O)) {
+		physics->SetConstraintIterationCount(physics->GetConstraintIterationCount() + 1);
+		std::cout << "Setting constraint iterations to " << physics->GetConstraintIterationCount() << std::endl;
+	}
+}
+
 void TutorialGame::RLMovement(float dt) {
 	Matrix4 view = world->GetMainCamera()->BuildViewMatrix();
 	Matrix4 camWorld = view.Inverse();
@@ -832,21 +927,17 @@ void TutorialGame::GenerateTargets() {
 		pos.y = rand() % 50;
 		pos.z = rand() % 50;
 		targets[i] = AddTargetToWorld(pos);
+		targets[i]->isGeneratedTarget = true;
 	}
 }
 
 Target* TutorialGame::GetNearestTarget() {
-	Target* target = targets[0];
-	float lowestDist = (player->GetTransform().GetPosition() - target->GetTransform().GetPosition()).Length();
-	for (int i = 1; i < NUM_TARGETS; i++)
-	{
-		float dist = (player->GetTransform().GetPosition() - targets[i]->GetTransform().GetPosition()).Length();
-		if (dist < lowestDist) {
-			dist = lowestDist;
-			target = targets[i];
-		}
-	}
-	return target;
+	GameObject* nearest = nullptr;
+	world->FindNearest(player->GetTransform().GetPosition(), std::span<GameObject*>(&nearest, 1), FLT_MAX, [&](GameObject* o) {
+		Target* t = dynamic_cast<Target*>(o);
+		return t && t->isGeneratedTarget;
+	});
+	return nearest ? (Target*)nearest : targets[0];
 }
 
 
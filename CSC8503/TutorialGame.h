@@ -4,6 +4,7 @@
 #include "GameTechVulkanRenderer.h"
 #endif
 #include "PhysicsSystem.h"
+#include "TaskGraph.h"
 
 #include "StateGameObject.h"
 
@@ -158,6 +159,7 @@ namespace NCL {
 			 GameWorld* world;
 			 std::vector<Target*>* parentVector;
 			 int* score;
+			 bool isGeneratedTarget = false;	//One of TutorialGame's targets, which GetNearestTarget picks from
 		};
 		class FrictionTarget : public Target {
 		public:
@@ -191,6 +193,7 @@ namespace NCL {
 			void Shoot(Vector3 direction);
 
 			virtual void Update(float dt);
+			void ApplyCommands() override;
 			bool CanSeePlayer();
 			Target* GetNearestMazeTarget(Vector3 from);
 			std::vector<Target*>* mazeTargets;
@@ -207,7 +210,7 @@ namespace NCL {
 			Vector3 dest;
 			Vector3 destWaypoint;
 			float time;
-			GameObject* player;
+			GameObjectHandle player;
 			GameWorld* world;
 			NavigationGrid* grid;
 			int* testInt = new int(123456);
@@ -219,6 +222,8 @@ namespace NCL {
 			float invFireRate;
 			float lastShotTime;
 			bool recalculatePath;
+			bool canSeePlayer = false;	//Checked once per Update, rather than by each transition
+			std::vector<Vector3> queuedShots;	//Directions to fire in, next ApplyCommands
 
 			
 		};
@@ -292,7 +297,9 @@ namespace NCL {
 			void InitialiseAssets();
 
 			void InitCamera();
+			void InitFrameGraph();
 			void UpdateKeys(float dt);
+			void UpdatePhysicsKeys();
 
 			void Reset();
 
@@ -353,6 +360,10 @@ namespace NCL {
 			PhysicsSystem*		physics;
 			GameWorld*			world;
 
+			JobSystem*			jobs;
+			TaskGraph			frameGraph;
+			float				frameDT = 0.0f;	//For the frame graph's tasks
+
 			bool useGravity;
 			bool inSelectionMode;
 
@@ -383,7 +394,7 @@ namespace NCL {
 
 			StateGameObject* AddStateObjectToWorld(const Vector3& position);
 			PathfindingObject* AddPathfindingObjectToWorld(const Vector3& pos);
-			StateGameObject* testStateObject;
+			StateGameObject* testStateObject = nullptr;
 
 			std::vector<GameObject*> mazeAABBs;
 			std::vector<Target*> mazeTargets;
@@ -4,7 +4,7 @@
 
 namespace NCL {
 	using namespace NCL::Maths;
-	class AABBVolume : CollisionVolume
+	class AABBVolume : public CollisionVolume
 	{
 	public:
 		AABBVolume(const Vector3& halfDims) {
@@ -22,4 +22,5 @@ namespace NCL {
 	protected:
 		Vector3 halfSizes;
 	};
+	static_assert(sizeof(AABBVolume) <= CollisionVolume::PooledSize, "AABBVolume won't fit in a pooled volume block");
 }
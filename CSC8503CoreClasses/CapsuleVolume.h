@@ -25,5 +25,6 @@ namespace NCL {
         float radius;
         float halfHeight;
     };
+    static_assert(sizeof(CapsuleVolume) <= CollisionVolume::PooledSize, "CapsuleVolume won't fit in a pooled volume block");
 }
 
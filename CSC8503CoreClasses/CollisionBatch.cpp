@@ -0,0 +1,483 @@
+#include "CollisionBatch.h"
+#include "CollisionDetection.h"
+#include "SimdFloat.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+CollisionBatch::PairType CollisionBatch::GetPairType(const GameObject* a, const GameObject* b, bool& swapped) {
+	swapped = false;
+	const CollisionVolume* volA = a->GetBoundingVolume();
+	const CollisionVolume* volB = b->GetBoundingVolume();
+	if (!volA || !volB) {
+		return Other;
+	}
+	VolumeType typeA = volA->type;
+	VolumeType typeB = volB->type;
+
+	if (typeA == VolumeType::Sphere && typeB == VolumeType::Sphere) {
+		return SphereSphere;
+	}
+	if (typeA == VolumeType::AABB && typeB == VolumeType::AABB) {
+		return AABBAABB;
+	}
+	if (typeA == VolumeType::OBB && typeB == VolumeType::OBB) {
+		return OBBOBB;
+	}
+	//For the mixed pairs, the box always goes first
+	if (typeA == VolumeType::Sphere && typeB != VolumeType::Sphere) {
+		std::swap(typeA, typeB);
+		swapped = true;
+	}
+	else if (typeA == VolumeType::AABB && typeB == VolumeType::OBB) {
+		std::swap(typeA, typeB);
+		swapped = true;
+	}
+
+	if (typeA == VolumeType::AABB && typeB == VolumeType::Sphere) {
+		return AABBSphere;
+	}
+	if (typeA == VolumeType::OBB && typeB == VolumeType::Sphere) {
+		return OBBSphere;
+	}
+	if (typeA == VolumeType::OBB && typeB == VolumeType::AABB) {
+		return OBBAABB;
+	}
+	swapped = false;
+	return Other;
+}
+
+static void GetVolumeSize(const CollisionVolume* volume, Vector3& size) {
+	switch (volume->type) {
+		case VolumeType::AABB:		size = ((const AABBVolume&)*volume).GetHalfDimensions(); break;
+		case VolumeType::OBB:		size = ((const OBBVolume&)*volume).GetHalfDimensions(); break;
+		case VolumeType::Sphere:	size = Vector3(((const SphereVolume&)*volume).GetRadius(), 0, 0); break;
+		default:					size = Vector3(); break;
+	}
+}
+
+void CollisionBatch::AddPair(GameObject* a, GameObject* b) {
+	objectA.push_back(a);
+	objectB.push_back(b);
+	if (pairType == Other) {
+		return; //These are tested straight from the objects
+	}
+	Transform& transformA = a->GetTransform();
+	Transform& transformB = b->GetTransform();
+
+	Vector3 pos = transformA.GetPosition();
+	posAX.push_back(pos.x); posAY.push_back(pos.y); posAZ.push_back(pos.z);
+	pos = transformB.GetPosition();
+	posBX.push_back(pos.x); posBY.push_back(pos.y); posBZ.push_back(pos.z);
+
+	Quaternion orient = transformA.GetOrientation();
+	orientAX.push_back(orient.x); orientAY.push_back(orient.y); orientAZ.push_back(orient.z); orientAW.push_back(orient.w);
+	orient = transformB.GetOrientation();
+	orientBX.push_back(orient.x); orientBY.push_back(orient.y); orientBZ.push_back(orient.z); orientBW.push_back(orient.w);
+
+	Vector3 size;
+	GetVolumeSize(a->GetBoundingVolume(), size);
+	sizeAX.push_back(size.x); sizeAY.push_back(size.y); sizeAZ.push_back(size.z);
+	GetVolumeSize(b->GetBoundingVolume(), size);
+	sizeBX.push_back(size.x); sizeBY.push_back(size.y); sizeBZ.push_back(size.z);
+}
+
+void CollisionBatch::Clear() {
+	objectA.clear();
+	objectB.clear();
+	std::vector<float>* arrays[] = {
+		&posAX, &posAY, &posAZ, &posBX, &posBY, &posBZ,
+		&orientAX, &orientAY, &orientAZ, &orientAW,
+		&orientBX, &orientBY, &orientBZ, &orientBW,
+		&sizeAX, &sizeAY, &sizeAZ, &sizeBX, &sizeBY, &sizeBZ
+	};
+	for (std::vector<float>* a : arrays) {
+		a->clear();
+	}
+}
+
+/*
+The batched tests. Each one works through the pairs SimdFloat::Width at a
+time, doing exactly the same sums as its scalar version above in
+CollisionDetection.cpp, just on a whole register of pairs at once. Branches
+turn into masks - every lane does all the work, and the lanes that didn't
+collide are ignored at the end. Only the pairs that did collide are unpacked
+into a CollisionInfo.
+
+Whatever is left over at the end of the range, too few to fill a register,
+goes through ObjectIntersection instead.
+*/
+namespace {
+	struct SimdVector3 {
+		SimdFloat x, y, z;
+	};
+
+	SimdVector3 LoadVector(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z, int i) {
+		return { SimdFloat::Load(&x[i]), SimdFloat::Load(&y[i]), SimdFloat::Load(&z[i]) };
+	}
+
+	SimdVector3 operator-(const SimdVector3& a, const SimdVector3& b) {
+		return { a.x - b.x, a.y - b.y, a.z - b.z };
+	}
+
+	SimdVector3 operator-(const SimdVector3& a) {
+		return { -a.x, -a.y, -a.z };
+	}
+
+	SimdVector3 operator*(const SimdVector3& a, const SimdFloat& f) {
+		return { a.x * f, a.y * f, a.z * f };
+	}
+
+	SimdFloat Dot(const SimdVector3& a, const SimdVector3& b) {
+		return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+	}
+
+	SimdVector3 Cross(const SimdVector3& a, const SimdVector3& b) {
+		return { (a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x) };
+	}
+
+	SimdVector3 Select(const SimdMask& m, const SimdVector3& a, const SimdVector3& b) {
+		return { Select(m, a.x, b.x), Select(m, a.y, b.y), Select(m, a.z, b.z) };
+	}
+
+	//Like Vector3::Normalise, zero length vectors are left alone
+	SimdVector3 Normalised(const SimdVector3& a, const SimdFloat& length) {
+		SimdFloat scale = Select(length != SimdFloat(0.0f), SimdFloat(1.0f) / length, SimdFloat(1.0f));
+		return a * scale;
+	}
+
+	SimdVector3 Normalised(const SimdVector3& a) {
+		return Normalised(a, Sqrt(Dot(a, a)));
+	}
+
+	//The same q * v * q^-1 sandwich as Quaternion::operator*(Vector3)
+	SimdVector3 Rotate(const SimdFloat& qx, const SimdFloat& qy, const SimdFloat& qz, const SimdFloat& qw, const SimdVector3& v) {
+		SimdFloat tx = (qw * v.x) + (qy * v.z) - (qz * v.y);
+		SimdFloat ty = (qw * v.y) + (qz * v.x) - (qx * v.z);
+		SimdFloat tz = (qw * v.z) + (qx * v.y) - (qy * v.x);
+		SimdFloat tw = -(qx * v.x) - (qy * v.y) - (qz * v.z);
+
+		SimdFloat cx = -qx;
+		SimdFloat cy = -qy;
+		SimdFloat cz = -qz;
+		return {
+			(tx * qw) + (tw * cx) + (ty * cz) - (tz * cy),
+			(ty * qw) + (tw * cy) + (tz * cx) - (tx * cz),
+			(tz * qw) + (tw * cz) + (tx * cy) - (ty * cx)
+		};
+	}
+
+	struct Lanes {
+		float x[SimdFloat::Width];
+		float y[SimdFloat::Width];
+		float z[SimdFloat::Width];
+
+		Lanes(const SimdVector3& v) {
+			v.x.Store(x);
+			v.y.Store(y);
+			v.z.Store(z);
+		}
+
+		Vector3 operator[](int lane) const {
+			return Vector3(x[lane], y[lane], z[lane]);
+		}
+	};
+
+	void AddCollision(const CollisionBatch& batch, int pair, const Vector3& localA, const Vector3& localB,
+		const Vector3& normal, float penetration, std::vector<CollisionDetection::CollisionInfo>& collisions) {
+		CollisionDetection::CollisionInfo info;
+		info.a = batch.GetObjectA(pair);
+		info.b = batch.GetObjectB(pair);
+		info.AddContactPoint(localA, localB, normal, penetration, false);
+		collisions.push_back(info);
+	}
+}
+
+void CollisionDetection::BatchIntersection(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	switch (batch.GetType()) {
+		case CollisionBatch::SphereSphere:	SphereIntersectionBatch(batch, begin, end, collisions); break;
+		case CollisionBatch::AABBAABB:		AABBIntersectionBatch(batch, begin, end, collisions); break;
+		case CollisionBatch::AABBSphere:	AABBSphereIntersectionBatch(batch, begin, end, collisions); break;
+		case CollisionBatch::OBBSphere:		OBBSphereIntersectionBatch(batch, begin, end, collisions); break;
+		case CollisionBatch::OBBOBB:
+		case CollisionBatch::OBBAABB:		OBBIntersectionBatch(batch, begin, end, collisions); break;
+		default:							ObjectIntersectionBatch(batch, begin, end, collisions); break;
+	}
+}
+
+void CollisionDetection::ObjectIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	for (int i = begin; i < end; ++i) {
+		CollisionInfo info;
+		if (ObjectIntersection(batch.GetObjectA(i), batch.GetObjectB(i), info)) {
+			collisions.push_back(info);
+		}
+	}
+}
+
+void CollisionDetection::SphereIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	int i = begin;
+	for (; i + SimdFloat::Width <= end; i += SimdFloat::Width) {
+		SimdFloat radiusA = SimdFloat::Load(&batch.sizeAX[i]);
+		SimdFloat radiusB = SimdFloat::Load(&batch.sizeBX[i]);
+		SimdFloat radii = radiusA + radiusB;
+
+		SimdVector3 delta	= LoadVector(batch.posBX, batch.posBY, batch.posBZ, i) - LoadVector(batch.posAX, batch.posAY, batch.posAZ, i);
+		SimdFloat length	= Sqrt(Dot(delta, delta));
+
+		int hits = (length < radii).GetBits();
+		if (hits == 0) {
+			continue;
+		}
+		SimdVector3 normal = Normalised(delta, length);
+
+		float pen[SimdFloat::Width];
+		(radii - length).Store(pen);
+		Lanes normals(normal);
+		Lanes localAs(normal * radiusA);
+		Lanes localBs(-normal * radiusB);
+
+		for (int lane = 0; lane < SimdFloat::Width; ++lane) {
+			if (hits & (1 << lane)) {
+				AddCollision(batch, i + lane, localAs[lane], localBs[lane], normals[lane], pen[lane], collisions);
+			}
+		}
+	}
+	ObjectIntersectionBatch(batch, i, end, collisions);
+}
+
+void CollisionDetection::AABBIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	static const Vector3 faces[6] = {
+		Vector3(-1, 0, 0), Vector3(1, 0, 0),
+		Vector3(0, -1, 0), Vector3(0, 1, 0),
+		Vector3(0, 0, -1), Vector3(0, 0, 1),
+	};
+
+	int i = begin;
+	for (; i + SimdFloat::Width <= end; i += SimdFloat::Width) {
+		SimdVector3 posA	= LoadVector(batch.posAX, batch.posAY, batch.posAZ, i);
+		SimdVector3 posB	= LoadVector(batch.posBX, batch.posBY, batch.posBZ, i);
+		SimdVector3 sizeA	= LoadVector(batch.sizeAX, batch.sizeAY, batch.sizeAZ, i);
+		SimdVector3 sizeB	= LoadVector(batch.sizeBX, batch.sizeBY, batch.sizeBZ, i);
+
+		SimdVector3 delta = posB - posA;
+		SimdMask overlap =
+			(Abs(delta.x) < sizeA.x + sizeB.x) &
+			(Abs(delta.y) < sizeA.y + sizeB.y) &
+			(Abs(delta.z) < sizeA.z + sizeB.z);
+
+		int hits = overlap.GetBits();
+		if (hits == 0) {
+			continue;
+		}
+		SimdFloat distances[6] = {
+			(posB.x + sizeB.x) - (posA.x - sizeA.x),
+			(posA.x + sizeA.x) - (posB.x - sizeB.x),
+			(posB.y + sizeB.y) - (posA.y - sizeA.y),
+			(posA.y + sizeA.y) - (posB.y - sizeB.y),
+			(posB.z + sizeB.z) - (posA.z - sizeA.z),
+			(posA.z + sizeA.z) - (posB.z - sizeB.z),
+		};
+		SimdFloat bestPen	= distances[0];
+		SimdFloat bestFace	= 0.0f;
+		for (int f = 1; f < 6; ++f) {
+			SimdMask better = distances[f] < bestPen;
+			bestPen		= Select(better, distances[f], bestPen);
+			bestFace	= Select(better, SimdFloat((float)f), bestFace);
+		}
+
+		float pen[SimdFloat::Width];
+		float face[SimdFloat::Width];
+		bestPen.Store(pen);
+		bestFace.Store(face);
+
+		for (int lane = 0; lane < SimdFloat::Width; ++lane) {
+			if (hits & (1 << lane)) {
+				AddCollision(batch, i + lane, Vector3(), Vector3(), faces[(int)face[lane]], pen[lane], collisions);
+			}
+		}
+	}
+	ObjectIntersectionBatch(batch, i, end, collisions);
+}
+
+void CollisionDetection::AABBSphereIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	int i = begin;
+	for (; i + SimdFloat::Width <= end; i += SimdFloat::Width) {
+		SimdVector3 boxSize = LoadVector(batch.sizeAX, batch.sizeAY, batch.sizeAZ, i);
+		SimdFloat	radius	= SimdFloat::Load(&batch.sizeBX[i]);
+
+		SimdVector3 delta = LoadVector(batch.posBX, batch.posBY, batch.posBZ, i) - LoadVector(batch.posAX, batch.posAY, batch.posAZ, i);
+		SimdVector3 closestPointOnBox = {
+			Min(Max(delta.x, -boxSize.x), boxSize.x),
+			Min(Max(delta.y, -boxSize.y), boxSize.y),
+			Min(Max(delta.z, -boxSize.z), boxSize.z)
+		};
+		SimdVector3 localPoint	= delta - closestPointOnBox;
+		SimdFloat	distance	= Sqrt(Dot(localPoint, localPoint));
+
+		int hits = (distance < radius).GetBits();
+		if (hits == 0) {
+			continue;
+		}
+		SimdVector3 normal = Normalised(localPoint, distance);
+
+		float pen[SimdFloat::Width];
+		(radius - distance).Store(pen);
+		Lanes normals(normal);
+		Lanes localBs(-normal * radius);
+
+		for (int lane = 0; lane < SimdFloat::Width; ++lane) {
+			if (hits & (1 << lane)) {
+				AddCollision(batch, i + lane, Vector3(), localBs[lane], normals[lane], pen[lane], collisions);
+			}
+		}
+	}
+	ObjectIntersectionBatch(batch, i, end, collisions);
+}
+
+void CollisionDetection::OBBSphereIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	int i = begin;
+	for (; i + SimdFloat::Width <= end; i += SimdFloat::Width) {
+		SimdVector3 boxSize = LoadVector(batch.sizeAX, batch.sizeAY, batch.sizeAZ, i);
+		SimdFloat	radius	= SimdFloat::Load(&batch.sizeBX[i]);
+
+		SimdFloat qx = SimdFloat::Load(&batch.orientAX[i]);
+		SimdFloat qy = SimdFloat::Load(&batch.orientAY[i]);
+		SimdFloat qz = SimdFloat::Load(&batch.orientAZ[i]);
+		SimdFloat qw = SimdFloat::Load(&batch.orientAW[i]);
+
+		SimdVector3 delta = LoadVector(batch.posBX, batch.posBY, batch.posBZ, i) - LoadVector(batch.posAX, batch.posAY, batch.posAZ, i);
+		delta = Rotate(-qx, -qy, -qz, qw, delta); //Into the box's space
+
+		SimdVector3 closestPointOnBox = {
+			Min(Max(delta.x, -boxSize.x), boxSize.x),
+			Min(Max(delta.y, -boxSize.y), boxSize.y),
+			Min(Max(delta.z, -boxSize.z), boxSize.z)
+		};
+		SimdVector3 localPoint	= delta - closestPointOnBox;
+		SimdFloat	distance	= Sqrt(Dot(localPoint, localPoint));
+
+		int hits = (distance < radius).GetBits();
+		if (hits == 0) {
+			continue;
+		}
+		SimdVector3 normal = Rotate(qx, qy, qz, qw, Normalised(localPoint, distance));
+
+		float pen[SimdFloat::Width];
+		(radius - distance).Store(pen);
+		Lanes normals(normal);
+		Lanes localAs(closestPointOnBox);
+		Lanes localBs(-normal * radius);
+
+		for (int lane = 0; lane < SimdFloat::Width; ++lane) {
+			if (hits & (1 << lane)) {
+				AddCollision(batch, i + lane, localAs[lane], localBs[lane], normals[lane], pen[lane], collisions);
+			}
+		}
+	}
+	ObjectIntersectionBatch(batch, i, end, collisions);
+}
+
+/*
+All 15 separating axes are tested for every lane, in the same order as
+OBBIntersection, keeping track of the shallowest one. A lane is done with
+as soon as it finds an axis that separates the boxes, so once every lane
+has found one, the rest of the axes are skipped.
+
+OBB / AABB pairs come through here too - just like OBBAABBIntersection, the
+AABB is treated as an OBB, with the contact point on it put at its centre.
+*/
+void CollisionDetection::OBBIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions) {
+	const bool boxBIsAABB = batch.GetType() == CollisionBatch::OBBAABB;
+
+	const SimdVector3 right		= { 1.0f, 0.0f, 0.0f };
+	const SimdVector3 up		= { 0.0f, 1.0f, 0.0f };
+	const SimdVector3 forward	= { 0.0f, 0.0f, 1.0f };
+
+	int i = begin;
+	for (; i + SimdFloat::Width <= end; i += SimdFloat::Width) {
+		SimdFloat qax = SimdFloat::Load(&batch.orientAX[i]);
+		SimdFloat qay = SimdFloat::Load(&batch.orientAY[i]);
+		SimdFloat qaz = SimdFloat::Load(&batch.orientAZ[i]);
+		SimdFloat qaw = SimdFloat::Load(&batch.orientAW[i]);
+		SimdFloat qbx = SimdFloat::Load(&batch.orientBX[i]);
+		SimdFloat qby = SimdFloat::Load(&batch.orientBY[i]);
+		SimdFloat qbz = SimdFloat::Load(&batch.orientBZ[i]);
+		SimdFloat qbw = SimdFloat::Load(&batch.orientBW[i]);
+
+		SimdVector3 ARight		= Rotate(qax, qay, qaz, qaw, right);
+		SimdVector3 AUp			= Rotate(qax, qay, qaz, qaw, up);
+		SimdVector3 AForward	= Rotate(qax, qay, qaz, qaw, forward);
+		SimdVector3 BRight		= Rotate(qbx, qby, qbz, qbw, right);
+		SimdVector3 BUp			= Rotate(qbx, qby, qbz, qbw, up);
+		SimdVector3 BForward	= Rotate(qbx, qby, qbz, qbw, forward);
+
+		SimdVector3 sizeA = LoadVector(batch.sizeAX, batch.sizeAY, batch.sizeAZ, i);
+		SimdVector3 sizeB = LoadVector(batch.sizeBX, batch.sizeBY, batch.sizeBZ, i);
+
+		SimdVector3 extents[6] = {
+			ARight * sizeA.x, AUp * sizeA.y, AForward * sizeA.z,
+			BRight * sizeB.x, BUp * sizeB.y, BForward * sizeB.z
+		};
+
+		SimdVector3 delta = LoadVector(batch.posBX, batch.posBY, batch.posBZ, i) - LoadVector(batch.posAX, batch.posAY, batch.posAZ, i);
+
+		SimdVector3 axesA[3] = { ARight, AUp, AForward };
+		SimdVector3 axesB[3] = { BRight, BUp, BForward };
+
+		SimdMask	overlapping = SimdMask::All();
+		SimdFloat	penDistance = FLT_MAX;
+		SimdVector3 normal;
+
+		for (int p = 0; p < 15 && overlapping.Any(); ++p) {
+			SimdVector3 plane;
+			if (p < 3) {
+				plane = Normalised(axesA[p]);
+			}
+			else if (p < 6) {
+				plane = Normalised(axesB[p - 3]);
+			}
+			else {
+				plane = Normalised(Cross(axesA[(p - 6) / 3], axesB[(p - 6) % 3]));
+			}
+			SimdFloat deltaPlaneDot = Abs(Dot(delta, plane));
+			SimdFloat rest =
+				Abs(Dot(extents[0], plane)) +
+				Abs(Dot(extents[1], plane)) +
+				Abs(Dot(extents[2], plane)) +
+
+				Abs(Dot(extents[3], plane)) +
+				Abs(Dot(extents[4], plane)) +
+				Abs(Dot(extents[5], plane));
+
+			SimdMask overlap = deltaPlaneDot <= rest;
+			overlapping = overlapping & overlap;
+
+			SimdFloat	planePen	= rest - deltaPlaneDot;
+			SimdMask	better		= overlap & (planePen < penDistance) & (Dot(plane, plane) > SimdFloat(0.0f));
+			penDistance = Select(better, planePen, penDistance);
+			normal		= Select(better, plane, normal);
+		}
+
+		int hits = overlapping.GetBits();
+		if (hits == 0) {
+			continue;
+		}
+		normal = Select(Dot(normal, delta) < SimdFloat(0.0f), -normal, normal);
+
+		float pen[SimdFloat::Width];
+		penDistance.Store(pen);
+		Lanes normals(normal);
+
+		for (int lane = 0; lane < SimdFloat::Width; ++lane) {
+			if (!(hits & (1 << lane))) {
+				continue;
+			}
+			GameObject* a = batch.GetObjectA(i + lane);
+			GameObject* b = batch.GetObjectB(i + lane);
+			Vector3 pointA = OBBSupport(a->GetTransform(), normals[lane]);
+			Vector3 pointB = boxBIsAABB ? Vector3() : OBBSupport(b->GetTransform(), -normals[lane]);
+			AddCollision(batch, i + lane, pointA, pointB, normals[lane], pen[lane], collisions);
+		}
+	}
+	ObjectIntersectionBatch(batch, i, end, collisions);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+namespace NCL {
+	class CollisionDetection;
+
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		A list of object pairs that all have the same combination of volume
+		types, ready for one of the batched intersection tests in
+		CollisionDetection to work through.
+
+		Adding a pair copies out everything the test will need - positions,
+		orientations and volume sizes - into one float array per component,
+		so the test can load the values for a whole SIMD register of pairs
+		in one go. Spheres keep their radius in the first size component.
+
+		Mixed pairs are stored the same way round ObjectIntersection would
+		test them (the box first, then the sphere, and so on), which is why
+		GetPairType needs to know if it had to swap them.
+		*/
+		class CollisionBatch {
+		public:
+			enum PairType {
+				SphereSphere,
+				AABBAABB,
+				AABBSphere,
+				OBBSphere,
+				OBBOBB,
+				OBBAABB,
+				Other,			//Anything without a batched test - these go through ObjectIntersection
+				PairTypeCount
+			};
+
+			CollisionBatch(PairType type = Other) {
+				pairType = type;
+			}
+			~CollisionBatch() {}
+
+			static PairType GetPairType(const GameObject* a, const GameObject* b, bool& swapped);
+
+			void AddPair(GameObject* a, GameObject* b);
+			void Clear();
+
+			PairType GetType() const {
+				return pairType;
+			}
+
+			int GetPairCount() const {
+				return (int)objectA.size();
+			}
+
+			GameObject* GetObjectA(int pair) const {
+				return objectA[pair];
+			}
+			GameObject* GetObjectB(int pair) const {
+				return objectB[pair];
+			}
+
+		protected:
+			friend class NCL::CollisionDetection;
+
+			PairType pairType;
+
+			std::vector<GameObject*> objectA;
+			std::vector<GameObject*> objectB;
+
+			std::vector<float> posAX, posAY, posAZ;
+			std::vector<float> posBX, posBY, posBZ;
+
+			std::vector<float> orientAX, orientAY, orientAZ, orientAW;
+			std::vector<float> orientBX, orientBY, orientBZ, orientBW;
+
+			std::vector<float> sizeAX, sizeAY, sizeAZ;
+			std::vector<float> sizeBX, sizeBY, sizeBZ;
+		};
+	}
+}
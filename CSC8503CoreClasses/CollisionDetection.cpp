@@ -249,9 +249,9 @@ bool CollisionDetection::AABBTest(const Vector3& posA, const Vector3& posB, cons
 	Vector3 delta = posB - posA;
 	Vector3 totalSize = halfSizeA + halfSizeB;
 
-	if (abs(delta.x) < totalSize.x &&
-		abs(delta.y) < totalSize.y &&
-		abs(delta.z) < totalSize.z) {
+	if (std::abs(delta.x) < totalSize.x &&
+		std::abs(delta.y) < totalSize.y &&
+		std::abs(delta.z) < totalSize.z) {
 		return true;
 	}
 	return false;
@@ -368,9 +368,6 @@ bool CollisionDetection::CapsuleIntersection(const CapsuleVolume& volumeA, const
 
 	Vector3 delta = bestB - bestA;
 	float deltaLen = delta.Length();
-	if (Window::GetWindow()->GetKeyboard()->KeyDown(KeyboardKeys::L)) {
-		bool a = false;
-	}
 	if (volumeA.GetRadius() + volumeB.GetRadius() - deltaLen > 0) {
 		float pen = volumeA.GetRadius() + volumeB.GetRadius() - (bestB - bestA).Length();
 		Vector3 normal = (bestB - bestA).Normalised();
@@ -671,6 +668,195 @@ Matrix4 GenerateInverseProjection(float aspect, float nearPlane, float farPlane,
 	return m;
 }
 
+//Which face of a box a point on its surface is on
+static Vector3 BoxFaceNormal(const Vector3& localPoint, const Vector3& halfSize) {
+	int		axis	= 0;
+	float	best	= -1.0f;
+	for (int i = 0; i < 3; ++i) {
+		float d = std::abs(localPoint[i]) / halfSize[i];
+		if (d > best) {
+			best = d;
+			axis = i;
+		}
+	}
+	Vector3 normal;
+	normal[axis] = localPoint[axis] < 0.0f ? -1.0f : 1.0f;
+	return normal;
+}
+
+bool CollisionDetection::SweptSphereIntersection(const Vector3& start, float radius, const Vector3& displacement,
+	const CollisionVolume& volume, const Transform& worldTransform, float& hitFraction, Vector3& hitNormal) {
+	float distance = displacement.Length();
+	if (distance <= 0.0f) {
+		return false;
+	}
+	Ray r(start, displacement / distance);
+
+	Vector3		targetPos	= worldTransform.GetPosition();
+	Quaternion	orientation = worldTransform.GetOrientation();
+	Vector3		grow(radius, radius, radius);
+
+	RayCollision collision;
+	bool hit = false;
+
+	switch (volume.type) {
+		case VolumeType::Sphere: {
+			SphereVolume grown(((const SphereVolume&)volume).GetRadius() + radius);
+			hit = RaySphereIntersection(r, worldTransform, grown, collision);
+			if (hit) {
+				hitNormal = (collision.collidedAt - targetPos).Normalised();
+			}
+		}break;
+		case VolumeType::AABB: {
+			AABBVolume grown(((const AABBVolume&)volume).GetHalfDimensions() + grow);
+			hit = RayAABBIntersection(r, worldTransform, grown, collision);
+			if (hit) {
+				hitNormal = BoxFaceNormal(collision.collidedAt - targetPos, grown.GetHalfDimensions());
+			}
+		}break;
+		case VolumeType::OBB: {
+			OBBVolume grown(((const OBBVolume&)volume).GetHalfDimensions() + grow);
+			hit = RayOBBIntersection(r, worldTransform, grown, collision);
+			if (hit) {
+				Vector3 localPoint = orientation.Conjugate() * (collision.collidedAt - targetPos);
+				hitNormal = orientation * BoxFaceNormal(localPoint, grown.GetHalfDimensions());
+			}
+		}break;
+		case VolumeType::Capsule: {
+			//The two end spheres, and a box around the middle - whichever is hit first
+			const CapsuleVolume& capsule = (const CapsuleVolume&)volume;
+			Vector3 up		= orientation * Vector3(0, 1, 0);
+			float	segment = capsule.GetHalfHeight() - capsule.GetRadius();
+			Vector3 top		= targetPos + up * segment;
+			Vector3 bottom	= targetPos - up * segment;
+
+			SphereVolume	grownEnd(capsule.GetRadius() + radius);
+			OBBVolume		grownMiddle(Vector3(capsule.GetRadius(), segment, capsule.GetRadius()) + grow);
+			Transform		endTransform;
+
+			for (int i = 0; i < 3; ++i) {
+				RayCollision partCollision;
+				bool partHit = false;
+				if (i < 2) {
+					endTransform.SetPosition(i == 0 ? top : bottom);
+					partHit = RaySphereIntersection(r, endTransform, grownEnd, partCollision);
+				}
+				else {
+					partHit = RayOBBIntersection(r, worldTransform, grownMiddle, partCollision);
+				}
+				if (partHit && partCollision.rayDistance >= 0.0f && partCollision.rayDistance < collision.rayDistance) {
+					collision	= partCollision;
+					hit			= true;
+				}
+			}
+			if (hit) {
+				hitNormal = (collision.collidedAt - ClosestPointOnLineSegment(top, bottom, collision.collidedAt)).Normalised();
+			}
+		}break;
+		default:
+			return false;
+	}
+	if (!hit || collision.rayDistance < 0.0f || collision.rayDistance > distance) {
+		return false;
+	}
+	hitFraction = collision.rayDistance / distance;
+	return true;
+}
+
+//Whether ObjectIntersection gives a pair of these back the other way round
+static bool SwapsPair(VolumeType a, VolumeType b) {
+	return	(a == VolumeType::Sphere && (b == VolumeType::AABB || b == VolumeType::OBB || b == VolumeType::Capsule)) ||
+			(a == VolumeType::AABB && (b == VolumeType::OBB || b == VolumeType::Capsule));
+}
+
+bool CollisionDetection::SweptIntersection(GameObject* a, GameObject* b, const Vector3& displacement, CollisionInfo& collisionInfo) {
+	const CollisionVolume* volA = a->GetBoundingVolume();
+	const CollisionVolume* volB = b->GetBoundingVolume();
+
+	if (!volA || !volB) {
+		return false;
+	}
+
+	//Boxes aren't swept very well, so if only one of them is round, it does the moving
+	auto isRound = [](const CollisionVolume* v) {
+		return v->type == VolumeType::Sphere || v->type == VolumeType::Capsule;
+	};
+	bool	moverIsA	= isRound(volA) || !isRound(volB);
+	GameObject*				mover		= moverIsA ? a : b;
+	GameObject*				target		= moverIsA ? b : a;
+	const CollisionVolume*	moverVolume = moverIsA ? volA : volB;
+	Vector3					moved		= moverIsA ? displacement : -displacement;
+
+	const Transform& moverTransform = mover->GetTransform();
+	Vector3 moverPos = moverTransform.GetPosition();
+
+	Vector3 centres[3] = { moverPos, moverPos, moverPos };
+	int		centreCount = 1;
+	float	radius;
+	switch (moverVolume->type) {
+		case VolumeType::Sphere: {
+			radius = ((const SphereVolume*)moverVolume)->GetRadius();
+		}break;
+		case VolumeType::Capsule: {
+			const CapsuleVolume* capsule = (const CapsuleVolume*)moverVolume;
+			Vector3 up	= moverTransform.GetOrientation() * Vector3(0, 1, 0);
+			radius		= capsule->GetRadius();
+			centres[1]	= moverPos + up * (capsule->GetHalfHeight() - radius);
+			centres[2]	= moverPos - up * (capsule->GetHalfHeight() - radius);
+			centreCount = 3;
+		}break;
+		case VolumeType::AABB: {
+			radius = ((const AABBVolume*)moverVolume)->GetHalfDimensions().GetMinElement();
+		}break;
+		case VolumeType::OBB: {
+			radius = ((const OBBVolume*)moverVolume)->GetHalfDimensions().GetMinElement();
+		}break;
+		default:
+			return false;
+	}
+
+	float	bestFraction = FLT_MAX;
+	Vector3 bestNormal;
+	Vector3 bestCentre;
+	for (int i = 0; i < centreCount; ++i) {
+		float	fraction;
+		Vector3 normal;
+		if (SweptSphereIntersection(centres[i], radius, moved, *target->GetBoundingVolume(), target->GetTransform(), fraction, normal) && fraction < bestFraction) {
+			bestFraction	= fraction;
+			bestNormal		= normal;
+			bestCentre		= centres[i];
+		}
+	}
+	if (bestFraction == FLT_MAX) {
+		return false;
+	}
+
+	//From the mover into the target, and how far apart they are along it
+	Vector3 normal	= -bestNormal;
+	float	gap		= std::max(bestFraction * Vector3::Dot(moved, normal), 0.0f);
+
+	Vector3 moverPoint	= bestCentre + normal * radius;
+	Vector3 targetPoint = moverPoint + normal * gap;
+	Vector3 moverLocal	= moverPoint - moverPos;
+	Vector3 targetLocal = targetPoint - target->GetTransform().GetPosition();
+
+	if (moverIsA) {
+		collisionInfo.AddContactPoint(moverLocal, targetLocal, normal, -gap, false);
+	}
+	else {
+		collisionInfo.AddContactPoint(targetLocal, moverLocal, -normal, -gap, false);
+	}
+	collisionInfo.a = a;
+	collisionInfo.b = b;
+
+	if (SwapsPair(volA->type, volB->type)) {
+		std::swap(collisionInfo.a, collisionInfo.b);
+		std::swap(collisionInfo.point.localA, collisionInfo.point.localB);
+		collisionInfo.point.normal = -collisionInfo.point.normal;
+	}
+	return true;
+}
+
 Vector3 CollisionDetection::Unproject(const Vector3& screenPos, const Camera& cam) {
 	Vector2 screenSize = Window::GetWindow()->GetScreenSize();
 
@@ -10,8 +10,13 @@
 #include "SphereVolume.h"
 #include "CapsuleVolume.h"
 #include "Ray.h"
+#include "CollisionBatch.h"
 
 
+namespace NCL::CSC8503 {
+	struct RayPacket;
+}
+
 using NCL::Camera;
 using namespace NCL::Maths;
 using namespace NCL::CSC8503;
@@ -37,7 +42,6 @@ namespace NCL {
 		struct CollisionInfo {
 			GameObject* a;
 			GameObject* b;		
-			int		framesLeft;
 
 			ContactPoint point;
 
@@ -125,6 +129,15 @@ namespace NCL {
 
 		static bool RayPlaneIntersection(const Ray&r, const Plane&p, RayCollision& collisions);
 
+		/*
+		RayBoxIntersection and RaySphereIntersection for every ray in a
+		RayPacket at once - each lane gets the same answer the single ray
+		test would. Returns which of the packet's lanes hit, and writes how
+		far along each of those rays the hit was into distances.
+		*/
+		static int RayBoxPacketIntersection(const RayPacket& rays, const Vector3& boxPos, const Vector3& boxSize, float* distances);
+		static int RaySpherePacketIntersection(const RayPacket& rays, const Vector3& spherePos, float sphereRadius, float* distances);
+
 		static bool	AABBTest(const Vector3& posA, const Vector3& posB, const Vector3& halfSizeA, const Vector3& halfSizeB);
 
 
@@ -155,6 +168,44 @@ namespace NCL {
 		static bool OBBAABBIntersection(const OBBVolume& volumeA, const Transform& worldTransformA,
 			const AABBVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo);
 
+		/*
+		Continuous collision tests, for objects moving fast enough to pass
+		straight through something in a single step. Moving a sphere along
+		displacement is the same as casting a ray against the target grown
+		by the sphere's radius, so these are built on the ray tests above.
+		Gives back how far along displacement the sphere got before it hit,
+		from 0 to 1, and the target's surface normal where it did. Spheres
+		that start off already touching aren't counted - the normal tests
+		find those.
+		*/
+		static bool SweptSphereIntersection(const Vector3& start, float radius, const Vector3& displacement,
+			const CollisionVolume& volume, const Transform& worldTransform, float& hitFraction, Vector3& hitNormal);
+
+		/*
+		Sweeps a against b, by how far a moves relative to b this step.
+		Spheres and capsules are swept as they are, and boxes as the biggest
+		sphere that fits inside them - close enough to stop them passing
+		through anything. A hit comes back as a contact with a negative
+		penetration, the gap that's left between them, so the solver will
+		let them close the gap but no more.
+		*/
+		static bool SweptIntersection(GameObject* a, GameObject* b, const Vector3& displacement, CollisionInfo& collisionInfo);
+
+		/*
+		Batched versions of the tests above, for pairs [begin, end) of a
+		CollisionBatch. They give the same results as ObjectIntersection
+		would for each pair, but test several pairs at once with SIMD.
+		Every pair that collides is added on to the end of collisions.
+		*/
+		static void BatchIntersection(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+
+		static void SphereIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+		static void AABBIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+		static void AABBSphereIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+		static void OBBSphereIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+		static void OBBIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+		static void ObjectIntersectionBatch(const CollisionBatch& batch, int begin, int end, std::vector<CollisionInfo>& collisions);
+
 		static Vector3 Unproject(const Vector3& screenPos, const Camera& cam);
 
 		static Vector3		UnprojectScreenPosition(Vector3 position, float aspect, float fov, const Camera &c);
@@ -0,0 +1,149 @@
+#include "CollisionPairCache.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+CollisionPairCache::CollisionPairCache(int initialCapacity) {
+	size_t bucketCount = 16;
+	while (bucketCount < (size_t)initialCapacity * 2) {
+		bucketCount *= 2;
+	}
+	buckets.resize(bucketCount, NullSlot);
+	bucketMask	= bucketCount - 1;
+	freeList	= NullSlot;
+	pairCount	= 0;
+}
+
+CollisionPairCache::~CollisionPairCache() {
+}
+
+void CollisionPairCache::Clear() {
+	if (!slots.empty()) {
+		std::fill(buckets.begin(), buckets.end(), NullSlot);
+	}
+	slots.clear();
+	freeList	= NullSlot;
+	pairCount	= 0;
+}
+
+size_t CollisionPairCache::HashPair(GameObjectHandle a, GameObjectHandle b) {
+	size_t h = (((size_t)a.index << 32) | a.generation) * 0x9E3779B97F4A7C15ull;
+	h ^= (((size_t)b.index << 32) | b.generation) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	return h ^ (h >> 31);
+}
+
+bool CollisionPairCache::Insert(const CollisionDetection::CollisionInfo& info, int frameStamp) {
+	GameObjectHandle a = info.a->GetWorldHandle();
+	GameObjectHandle b = info.b->GetWorldHandle();
+
+	size_t hash		= HashPair(a, b);
+	size_t bucket	= hash & bucketMask;
+	while (buckets[bucket] != NullSlot) {
+		const Slot& s = slots[buckets[bucket]];
+		if (s.hash == hash && s.handleA == a && s.handleB == b) {
+			return false;
+		}
+		bucket = (bucket + 1) & bucketMask;
+	}
+
+	if ((size_t)(pairCount + 1) * 2 > buckets.size()) {
+		Grow();
+		bucket = hash & bucketMask;
+		while (buckets[bucket] != NullSlot) {
+			bucket = (bucket + 1) & bucketMask;
+		}
+	}
+
+	int slot;
+	if (freeList != NullSlot) {
+		slot		= freeList;
+		freeList	= slots[slot].next;
+	}
+	else {
+		slot = (int)slots.size();
+		slots.emplace_back();
+	}
+	Slot& s		= slots[slot];
+	s.info			= info;
+	s.handleA		= a;
+	s.handleB		= b;
+	s.hash			= hash;
+	s.frameStamp	= frameStamp;
+	s.next			= NullSlot;
+	s.inUse			= true;
+
+	buckets[bucket] = slot;
+	pairCount++;
+	return true;
+}
+
+int CollisionPairCache::Find(const GameObject* objectA, const GameObject* objectB) const {
+	GameObjectHandle a = objectA->GetWorldHandle();
+	GameObjectHandle b = objectB->GetWorldHandle();
+
+	size_t hash		= HashPair(a, b);
+	size_t bucket	= hash & bucketMask;
+	while (buckets[bucket] != NullSlot) {
+		const Slot& s = slots[buckets[bucket]];
+		if (s.hash == hash && s.handleA == a && s.handleB == b) {
+			return buckets[bucket];
+		}
+		bucket = (bucket + 1) & bucketMask;
+	}
+	return NullSlot;
+}
+
+void CollisionPairCache::Remove(int slot) {
+	size_t bucket = slots[slot].hash & bucketMask;
+	while (buckets[bucket] != slot) {
+		bucket = (bucket + 1) & bucketMask;
+	}
+	EraseBucket((int)bucket);
+
+	slots[slot].inUse	= false;
+	slots[slot].next	= freeList;
+	freeList			= slot;
+	pairCount--;
+}
+
+/*
+With linear probing we can't just empty a bucket, as that would break the
+probe chain of anything that was pushed past it. Instead, later entries in
+the same run are shuffled back into the gap, if that doesn't move them in
+front of the bucket they hash to.
+*/
+void CollisionPairCache::EraseBucket(int bucket) {
+	size_t gap	= (size_t)bucket;
+	size_t next	= gap;
+	while (true) {
+		next = (next + 1) & bucketMask;
+		if (buckets[next] == NullSlot) {
+			break;
+		}
+		size_t home = slots[buckets[next]].hash & bucketMask;
+		//Can the entry at next move back to gap? Only if home isn't in (gap, next]
+		bool homeBetween = gap <= next ? (home > gap && home <= next) : (home > gap || home <= next);
+		if (!homeBetween) {
+			buckets[gap]	= buckets[next];
+			gap				= next;
+		}
+	}
+	buckets[gap] = NullSlot;
+}
+
+void CollisionPairCache::Grow() {
+	size_t bucketCount = buckets.size() * 2;
+	buckets.assign(bucketCount, NullSlot);
+	bucketMask = bucketCount - 1;
+
+	for (int i = 0; i < (int)slots.size(); ++i) {
+		if (!slots[i].inUse) {
+			continue;
+		}
+		size_t bucket = slots[i].hash & bucketMask;
+		while (buckets[bucket] != NullSlot) {
+			bucket = (bucket + 1) & bucketMask;
+		}
+		buckets[bucket] = i;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "CollisionDetection.h"
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Stores one CollisionInfo per pair of objects, looked up by the (a, b)
+		pair of world handles. It replaces the std::sets the PhysicsSystem used to keep
+		its collisions in, which allocated a node for every pair and needed a
+		log(n) search for every insert.
+
+		Pairs live in a vector of slots, and a slot keeps its index for as long
+		as the pair is in the cache, so callers can hold on to it between
+		frames. Finding a pair's slot goes through an open addressing hash
+		table (linear probing, kept at most half full) of slot indices.
+
+		Each pair also carries a frame stamp, which the owner can use to decide
+		when a pair is old enough to be thrown away.
+
+		The pointers in a pair's CollisionInfo are only safe to use while both
+		objects are still in the world - pairs can outlive their objects, so
+		check the handles with GameWorld::GetGameObject first.
+		*/
+		class CollisionPairCache {
+		public:
+			static constexpr int NullSlot = -1;
+
+			CollisionPairCache(int initialCapacity = 64);
+			~CollisionPairCache();
+
+			void Clear();
+
+			/*
+			Adds the pair in info, unless it's already in the cache - in that
+			case the existing entry (and its frame stamp) is left alone.
+			Returns true if the pair was new.
+			*/
+			bool Insert(const CollisionDetection::CollisionInfo& info, int frameStamp);
+
+			int  Find(const GameObject* a, const GameObject* b) const;
+			void Remove(int slot);
+
+			int GetPairCount() const {
+				return pairCount;
+			}
+
+			//Slots are iterated from 0 to GetSlotCount, skipping any that aren't in use
+			int GetSlotCount() const {
+				return (int)slots.size();
+			}
+
+			bool IsSlotUsed(int slot) const {
+				return slots[slot].inUse;
+			}
+
+			CollisionDetection::CollisionInfo& GetInfo(int slot) {
+				return slots[slot].info;
+			}
+
+			const CollisionDetection::CollisionInfo& GetInfo(int slot) const {
+				return slots[slot].info;
+			}
+
+			int GetFrameStamp(int slot) const {
+				return slots[slot].frameStamp;
+			}
+
+			GameObjectHandle GetHandleA(int slot) const {
+				return slots[slot].handleA;
+			}
+
+			GameObjectHandle GetHandleB(int slot) const {
+				return slots[slot].handleB;
+			}
+
+		protected:
+			struct Slot {
+				CollisionDetection::CollisionInfo info;
+				GameObjectHandle handleA;
+				GameObjectHandle handleB;
+				size_t	hash;
+				int		frameStamp;
+				int		next;	//free list link
+				bool	inUse;
+			};
+
+			static size_t HashPair(GameObjectHandle a, GameObjectHandle b);
+
+			void Grow();
+			void EraseBucket(int bucket);
+
+			std::vector<Slot>	slots;
+			std::vector<int>	buckets;
+			size_t	bucketMask;
+			int		freeList;
+			int		pairCount;
+		};
+	}
+}
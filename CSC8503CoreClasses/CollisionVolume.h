@@ -1,4 +1,7 @@
 #pragma once
+#include "ObjectPool.h"
+#include <cassert>
+
 namespace NCL {
 	enum class VolumeType {
 		AABB	= 1,
@@ -18,6 +21,23 @@ namespace NCL {
 		}
 		~CollisionVolume() {}
 
+		/*
+		Volumes are deleted through CollisionVolume pointers, and there's no
+		virtual destructor to say how big they really are, so every volume
+		gets a block of PooledSize, whatever its type. Each volume type checks
+		it fits with a static_assert, under its class.
+		*/
+		static constexpr size_t PooledSize = 32;
+
+		static void* operator new([[maybe_unused]] size_t size) {
+			assert(size <= PooledSize);
+			return CSC8503::ObjectPools::Allocate(CSC8503::PoolType::CollisionVolumes, PooledSize);
+		}
+
+		static void operator delete(void* p) {
+			CSC8503::ObjectPools::Free(CSC8503::PoolType::CollisionVolumes, p, PooledSize);
+		}
+
 		VolumeType type;
 	};
 }
\ No newline at end of file
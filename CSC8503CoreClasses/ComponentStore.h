@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		Every object in a GameWorld that has one particular kind of component
+		(a PhysicsObject, say), kept packed together in one array, alongside
+		the objects that own them. A system that only cares about objects
+		with that component can then just walk the array, rather than going
+		through every object in the world and skipping the ones without.
+
+		It's a sparse set - the packed (dense) arrays hold the components,
+		and a second, sparse array goes from an object's slot in the world
+		(the index of its world handle) to where its component is in the
+		dense arrays, so adding, removing and finding a component are all
+		O(1). As with the SlotMap, removing one moves the last into its place.
+		*/
+		template<class T>
+		class ComponentSet {
+		public:
+			ComponentSet() {
+			}
+			~ComponentSet() {
+			}
+
+			//Adds it, or replaces whatever component the slot already had
+			void Set(uint32_t slot, const T& component, GameObject* owner) {
+				if (slot >= sparse.size()) {
+					sparse.resize(slot + 1, -1);
+				}
+				int dense = sparse[slot];
+				if (dense == -1) {
+					sparse[slot] = (int)components.size();
+					components.emplace_back(component);
+					owners.emplace_back(owner);
+					slots.emplace_back(slot);
+					return;
+				}
+				components[dense]	= component;
+				owners[dense]		= owner;
+			}
+
+			//Returns false if the slot didn't have one
+			bool Remove(uint32_t slot) {
+				if (!Contains(slot)) {
+					return false;
+				}
+				int dense	= sparse[slot];
+				int last	= (int)components.size() - 1;
+				if (dense != last) {
+					components[dense]	= components[last];
+					owners[dense]		= owners[last];
+					slots[dense]		= slots[last];
+					sparse[slots[dense]] = dense;
+				}
+				components.pop_back();
+				owners.pop_back();
+				slots.pop_back();
+				sparse[slot] = -1;
+				return true;
+			}
+
+			bool Contains(uint32_t slot) const {
+				return slot < sparse.size() && sparse[slot] != -1;
+			}
+
+			void Clear() {
+				components.clear();
+				owners.clear();
+				slots.clear();
+				sparse.clear();
+			}
+
+			int GetCount() const {
+				return (int)components.size();
+			}
+
+			//The dense arrays - owners[i] is the object that has components[i]
+			const std::vector<T>& GetComponents() const {
+				return components;
+			}
+
+			const std::vector<GameObject*>& GetOwners() const {
+				return owners;
+			}
+
+		protected:
+			std::vector<T>				components;
+			std::vector<GameObject*>	owners;
+			std::vector<uint32_t>		slots;	//Which world slot each dense entry belongs to
+			std::vector<int>			sparse;	//Slot to dense index, -1 for none
+		};
+	}
+}
@@ -1,13 +1,59 @@
 #pragma once
+#include "SlotMap.h"
 
 namespace NCL {
 	namespace CSC8503 {
+		class GameObject;
+		class Constraint;
+
+		typedef SlotHandle<Constraint*> ConstraintHandle;
+
+		/*
+		The types the PhysicsSystem knows how to solve without going through
+		UpdateConstraint - anything else is Custom, and is run as it always
+		was, one at a time.
+		*/
+		enum class ConstraintType {
+			Position,
+			Orientation,
+			Custom
+		};
+
 		class Constraint	{
 		public:
-			Constraint() {}
+			Constraint(ConstraintType t = ConstraintType::Custom) {
+				type = t;
+			}
 			virtual ~Constraint() {}
 
 			virtual void UpdateConstraint(float dt) = 0;
+
+			/*
+			The objects the constraint acts on, so the PhysicsSystem knows which
+			objects have to sleep and wake together. Constraints that don't say
+			are left out of that, and are always run.
+			*/
+			virtual void GetObjects(GameObject*& a, GameObject*& b) const {
+				a = nullptr;
+				b = nullptr;
+			}
+
+			ConstraintType GetType() const {
+				return type;
+			}
+
+			//Set by the GameWorld - null while the constraint isn't in one
+			void SetWorldHandle(ConstraintHandle newHandle) {
+				worldHandle = newHandle;
+			}
+
+			ConstraintHandle GetWorldHandle() const {
+				return worldHandle;
+			}
+
+		protected:
+			ConstraintType		type;
+			ConstraintHandle	worldHandle;
 		};
 	}
-}
\ No newline at end of file
+}
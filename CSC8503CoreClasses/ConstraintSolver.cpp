@@ -0,0 +1,91 @@
+#include "ConstraintSolver.h"
+#include "PositionConstraint.h"
+#include "OrientationConstraint.h"
+#include "RigidBodyStore.h"
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+ConstraintSolver::ConstraintSolver() {
+	bodies			= nullptr;
+	batchCount		= 0;
+	constraintCount = 0;
+	batches.resize(MaxColours + 1);
+}
+
+ConstraintSolver::~ConstraintSolver() {
+}
+
+void ConstraintSolver::Reset(RigidBodyStore& store) {
+	bodies = &store;
+	for (int i = 0; i < batchCount; ++i) {
+		batches[i].positions.clear();
+		batches[i].orientations.clear();
+	}
+	batchCount		= 0;
+	constraintCount = 0;
+	bodyColours.assign(store.GetBodyCount(), 0);
+}
+
+/*
+The first colour neither body has yet - bodies that can't move don't
+count, as nothing is ever written to them. If every colour is taken, the
+constraint goes in the last batch, which isn't split up between threads.
+*/
+int ConstraintSolver::ChooseColour(int bodyA, int bodyB) {
+	bool movableA = bodies->GetInverseMass(bodyA) > 0.0f;
+	bool movableB = bodies->GetInverseMass(bodyB) > 0.0f;
+
+	uint64_t used = (movableA ? bodyColours[bodyA] : 0) | (movableB ? bodyColours[bodyB] : 0);
+
+	int colour = 0;
+	while (colour < MaxColours && (used & (uint64_t(1) << colour))) {
+		colour++;
+	}
+	if (colour < MaxColours) {
+		if (movableA) {
+			bodyColours[bodyA] |= uint64_t(1) << colour;
+		}
+		if (movableB) {
+			bodyColours[bodyB] |= uint64_t(1) << colour;
+		}
+	}
+	return colour;
+}
+
+bool ConstraintSolver::Add(Constraint* c, int bodyA, int bodyB) {
+	if (c->GetType() == ConstraintType::Custom) {
+		return false;
+	}
+	int colour = ChooseColour(bodyA, bodyB);
+	Batch& batch = batches[colour];
+
+	if (c->GetType() == ConstraintType::Position) {
+		batch.positions.push_back({ bodyA, bodyB, ((PositionConstraint*)c)->GetDistance() });
+	}
+	else {
+		batch.orientations.push_back({ bodyA, bodyB, ((OrientationConstraint*)c)->GetAngle() });
+	}
+	batchCount = std::max(batchCount, colour + 1);
+	constraintCount++;
+	return true;
+}
+
+/*
+The position constraints come first, then the orientation ones, so a
+range of the batch can have some of each.
+*/
+void ConstraintSolver::SolveBatch(int b, int begin, int end, float dt) {
+	Batch& batch = batches[b];
+	const int positionCount = (int)batch.positions.size();
+
+	for (int i = begin; i < end && i < positionCount; ++i) {
+		const PositionRow& row = batch.positions[i];
+		PositionConstraint::Solve(*bodies, row.bodyA, row.bodyB, row.distance, dt);
+	}
+	for (int i = std::max(begin, positionCount); i < end; ++i) {
+		const OrientationRow& row = batch.orientations[i - positionCount];
+		OrientationConstraint::Solve(*bodies, row.bodyA, row.bodyB, row.angle, dt);
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "Vector3.h"
+#include <cstdint>
+#include <vector>
+
+using namespace NCL::Maths;
+
+namespace NCL {
+	namespace CSC8503 {
+		class Constraint;
+		class RigidBodyStore;
+
+		/*
+		Sorts the constraints the PhysicsSystem knows about into batches that
+		can each be solved across several threads at once.
+
+		Two constraints that act on the same body can't be solved at the same
+		time, as they'd both be changing its velocity - so the constraints are
+		coloured, like a map, with each constraint getting the first colour
+		that none of the other constraints on its bodies already has. Each
+		colour is then a batch of constraints that don't share anything, and
+		the batches are solved one after the other. A rope only needs two
+		colours, however long it is. Bodies that can't move are never written
+		to, so they can be shared by as many constraints in a batch as needed.
+
+		Rather than keeping the constraints themselves, each batch keeps just
+		what's needed to solve them - the two bodies, and the distance or
+		angle - in an array for each type. Solving a batch is then a straight
+		run through each array, with no virtual calls, and no looking up
+		objects to find their bodies.
+
+		A body with more constraints on it than there are colours puts the
+		rest in a final batch, that is solved on a single thread.
+		*/
+		class ConstraintSolver {
+		public:
+			ConstraintSolver();
+			~ConstraintSolver();
+
+			//Starts again with no constraints, for the bodies in the given store
+			void Reset(RigidBodyStore& store);
+
+			/*
+			Adds a constraint acting on the two given bodies in the store.
+			Returns false if it's a type that can't be batched, and has to be
+			updated on its own instead.
+			*/
+			bool Add(Constraint* c, int bodyA, int bodyB);
+
+			int GetBatchCount() const {
+				return batchCount;
+			}
+
+			int GetBatchSize(int batch) const {
+				return (int)(batches[batch].positions.size() + batches[batch].orientations.size());
+			}
+
+			//Only the last batch can have constraints that share bodies
+			bool IsBatchParallel(int batch) const {
+				return batch < MaxColours;
+			}
+
+			bool IsEmpty() const {
+				return constraintCount == 0;
+			}
+
+			//Solves the constraints [begin, end) of a batch
+			void SolveBatch(int batch, int begin, int end, float dt);
+
+			static constexpr int MaxColours = 63;
+
+		protected:
+			struct PositionRow {
+				int		bodyA;
+				int		bodyB;
+				float	distance;
+			};
+
+			struct OrientationRow {
+				int		bodyA;
+				int		bodyB;
+				Vector3 angle;
+			};
+
+			struct Batch {
+				std::vector<PositionRow>	positions;
+				std::vector<OrientationRow> orientations;
+			};
+
+			int ChooseColour(int bodyA, int bodyB);
+
+			RigidBodyStore* bodies;
+
+			//Batches past batchCount are kept around, so their arrays don't need allocating again
+			std::vector<Batch>	batches;
+			int					batchCount;
+			int					constraintCount;
+
+			//A bit for each colour already used by a constraint on each body
+			std::vector<uint64_t> bodyColours;
+		};
+	}
+}
@@ -0,0 +1,359 @@
+#include "ContactSolver.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+#include "Maths.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+ContactSolver::ContactSolver() {
+}
+
+ContactSolver::~ContactSolver() {
+}
+
+void ContactSolver::Clear() {
+	pairs.Clear();
+	manifolds.clear();
+}
+
+void ContactSolver::AddContact(const CollisionDetection::CollisionInfo& info) {
+	if (pairs.Insert(info, 0)) {
+		int slot = pairs.Find(info.a, info.b);
+		if (slot >= (int)manifolds.size()) {
+			manifolds.resize(slot + 1);
+		}
+		Manifold& m = manifolds[slot];
+		m.a				= info.a;
+		m.b				= info.b;
+		m.pointCount	= 0;
+
+		PhysicsObject* physA = info.a->GetPhysicsObject();
+		PhysicsObject* physB = info.b->GetPhysicsObject();
+		m.restitution	= physA->GetElasticity() * physB->GetElasticity();
+		m.friction		= sqrt(physA->GetFriction() * physB->GetFriction());
+	}
+	Manifold& m = manifolds[pairs.Find(info.a, info.b)];
+
+	const Transform& transformA = info.a->GetTransform();
+	const Transform& transformB = info.b->GetTransform();
+
+	/*
+	The narrowphase can give back a different point on each object - the
+	deepest corner of each box, which might be on opposite sides of them.
+	Pushing on them at two different places would spin them, so both are
+	pushed at B's point instead. Anything colliding at its centre (AABBs)
+	is left alone, as that's what stops them being spun.
+	*/
+	Vector3 localA = info.point.localA;
+	Vector3 localB = info.point.localB;
+	if (localB.LengthSquared() > 0.0f) {
+		localA = (transformB.GetPosition() + localB) - transformA.GetPosition();
+	}
+
+	ContactPoint p;
+	p.anchorA		= transformA.GetOrientation().Conjugate() * localA;
+	p.anchorB		= transformB.GetOrientation().Conjugate() * localB;
+	p.normal		= info.point.normal;
+	p.penetration	= info.point.penetration;
+	p.foundGap		= (transformB.GetPosition() + localB) - (transformA.GetPosition() + localA);
+
+	//Points found before the objects touch (see SweptIntersection) start off further apart than that
+	p.breakingPenetration = std::min(p.penetration, 0.0f) - BreakingDistance;
+
+	//Any pair of directions at right angles to the normal will do, as long as it's always the same pair
+	if (std::abs(p.normal.x) > 0.57735f) {
+		p.tangent1 = Vector3(p.normal.y, -p.normal.x, 0.0f).Normalised();
+	}
+	else {
+		p.tangent1 = Vector3(0.0f, p.normal.z, -p.normal.y).Normalised();
+	}
+	p.tangent2 = Vector3::Cross(p.normal, p.tangent1);
+
+	p.normalImpulse		= 0.0f;
+	p.tangentImpulse1	= 0.0f;
+	p.tangentImpulse2	= 0.0f;
+
+	AddPoint(m, p);
+}
+
+/*
+If the new point is close to one we already have, it takes that point's
+place, but keeps its impulses, so it can still be warm started. Otherwise
+it's added on the end - and if the manifold's already full, the point it
+replaces is whichever leaves the 4 points covering the biggest area, while
+always keeping the deepest point.
+*/
+void ContactSolver::AddPoint(Manifold& m, const ContactPoint& p) {
+	for (int i = 0; i < m.pointCount; ++i) {
+		ContactPoint& old = m.points[i];
+		if ((old.anchorA - p.anchorA).LengthSquared() < MatchDistance * MatchDistance &&
+			(old.anchorB - p.anchorB).LengthSquared() < MatchDistance * MatchDistance) {
+			ContactPoint replaced = p;
+			replaced.normalImpulse		= old.normalImpulse;
+			replaced.tangentImpulse1	= old.tangentImpulse1;
+			replaced.tangentImpulse2	= old.tangentImpulse2;
+			old = replaced;
+			return;
+		}
+	}
+	if (m.pointCount < MaxPoints) {
+		m.points[m.pointCount++] = p;
+		return;
+	}
+
+	int deepest = 0;
+	for (int i = 1; i < MaxPoints; ++i) {
+		if (m.points[i].penetration > m.points[deepest].penetration) {
+			deepest = i;
+		}
+	}
+	const Vector3* anchors[MaxPoints];
+	for (int i = 0; i < MaxPoints; ++i) {
+		anchors[i] = &m.points[i].anchorA;
+	}
+	//The area of the quad left over if each point was replaced by the new one
+	float areas[MaxPoints] = {
+		Vector3::Cross(p.anchorA - *anchors[1], *anchors[3] - *anchors[2]).LengthSquared(),
+		Vector3::Cross(p.anchorA - *anchors[0], *anchors[3] - *anchors[2]).LengthSquared(),
+		Vector3::Cross(p.anchorA - *anchors[0], *anchors[3] - *anchors[1]).LengthSquared(),
+		Vector3::Cross(p.anchorA - *anchors[0], *anchors[2] - *anchors[1]).LengthSquared()
+	};
+	areas[deepest] = -1.0f;
+
+	int replace = 0;
+	for (int i = 1; i < MaxPoints; ++i) {
+		if (areas[i] > areas[replace]) {
+			replace = i;
+		}
+	}
+	m.points[replace] = p;
+}
+
+/*
+The narrowphase only finds one point per pair each step, so the others are
+kept up to date by working out how far the objects have moved since each
+point was found. Points where the objects have since moved apart, or slid
+too far along each other, are dropped.
+*/
+void ContactSolver::RefreshPoints(Manifold& m) {
+	const Transform& transformA = m.a->GetTransform();
+	const Transform& transformB = m.b->GetTransform();
+	Quaternion orientationA = transformA.GetOrientation();
+	Quaternion orientationB = transformB.GetOrientation();
+	Vector3 positionA = transformA.GetPosition();
+	Vector3 positionB = transformB.GetPosition();
+
+	for (int i = 0; i < m.pointCount; ) {
+		ContactPoint& p = m.points[i];
+		p.relativeA = orientationA * p.anchorA;
+		p.relativeB = orientationB * p.anchorB;
+
+		Vector3 moved		= ((positionB + p.relativeB) - (positionA + p.relativeA)) - p.foundGap;
+		float	closing		= Vector3::Dot(moved, p.normal);
+		Vector3 sliding		= moved - p.normal * closing;
+
+		float penetration = p.penetration - closing;
+		if (penetration < p.breakingPenetration || sliding.LengthSquared() > BreakingDistance * BreakingDistance) {
+			m.points[i] = m.points[--m.pointCount];
+			continue;
+		}
+		p.penetration	= penetration;
+		p.foundGap		= p.foundGap + moved;
+		++i;
+	}
+}
+
+void ContactSolver::PreSolve(float dt) {
+	lateBounces.clear();
+	for (int i = 0; i < pairs.GetSlotCount(); ++i) {
+		if (!pairs.IsSlotUsed(i)) {
+			continue;
+		}
+		Manifold& m = manifolds[i];
+		m.awake = !m.a->GetPhysicsObject()->IsAsleep() || !m.b->GetPhysicsObject()->IsAsleep();
+		if (!m.awake) {
+			continue;
+		}
+		RefreshPoints(m);
+		if (m.pointCount == 0) {
+			pairs.Remove(i);
+			continue;
+		}
+		PrepareManifold(m, dt);
+		if (m.lateBounce) {
+			lateBounces.push_back(i);
+		}
+	}
+	//Only once every manifold has seen the velocities the objects came in with
+	for (int i = 0; i < pairs.GetSlotCount(); ++i) {
+		if (pairs.IsSlotUsed(i) && manifolds[i].awake) {
+			WarmStart(manifolds[i]);
+		}
+	}
+}
+
+static float EffectiveMass(float inverseMass, const Matrix3& inertiaA, const Matrix3& inertiaB,
+	const Vector3& relativeA, const Vector3& relativeB, const Vector3& direction, bool useA, bool useB) {
+	Vector3 angular;
+	if (useA) {
+		angular = angular + Vector3::Cross(inertiaA * Vector3::Cross(relativeA, direction), relativeA);
+	}
+	if (useB) {
+		angular = angular + Vector3::Cross(inertiaB * Vector3::Cross(relativeB, direction), relativeB);
+	}
+	float totalMass = inverseMass + Vector3::Dot(angular, direction);
+	return totalMass > 0.0f ? 1.0f / totalMass : 0.0f;
+}
+
+void ContactSolver::PrepareManifold(Manifold& m, float dt) {
+	m.physA			= m.a->GetPhysicsObject();
+	m.physB			= m.b->GetPhysicsObject();
+	m.inverseMassA	= m.physA->GetInverseMass();
+	m.inverseMassB	= m.physB->GetInverseMass();
+	m.inertiaA		= m.physA->GetInertiaTensor();
+	m.inertiaB		= m.physB->GetInertiaTensor();
+	m.frictionA		= m.a->affectedByFriction;
+	m.frictionB		= m.b->affectedByFriction;
+
+	m.lateBounce	= false;
+
+	float frictionMass = (m.frictionA ? m.inverseMassA : 0.0f) + (m.frictionB ? m.inverseMassB : 0.0f);
+	if (!m.frictionA && !m.frictionB) {
+		for (int i = 0; i < m.pointCount; ++i) {
+			m.points[i].tangentImpulse1 = 0.0f;
+			m.points[i].tangentImpulse2 = 0.0f;
+		}
+	}
+
+	Vector3 linearA		= m.physA->GetLinearVelocity();
+	Vector3 linearB		= m.physB->GetLinearVelocity();
+	Vector3 angularA	= m.physA->GetAngularVelocity();
+	Vector3 angularB	= m.physB->GetAngularVelocity();
+
+	for (int i = 0; i < m.pointCount; ++i) {
+		ContactPoint& p = m.points[i];
+
+		p.normalMass	= EffectiveMass(m.inverseMassA + m.inverseMassB, m.inertiaA, m.inertiaB, p.relativeA, p.relativeB, p.normal, true, true);
+		p.tangentMass1	= EffectiveMass(frictionMass, m.inertiaA, m.inertiaB, p.relativeA, p.relativeB, p.tangent1, m.frictionA, m.frictionB);
+		p.tangentMass2	= EffectiveMass(frictionMass, m.inertiaA, m.inertiaB, p.relativeA, p.relativeB, p.tangent2, m.frictionA, m.frictionB);
+
+		if (p.penetration < 0.0f) {
+			//Not quite touching yet, so let them get as close as the gap between them
+			p.velocityBias = p.penetration / dt;
+		}
+		else {
+			//Push overlapping objects apart a little each step
+			float correction = BaumgarteFactor * std::max(p.penetration - AllowedPenetration, 0.0f) / dt;
+			p.velocityBias = std::min(correction, MaxCorrectionSpeed);
+		}
+
+		//Objects hitting each other hard enough bounce back off
+		Vector3 contactVel	= (linearB + Vector3::Cross(angularB, p.relativeB)) - (linearA + Vector3::Cross(angularA, p.relativeA));
+		float	closingVel	= Vector3::Dot(contactVel, p.normal);
+		p.bounceVelocity	= 0.0f;
+		if (closingVel < -BounceThreshold) {
+			if (p.penetration >= -BreakingDistance) {
+				p.velocityBias = std::max(p.velocityBias, -m.restitution * closingVel);
+			}
+			else {
+				p.bounceVelocity	= -m.restitution * closingVel;
+				m.lateBounce		= true;
+			}
+		}
+	}
+}
+
+//Starts off from the impulses that were needed last step
+void ContactSolver::WarmStart(Manifold& m) {
+	for (int i = 0; i < m.pointCount; ++i) {
+		ContactPoint& p = m.points[i];
+
+		Vector3 impulse = p.normal * p.normalImpulse;
+		ApplyImpulse(m, p, impulse, true, true);
+		impulse = p.tangent1 * p.tangentImpulse1 + p.tangent2 * p.tangentImpulse2;
+		ApplyImpulse(m, p, impulse, m.frictionA, m.frictionB);
+	}
+}
+
+void ContactSolver::SolveVelocities(const int* manifoldList, int count) {
+	for (int i = 0; i < count; ++i) {
+		SolveManifold(manifolds[manifoldList[i]]);
+	}
+}
+
+//Only points that pushed back at all were actually reached this step
+void ContactSolver::ApplyLateBounces() {
+	for (int i : lateBounces) {
+		Manifold& m = manifolds[i];
+		if (m.inverseMassA + m.inverseMassB == 0.0f) {
+			continue;
+		}
+		for (int j = 0; j < m.pointCount; ++j) {
+			ContactPoint& p = m.points[j];
+			if (p.bounceVelocity <= 0.0f || p.normalImpulse <= 0.0f) {
+				continue;
+			}
+			Vector3 contactVel =
+				(m.physB->GetLinearVelocity() + Vector3::Cross(m.physB->GetAngularVelocity(), p.relativeB)) -
+				(m.physA->GetLinearVelocity() + Vector3::Cross(m.physA->GetAngularVelocity(), p.relativeA));
+			float closingVel	= Vector3::Dot(contactVel, p.normal);
+			float impulse		= std::max((p.bounceVelocity - closingVel) * p.normalMass, 0.0f);
+			ApplyImpulse(m, p, p.normal * impulse, true, true);
+		}
+	}
+	lateBounces.clear();
+}
+
+//Applies impulse to B, and the opposite to A
+void ContactSolver::ApplyImpulse(Manifold& m, const ContactPoint& p, const Vector3& impulse, bool toA, bool toB) {
+	if (toA && m.inverseMassA > 0.0f) {
+		m.physA->SetLinearVelocity(m.physA->GetLinearVelocity() - impulse * m.inverseMassA);
+		m.physA->SetAngularVelocity(m.physA->GetAngularVelocity() + m.inertiaA * Vector3::Cross(p.relativeA, -impulse));
+	}
+	if (toB && m.inverseMassB > 0.0f) {
+		m.physB->SetLinearVelocity(m.physB->GetLinearVelocity() + impulse * m.inverseMassB);
+		m.physB->SetAngularVelocity(m.physB->GetAngularVelocity() + m.inertiaB * Vector3::Cross(p.relativeB, impulse));
+	}
+}
+
+void ContactSolver::SolveManifold(Manifold& m) {
+	if (m.inverseMassA + m.inverseMassB == 0.0f) {
+		return;
+	}
+	bool useFriction = m.frictionA || m.frictionB;
+
+	for (int i = 0; i < m.pointCount; ++i) {
+		ContactPoint& p = m.points[i];
+
+		Vector3 contactVel =
+			(m.physB->GetLinearVelocity() + Vector3::Cross(m.physB->GetAngularVelocity(), p.relativeB)) -
+			(m.physA->GetLinearVelocity() + Vector3::Cross(m.physA->GetAngularVelocity(), p.relativeA));
+
+		//Friction first - it can only hold on as hard as the objects are being pushed together
+		if (useFriction) {
+			float maxFriction = m.friction * p.normalImpulse;
+
+			float oldImpulse	= p.tangentImpulse1;
+			p.tangentImpulse1	= Clamp(oldImpulse - Vector3::Dot(contactVel, p.tangent1) * p.tangentMass1, -maxFriction, maxFriction);
+			Vector3 impulse		= p.tangent1 * (p.tangentImpulse1 - oldImpulse);
+
+			oldImpulse			= p.tangentImpulse2;
+			p.tangentImpulse2	= Clamp(oldImpulse - Vector3::Dot(contactVel, p.tangent2) * p.tangentMass2, -maxFriction, maxFriction);
+			impulse				= impulse + p.tangent2 * (p.tangentImpulse2 - oldImpulse);
+
+			ApplyImpulse(m, p, impulse, m.frictionA, m.frictionB);
+
+			contactVel =
+				(m.physB->GetLinearVelocity() + Vector3::Cross(m.physB->GetAngularVelocity(), p.relativeB)) -
+				(m.physA->GetLinearVelocity() + Vector3::Cross(m.physA->GetAngularVelocity(), p.relativeA));
+		}
+
+		//The total impulse pushing the objects apart can never go below zero - contacts can't pull
+		float oldImpulse	= p.normalImpulse;
+		float closingVel	= Vector3::Dot(contactVel, p.normal);
+		p.normalImpulse		= std::max(oldImpulse + (p.velocityBias - closingVel) * p.normalMass, 0.0f);
+
+		ApplyImpulse(m, p, p.normal * (p.normalImpulse - oldImpulse), true, true);
+	}
+}
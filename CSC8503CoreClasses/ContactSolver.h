@@ -0,0 +1,174 @@
+#pragma once
+#include "CollisionDetection.h"
+#include "CollisionPairCache.h"
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		class PhysicsObject;
+
+		/*
+		An iterative, sequential impulse solver for the contacts found by the
+		narrowphase.
+
+		Rather than resolving each contact as soon as it's found, every
+		touching pair keeps a manifold of up to 4 contact points that lasts
+		for as long as the pair stays in contact. Each step, the contact
+		the narrowphase found is merged into it - replacing a point close to
+		it, or being added as a new one - and points that the bodies have
+		since moved away from are dropped. A box resting on the floor builds
+		up a point at each corner it's touching, rather than being pushed
+		around by one corner at a time.
+
+		Solving then works on velocities only - each iteration, every point
+		applies whatever impulse it needs to stop the bodies closing in on
+		each other, clamped so that the total it has applied this step
+		never pulls them together. Friction is clamped by the normal
+		impulse, so it can't hold on any harder than the bodies are being
+		pressed together. Overlaps are pushed apart by a small extra
+		separating velocity, rather than moving the objects directly.
+
+		The total impulse each point applied is remembered, and applied
+		again at the start of the next step (warm starting). Resting
+		contacts then start off almost solved, which is what lets stacks
+		settle with only a few iterations.
+		*/
+		class ContactSolver {
+		public:
+			ContactSolver();
+			~ContactSolver();
+
+			void Clear();
+
+			//Merges a contact found by the narrowphase this step into its pair's manifold
+			void AddContact(const CollisionDetection::CollisionInfo& info);
+
+			/*
+			Removes every manifold that has an object in it that removeObject
+			says is gone. It's given the objects' handles, as gone can mean
+			deleted, too.
+			*/
+			template<class F>
+			void RemoveManifolds(F&& removeObject) {
+				for (int i = 0; i < pairs.GetSlotCount(); ++i) {
+					if (pairs.IsSlotUsed(i) && (removeObject(pairs.GetHandleA(i)) || removeObject(pairs.GetHandleB(i)))) {
+						pairs.Remove(i);
+					}
+				}
+			}
+
+			//Calls func(manifold, a, b) for every pair with a manifold
+			template<class F>
+			void ForEachManifold(F&& func) const {
+				for (int i = 0; i < pairs.GetSlotCount(); ++i) {
+					if (pairs.IsSlotUsed(i)) {
+						func(i, manifolds[i].a, manifolds[i].b);
+					}
+				}
+			}
+
+			/*
+			Drops any points that the objects have drifted away from, and any
+			pairs left without one, then works out everything the solver will
+			need for a step of dt, and applies last step's impulses again.
+			Pairs where both objects are asleep are left exactly as they are.
+			*/
+			void PreSolve(float dt);
+
+			/*
+			A single iteration over the contact points of the given manifolds.
+			Manifolds that don't share any objects can be solved at the same
+			time, on different threads.
+			*/
+			void SolveVelocities(const int* manifoldList, int count);
+
+			/*
+			Points found before the objects touch (see SweptIntersection) can't
+			bounce them apart when they're solved, or they'd bounce off thin
+			air. Once the objects have been moved together, this gives them the
+			bounce they'd have had when they hit.
+			*/
+			void ApplyLateBounces();
+
+			int GetManifoldCount() const {
+				return pairs.GetPairCount();
+			}
+
+			static constexpr int MaxPoints = 4;
+
+			//Overlaps smaller than this are left alone, so resting contacts don't jitter
+			static constexpr float AllowedPenetration	= 0.01f;
+			//How much of the remaining overlap is corrected each step
+			static constexpr float BaumgarteFactor		= 0.2f;
+			static constexpr float MaxCorrectionSpeed	= 5.0f;
+			//Objects closing slower than this don't bounce, so resting objects settle
+			static constexpr float BounceThreshold		= 1.0f;
+			//How far a point can drift from where it was found before it's dropped
+			static constexpr float BreakingDistance		= 0.05f;
+			static constexpr float MatchDistance		= 0.05f;
+
+		protected:
+			struct ContactPoint {
+				//Where the contact is on each object, in the object's local space
+				Vector3 anchorA;
+				Vector3 anchorB;
+				Vector3 normal;
+				Vector3 tangent1;
+				Vector3 tangent2;
+				//The overlap when it was found, and the gap between the anchors at that point
+				float	penetration;
+				Vector3 foundGap;
+				//The point is dropped once the overlap is less than this
+				float	breakingPenetration;
+
+				//Worked out again every step
+				Vector3 relativeA;
+				Vector3 relativeB;
+				float	normalMass;
+				float	tangentMass1;
+				float	tangentMass2;
+				float	velocityBias;
+				float	bounceVelocity;	//Only for points found before the objects touched
+
+				//Kept between steps, for warm starting
+				float	normalImpulse;
+				float	tangentImpulse1;
+				float	tangentImpulse2;
+			};
+
+			struct Manifold {
+				GameObject* a;
+				GameObject* b;
+				ContactPoint points[MaxPoints];
+				int		pointCount;
+				bool	awake;		//Whether it's being solved this step
+				bool	lateBounce;	//Whether any points have a bounceVelocity
+
+				float	restitution;
+				float	friction;
+				bool	frictionA;	//Whether each object is affected by friction
+				bool	frictionB;
+
+				PhysicsObject* physA;
+				PhysicsObject* physB;
+				float	inverseMassA;
+				float	inverseMassB;
+				Matrix3 inertiaA;
+				Matrix3 inertiaB;
+			};
+
+			void AddPoint(Manifold& m, const ContactPoint& p);
+			void RefreshPoints(Manifold& m);
+			void PrepareManifold(Manifold& m, float dt);
+			void WarmStart(Manifold& m);
+			void SolveManifold(Manifold& m);
+
+			void ApplyImpulse(Manifold& m, const ContactPoint& p, const Vector3& impulse, bool toA, bool toB);
+
+			//The slot each pair gets in this cache is its index into manifolds
+			CollisionPairCache		pairs;
+			std::vector<Manifold>	manifolds;
+			std::vector<int>		lateBounces;
+		};
+	}
+}
@@ -0,0 +1,412 @@
+#pragma once
+#include "Vector3.h"
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		A bounding volume hierarchy that lives across frames, rather than
+		being rebuilt from scratch every physics step like the QuadTree.
+
+		Each leaf stores a 'fat' AABB - the object's real AABB grown by a
+		margin (and by how far it is expected to move). As long as the
+		object's real AABB stays inside its fat one, nothing in the tree
+		has to change. Only when it escapes do we pull the leaf out and
+		put it back in somewhere better. Nodes are kept in a single vector
+		and linked by index, so there's no per-step heap traffic.
+		*/
+		template<class T>
+		class DynamicAABBTree {
+		public:
+			static constexpr int NullNode = -1;
+
+			DynamicAABBTree(float fatMargin = 0.2f) {
+				root		= NullNode;
+				freeList	= NullNode;
+				proxyCount	= 0;
+				margin		= fatMargin;
+			}
+			~DynamicAABBTree() {
+			}
+
+			void Clear() {
+				nodes.clear();
+				root		= NullNode;
+				freeList	= NullNode;
+				proxyCount	= 0;
+			}
+
+			int CreateProxy(T object, const Vector3& pos, const Vector3& halfSize) {
+				int proxy = AllocateNode();
+				Node& n = nodes[proxy];
+				n.min		= pos - halfSize - Vector3(margin, margin, margin);
+				n.max		= pos + halfSize + Vector3(margin, margin, margin);
+				n.object	= object;
+				n.height	= 0;
+				InsertLeaf(proxy);
+				proxyCount++;
+				return proxy;
+			}
+
+			void DestroyProxy(int proxy) {
+				RemoveLeaf(proxy);
+				FreeNode(proxy);
+				proxyCount--;
+			}
+
+			/*
+			Returns true if the proxy had to be re-inserted. The displacement
+			is how far we think the object will move before the next update,
+			and is used to stretch the fat AABB in that direction.
+			*/
+			bool MoveProxy(int proxy, const Vector3& pos, const Vector3& halfSize, const Vector3& displacement) {
+				Vector3 tightMin = pos - halfSize;
+				Vector3 tightMax = pos + halfSize;
+
+				Node& n = nodes[proxy];
+				if (Contains(n.min, n.max, tightMin, tightMax)) {
+					return false;
+				}
+				RemoveLeaf(proxy);
+
+				Vector3 fatMin = tightMin - Vector3(margin, margin, margin);
+				Vector3 fatMax = tightMax + Vector3(margin, margin, margin);
+				for (int i = 0; i < 3; ++i) {
+					if (displacement[i] < 0.0f) {
+						fatMin[i] += displacement[i];
+					}
+					else {
+						fatMax[i] += displacement[i];
+					}
+				}
+				nodes[proxy].min = fatMin;
+				nodes[proxy].max = fatMax;
+				InsertLeaf(proxy);
+				return true;
+			}
+
+			T GetObject(int proxy) const {
+				return nodes[proxy].object;
+			}
+
+			int GetProxyCount() const {
+				return proxyCount;
+			}
+
+			/*
+			Calls func(object) for every leaf whose fat AABB overlaps the given box.
+			*/
+			template<class F>
+			void Query(const Vector3& min, const Vector3& max, F&& func) const {
+				if (root == NullNode) {
+					return;
+				}
+				queryStack.clear();
+				queryStack.push_back(root);
+				while (!queryStack.empty()) {
+					int index = queryStack.back();
+					queryStack.pop_back();
+
+					const Node& n = nodes[index];
+					if (!Overlaps(n.min, n.max, min, max)) {
+						continue;
+					}
+					if (n.IsLeaf()) {
+						func(n.object);
+					}
+					else {
+						queryStack.push_back(n.left);
+						queryStack.push_back(n.right);
+					}
+				}
+			}
+
+			/*
+			Calls func(a, b) once for every pair of leaves whose fat AABBs overlap.
+			Every leaf is queried against the tree, and a pair is only reported
+			from the leaf with the lower index, so no pair is reported twice.
+			*/
+			template<class F>
+			void OperateOnPairs(F&& func) const {
+				if (root == NullNode) {
+					return;
+				}
+				for (int leaf = 0; leaf < (int)nodes.size(); ++leaf) {
+					const Node& l = nodes[leaf];
+					if (l.height != 0) {
+						continue; //internal or free node
+					}
+					queryStack.clear();
+					queryStack.push_back(root);
+					while (!queryStack.empty()) {
+						int index = queryStack.back();
+						queryStack.pop_back();
+
+						const Node& n = nodes[index];
+						if (!Overlaps(n.min, n.max, l.min, l.max)) {
+							continue;
+						}
+						if (n.IsLeaf()) {
+							if (index > leaf) {
+								func(l.object, n.object);
+							}
+						}
+						else {
+							queryStack.push_back(n.left);
+							queryStack.push_back(n.right);
+						}
+					}
+				}
+			}
+
+		protected:
+			struct Node {
+				Vector3 min;
+				Vector3 max;
+				T		object;
+
+				int parent;
+				int left;
+				int right;
+				int next;	//free list link
+				int height;	//0 for leaves, -1 for free nodes
+
+				bool IsLeaf() const {
+					return left == NullNode;
+				}
+			};
+
+			static bool Overlaps(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB) {
+				return	minA.x <= maxB.x && maxA.x >= minB.x &&
+						minA.y <= maxB.y && maxA.y >= minB.y &&
+						minA.z <= maxB.z && maxA.z >= minB.z;
+			}
+
+			static bool Contains(const Vector3& outerMin, const Vector3& outerMax, const Vector3& innerMin, const Vector3& innerMax) {
+				return	outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+						outerMax.x >= innerMax.x && outerMax.y >= innerMax.y && outerMax.z >= innerMax.z;
+			}
+
+			static Vector3 Min(const Vector3& a, const Vector3& b) {
+				return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+			}
+
+			static Vector3 Max(const Vector3& a, const Vector3& b) {
+				return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+			}
+
+			static float SurfaceArea(const Vector3& min, const Vector3& max) {
+				Vector3 d = max - min;
+				return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+			}
+
+			int AllocateNode() {
+				int index;
+				if (freeList != NullNode) {
+					index		= freeList;
+					freeList	= nodes[index].next;
+				}
+				else {
+					index = (int)nodes.size();
+					nodes.emplace_back();
+				}
+				Node& n = nodes[index];
+				n.parent	= NullNode;
+				n.left		= NullNode;
+				n.right		= NullNode;
+				n.next		= NullNode;
+				n.height	= 0;
+				return index;
+			}
+
+			void FreeNode(int index) {
+				nodes[index].next	= freeList;
+				nodes[index].height = -1;
+				freeList			= index;
+			}
+
+			void InsertLeaf(int leaf) {
+				if (root == NullNode) {
+					root = leaf;
+					nodes[root].parent = NullNode;
+					return;
+				}
+				//Walk down the tree, picking whichever child grows the least
+				Vector3 leafMin = nodes[leaf].min;
+				Vector3 leafMax = nodes[leaf].max;
+				int index = root;
+				while (!nodes[index].IsLeaf()) {
+					const Node& n = nodes[index];
+					float area			= SurfaceArea(n.min, n.max);
+					float combinedArea	= SurfaceArea(Min(n.min, leafMin), Max(n.max, leafMax));
+
+					float cost				= 2.0f * combinedArea;
+					float inheritanceCost	= 2.0f * (combinedArea - area);
+
+					float costLeft	= ChildCost(n.left, leafMin, leafMax) + inheritanceCost;
+					float costRight = ChildCost(n.right, leafMin, leafMax) + inheritanceCost;
+
+					if (cost < costLeft && cost < costRight) {
+						break;
+					}
+					index = costLeft < costRight ? n.left : n.right;
+				}
+				int sibling		= index;
+				int oldParent	= nodes[sibling].parent;
+				int newParent	= AllocateNode();
+				nodes[newParent].parent = oldParent;
+				nodes[newParent].min	= Min(leafMin, nodes[sibling].min);
+				nodes[newParent].max	= Max(leafMax, nodes[sibling].max);
+				nodes[newParent].height = nodes[sibling].height + 1;
+
+				if (oldParent != NullNode) {
+					if (nodes[oldParent].left == sibling) {
+						nodes[oldParent].left = newParent;
+					}
+					else {
+						nodes[oldParent].right = newParent;
+					}
+				}
+				else {
+					root = newParent;
+				}
+				nodes[newParent].left	= sibling;
+				nodes[newParent].right	= leaf;
+				nodes[sibling].parent	= newParent;
+				nodes[leaf].parent		= newParent;
+
+				Refit(nodes[leaf].parent);
+			}
+
+			float ChildCost(int child, const Vector3& leafMin, const Vector3& leafMax) const {
+				const Node& c = nodes[child];
+				float combined = SurfaceArea(Min(c.min, leafMin), Max(c.max, leafMax));
+				if (c.IsLeaf()) {
+					return combined;
+				}
+				return combined - SurfaceArea(c.min, c.max);
+			}
+
+			void RemoveLeaf(int leaf) {
+				if (leaf == root) {
+					root = NullNode;
+					return;
+				}
+				int parent		= nodes[leaf].parent;
+				int grandParent = nodes[parent].parent;
+				int sibling		= nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+				if (grandParent != NullNode) {
+					if (nodes[grandParent].left == parent) {
+						nodes[grandParent].left = sibling;
+					}
+					else {
+						nodes[grandParent].right = sibling;
+					}
+					nodes[sibling].parent = grandParent;
+					FreeNode(parent);
+					Refit(grandParent);
+				}
+				else {
+					root = sibling;
+					nodes[sibling].parent = NullNode;
+					FreeNode(parent);
+				}
+			}
+
+			//Walks back up to the root, rebalancing and growing the boxes as we go
+			void Refit(int index) {
+				while (index != NullNode) {
+					index = Balance(index);
+
+					Node& n = nodes[index];
+					const Node& l = nodes[n.left];
+					const Node& r = nodes[n.right];
+					n.height	= 1 + std::max(l.height, r.height);
+					n.min		= Min(l.min, r.min);
+					n.max		= Max(l.max, r.max);
+
+					index = n.parent;
+				}
+			}
+
+			/*
+			If one side of node A is much taller than the other, rotate the
+			taller child up into A's place. This keeps queries close to log(n)
+			even when objects are inserted in a spatially sorted order, which
+			is exactly what the grid scenes do.
+			*/
+			int Balance(int iA) {
+				Node& A = nodes[iA];
+				if (A.IsLeaf() || A.height < 2) {
+					return iA;
+				}
+				int iB = A.left;
+				int iC = A.right;
+				int balance = nodes[iC].height - nodes[iB].height;
+
+				if (balance > 1) {
+					return Rotate(iA, iC, iB);
+				}
+				if (balance < -1) {
+					return Rotate(iA, iB, iC);
+				}
+				return iA;
+			}
+
+			//Moves 'up' into A's place, A takes one of up's children
+			int Rotate(int iA, int iUp, int iOther) {
+				Node& A		= nodes[iA];
+				Node& Up	= nodes[iUp];
+				int iF = Up.left;
+				int iG = Up.right;
+
+				Up.left		= iA;
+				Up.parent	= A.parent;
+				A.parent	= iUp;
+
+				if (Up.parent != NullNode) {
+					if (nodes[Up.parent].left == iA) {
+						nodes[Up.parent].left = iUp;
+					}
+					else {
+						nodes[Up.parent].right = iUp;
+					}
+				}
+				else {
+					root = iUp;
+				}
+
+				int iKeep	= nodes[iF].height > nodes[iG].height ? iF : iG;
+				int iGive	= iKeep == iF ? iG : iF;
+
+				Up.right = iKeep;
+				if (A.left == iUp) {
+					A.left = iGive;
+				}
+				else {
+					A.right = iGive;
+				}
+				nodes[iGive].parent = iA;
+
+				A.min		= Min(nodes[iOther].min, nodes[iGive].min);
+				A.max		= Max(nodes[iOther].max, nodes[iGive].max);
+				A.height	= 1 + std::max(nodes[iOther].height, nodes[iGive].height);
+
+				Up.min		= Min(A.min, nodes[iKeep].min);
+				Up.max		= Max(A.max, nodes[iKeep].max);
+				Up.height	= 1 + std::max(A.height, nodes[iKeep].height);
+
+				return iUp;
+			}
+
+			std::vector<Node>	nodes;
+			int		root;
+			int		freeList;
+			int		proxyCount;
+			float	margin;
+
+			mutable std::vector<int> queryStack;
+		};
+	}
+}
@@ -0,0 +1,414 @@
+#pragma once
+#include "Vector3.h"
+#include "RayPacket.h"
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		A bounding volume hierarchy built for casting rays into, rather than
+		for finding pairs like the DynamicAABBTree.
+
+		The nodes are stored in one array, in the order a depth first walk
+		would visit them - a node's left child is always the next node along,
+		and each node knows where its subtree ends (its escape index). A ray
+		that misses a node jumps straight to its escape, and one that hits it
+		just moves on to the next node, so walking the tree needs no stack,
+		and mostly moves forwards through memory. Nodes are 32 bytes, so two
+		fit in a cache line.
+
+		Once built, the tree can be refit to where the objects have moved to
+		in a single backwards pass over the nodes, without changing its shape.
+		If the objects have moved so much that the boxes have grown a lot,
+		NeedsRebuild says so, and it's worth building it again.
+		*/
+		template<class T>
+		class FlatBVH {
+		public:
+			static constexpr int MaxLeafObjects = 4;
+
+			FlatBVH() {
+				buildArea	= 0.0f;
+				area		= 0.0f;
+			}
+			~FlatBVH() {
+			}
+
+			void Clear() {
+				nodes.clear();
+				objects.clear();
+				objectMins.clear();
+				objectMaxs.clear();
+				buildArea	= 0.0f;
+				area		= 0.0f;
+			}
+
+			/*
+			getBounds(object, min, max) gives an object's world space box, or
+			returns false if the object shouldn't be in the tree at all.
+			*/
+			template<class F>
+			void Build(const std::vector<T>& allObjects, F&& getBounds) {
+				Clear();
+				buildItems.clear();
+				for (const T& o : allObjects) {
+					BuildItem item;
+					if (getBounds(o, item.min, item.max)) {
+						item.object = o;
+						item.centre = (item.min + item.max) * 0.5f;
+						buildItems.emplace_back(item);
+					}
+				}
+				if (buildItems.empty()) {
+					return;
+				}
+				nodes.reserve(buildItems.size() * 2 / MaxLeafObjects + 1);
+				BuildNode(0, (int)buildItems.size());
+
+				objects.reserve(buildItems.size());
+				objectMins.reserve(buildItems.size());
+				objectMaxs.reserve(buildItems.size());
+				for (const BuildItem& item : buildItems) {
+					objects.emplace_back(item.object);
+					objectMins.emplace_back(item.min);
+					objectMaxs.emplace_back(item.max);
+				}
+				area		= GetTotalArea();
+				buildArea	= area;
+			}
+
+			/*
+			Moves every box to where getBounds says its object is now. Objects
+			getBounds returns false for keep their old box.
+			*/
+			template<class F>
+			void Refit(F&& getBounds) {
+				for (size_t i = 0; i < objects.size(); ++i) {
+					getBounds(objects[i], objectMins[i], objectMaxs[i]);
+				}
+				//Children always come after their parent, so going backwards visits them first
+				for (int i = (int)nodes.size() - 1; i >= 0; --i) {
+					Node& n = nodes[i];
+					if (n.IsLeaf()) {
+						int first	= n.GetFirstObject();
+						int last	= first + n.GetObjectCount();
+						n.min = objectMins[first];
+						n.max = objectMaxs[first];
+						for (int j = first + 1; j < last; ++j) {
+							n.min = Min(n.min, objectMins[j]);
+							n.max = Max(n.max, objectMaxs[j]);
+						}
+					}
+					else {
+						const Node& left	= nodes[i + 1];
+						const Node& right	= nodes[left.escape];
+						n.min = Min(left.min, right.min);
+						n.max = Max(left.max, right.max);
+					}
+				}
+				area = GetTotalArea();
+			}
+
+			//True once refitting has made the tree much worse to walk than when it was built
+			bool NeedsRebuild() const {
+				return area > buildArea * 2.0f;
+			}
+
+			int GetObjectCount() const {
+				return (int)objects.size();
+			}
+
+			int GetNodeCount() const {
+				return (int)nodes.size();
+			}
+
+			/*
+			Calls func(object, maxDistance) for every object whose box the ray
+			hits before maxDistance. func can shorten maxDistance as it finds
+			hits, so that only things in front of them are looked at, and can
+			return false to stop the walk altogether.
+			*/
+			template<class F>
+			void RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, F&& func) const {
+				Vector3 invDir = GetInverseDirection(direction);
+
+				int i		= 0;
+				int count	= (int)nodes.size();
+				while (i < count) {
+					const Node& n = nodes[i];
+					if (!RayHitsBox(origin, invDir, n.min, n.max, maxDistance)) {
+						i = n.escape;
+						continue;
+					}
+					if (n.IsLeaf()) {
+						int first	= n.GetFirstObject();
+						int last	= first + n.GetObjectCount();
+						for (int j = first; j < last; ++j) {
+							if (!func(objects[j], maxDistance)) {
+								return;
+							}
+						}
+						i = n.escape;
+					}
+					else {
+						i++;
+					}
+				}
+			}
+
+			/*
+			Walks the tree once for a whole packet of rays, rather than once
+			for each of them - a node is only skipped when none of the rays
+			hit it. Calls func(object, lanes, rays) for every object whose box
+			any of the rays hit, with a bitfield of which ones did. func can
+			shorten the rays' maxDistances as it finds hits.
+			*/
+			template<class F>
+			void RayCastPacket(RayPacket& rays, F&& func) const {
+				int i		= 0;
+				int count	= (int)nodes.size();
+				while (i < count) {
+					const Node& n = nodes[i];
+					if (!rays.HitsBox(n.min, n.max)) {
+						i = n.escape;
+						continue;
+					}
+					if (n.IsLeaf()) {
+						int first	= n.GetFirstObject();
+						int last	= first + n.GetObjectCount();
+						for (int j = first; j < last; ++j) {
+							if (int lanes = rays.HitsBox(objectMins[j], objectMaxs[j])) {
+								func(objects[j], lanes, rays);
+							}
+						}
+						i = n.escape;
+					}
+					else {
+						i++;
+					}
+				}
+			}
+
+			/*
+			The general version of the walks above - calls func(object) for
+			every object whose box boxTest(min, max) says yes to. boxTest is
+			asked again at every node, so it can get pickier as func finds
+			things, and func can return false to stop the walk altogether.
+			*/
+			template<class Test, class F>
+			void Query(Test&& boxTest, F&& func) const {
+				int i		= 0;
+				int count	= (int)nodes.size();
+				while (i < count) {
+					const Node& n = nodes[i];
+					if (!boxTest(n.min, n.max)) {
+						i = n.escape;
+						continue;
+					}
+					if (n.IsLeaf()) {
+						int first	= n.GetFirstObject();
+						int last	= first + n.GetObjectCount();
+						for (int j = first; j < last; ++j) {
+							if (boxTest(objectMins[j], objectMaxs[j]) && !func(objects[j])) {
+								return;
+							}
+						}
+						i = n.escape;
+					}
+					else {
+						i++;
+					}
+				}
+			}
+
+			static Vector3 GetInverseDirection(const Vector3& direction) {
+				//Axis aligned rays would divide by zero - a huge number gives the same answers
+				Vector3 invDir;
+				for (int i = 0; i < 3; ++i) {
+					invDir[i] = std::abs(direction[i]) > 1e-20f ? 1.0f / direction[i] : 1e30f;
+				}
+				return invDir;
+			}
+
+			//The slab test - does the ray enter the box before maxDistance, and leave it after 0?
+			static bool RayHitsBox(const Vector3& origin, const Vector3& invDir, const Vector3& boxMin, const Vector3& boxMax, float maxDistance) {
+				float tMin = 0.0f;
+				float tMax = maxDistance;
+				for (int i = 0; i < 3; ++i) {
+					float t0 = (boxMin[i] - origin[i]) * invDir[i];
+					float t1 = (boxMax[i] - origin[i]) * invDir[i];
+					tMin = std::max(tMin, std::min(t0, t1));
+					tMax = std::min(tMax, std::max(t0, t1));
+				}
+				return tMin <= tMax;
+			}
+
+		protected:
+			struct Node {
+				Vector3 min;
+				int		escape;	//Where to go once this node's subtree is done with
+				Vector3 max;
+				int		leaf;	//First object << 3 | object count, or 0 for an inner node
+
+				bool IsLeaf() const {
+					return leaf != 0;
+				}
+				int GetFirstObject() const {
+					return leaf >> 3;
+				}
+				int GetObjectCount() const {
+					return leaf & 7;
+				}
+			};
+
+			struct BuildItem {
+				T		object;
+				Vector3 min;
+				Vector3 max;
+				Vector3 centre;
+			};
+
+			static Vector3 Min(const Vector3& a, const Vector3& b) {
+				return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+			}
+
+			static Vector3 Max(const Vector3& a, const Vector3& b) {
+				return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+			}
+
+			static float SurfaceArea(const Vector3& min, const Vector3& max) {
+				Vector3 d = max - min;
+				return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+			}
+
+			float GetTotalArea() const {
+				float total = 0.0f;
+				for (const Node& n : nodes) {
+					total += SurfaceArea(n.min, n.max);
+				}
+				return total;
+			}
+
+			/*
+			Splits the objects along the axis their centres are most spread
+			out on, at whichever of a handful of evenly spaced planes the
+			surface area heuristic likes best - the cheaper it looks to walk
+			both sides, weighted by how likely a ray is to hit each of them.
+			*/
+			void BuildNode(int first, int count) {
+				int index = (int)nodes.size();
+				nodes.emplace_back();
+
+				Vector3 min				= buildItems[first].min;
+				Vector3 max				= buildItems[first].max;
+				Vector3 centreMin		= buildItems[first].centre;
+				Vector3 centreMax		= buildItems[first].centre;
+				for (int i = first + 1; i < first + count; ++i) {
+					min			= Min(min, buildItems[i].min);
+					max			= Max(max, buildItems[i].max);
+					centreMin	= Min(centreMin, buildItems[i].centre);
+					centreMax	= Max(centreMax, buildItems[i].centre);
+				}
+				nodes[index].min = min;
+				nodes[index].max = max;
+
+				if (count <= MaxLeafObjects) {
+					nodes[index].leaf	= (first << 3) | count;
+					nodes[index].escape = index + 1;
+					return;
+				}
+
+				Vector3 extent = centreMax - centreMin;
+				int axis = 0;
+				if (extent.y > extent[axis]) axis = 1;
+				if (extent.z > extent[axis]) axis = 2;
+
+				auto begin	= buildItems.begin() + first;
+				auto end	= begin + count;
+				int split	= count / 2;
+
+				if (extent[axis] > 0.0f) {
+					constexpr int BinCount = 12;
+					int		binCounts[BinCount] = {};
+					Vector3 binMins[BinCount];
+					Vector3 binMaxs[BinCount];
+					float	binScale = BinCount / extent[axis];
+
+					auto getBin = [&](const BuildItem& item) {
+						return std::min(BinCount - 1, (int)((item.centre[axis] - centreMin[axis]) * binScale));
+					};
+					for (auto i = begin; i != end; ++i) {
+						int b = getBin(*i);
+						binMins[b] = binCounts[b] ? Min(binMins[b], i->min) : i->min;
+						binMaxs[b] = binCounts[b] ? Max(binMaxs[b], i->max) : i->max;
+						binCounts[b]++;
+					}
+
+					//How expensive each plane looks, sweeping in from both sides
+					float	leftCost[BinCount - 1];
+					int		leftCount = 0;
+					Vector3 leftMin(FLT_MAX, FLT_MAX, FLT_MAX);
+					Vector3 leftMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+					for (int b = 0; b < BinCount - 1; ++b) {
+						if (binCounts[b]) {
+							leftMin = Min(leftMin, binMins[b]);
+							leftMax = Max(leftMax, binMaxs[b]);
+							leftCount += binCounts[b];
+						}
+						leftCost[b] = leftCount ? SurfaceArea(leftMin, leftMax) * leftCount : 0.0f;
+					}
+					float	bestCost	= FLT_MAX;
+					int		bestPlane	= -1;
+					int		rightCount	= 0;
+					Vector3 rightMin(FLT_MAX, FLT_MAX, FLT_MAX);
+					Vector3 rightMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+					for (int b = BinCount - 1; b > 0; --b) {
+						if (binCounts[b]) {
+							rightMin = Min(rightMin, binMins[b]);
+							rightMax = Max(rightMax, binMaxs[b]);
+							rightCount += binCounts[b];
+						}
+						if (rightCount == 0 || rightCount == count) {
+							continue;
+						}
+						float cost = leftCost[b - 1] + SurfaceArea(rightMin, rightMax) * rightCount;
+						if (cost < bestCost) {
+							bestCost	= cost;
+							bestPlane	= b;
+						}
+					}
+					if (bestPlane > 0) {
+						auto middle = std::partition(begin, end, [&](const BuildItem& item) {
+							return getBin(item) < bestPlane;
+						});
+						split = (int)(middle - begin);
+					}
+				}
+				//Everything's in the same place - just split them down the middle
+				if (split == 0 || split == count || extent[axis] <= 0.0f) {
+					split = count / 2;
+					std::nth_element(begin, begin + split, end, [&](const BuildItem& a, const BuildItem& b) {
+						return a.centre[axis] < b.centre[axis];
+					});
+				}
+
+				nodes[index].leaf = 0;
+				BuildNode(first, split);
+				BuildNode(first + split, count - split);
+				nodes[index].escape = (int)nodes.size();
+			}
+
+			std::vector<Node>		nodes;
+			std::vector<T>			objects;
+			std::vector<Vector3>	objectMins;
+			std::vector<Vector3>	objectMaxs;
+			std::vector<BuildItem>	buildItems;
+
+			float buildArea;
+			float area;
+		};
+	}
+}
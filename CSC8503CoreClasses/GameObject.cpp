@@ -3,12 +3,14 @@
 #include "PhysicsObject.h"
 #include "RenderObject.h"
 #include "NetworkObject.h"
+#include "GameWorld.h"
 
 using namespace NCL::CSC8503;
 
 GameObject::GameObject(string objectName)	{
 	name			= objectName;
 	worldID			= -1;
+	world			= nullptr;
 	isActive		= true;
 	boundingVolume	= nullptr;
 	physicsObject	= nullptr;
@@ -30,6 +32,34 @@ GameObject::~GameObject()	{
 	delete networkObject;
 }
 
+void GameObject::SetBoundingVolume(CollisionVolume* vol) {
+	boundingVolume = vol;
+	if (world) {
+		world->UpdateComponents(this);
+	}
+}
+
+void GameObject::SetRenderObject(RenderObject* newObject) {
+	renderObject = newObject;
+	if (world) {
+		world->UpdateComponents(this);
+	}
+}
+
+void GameObject::SetPhysicsObject(PhysicsObject* newObject) {
+	physicsObject = newObject;
+	if (world) {
+		world->UpdateComponents(this);
+	}
+}
+
+void GameObject::SetNetworkObject(NetworkObject* newObject) {
+	networkObject = newObject;
+	if (world) {
+		world->UpdateComponents(this);
+	}
+}
+
 bool GameObject::GetBroadphaseAABB(Vector3&outSize) const {
 	if (!boundingVolume) {
 		return false;
@@ -1,6 +1,8 @@
 #pragma once
 #include "Transform.h"
 #include "CollisionVolume.h"
+#include "SlotMap.h"
+#include "ObjectPool.h"
 
 
 using std::vector;
@@ -9,16 +11,37 @@ namespace NCL::CSC8503 {
 	class NetworkObject;
 	class RenderObject;
 	class PhysicsObject;
+	class GameObject;
+	class GameWorld;
+
+	typedef SlotHandle<GameObject*> GameObjectHandle;
 
 	class GameObject	{
 	public:
 		GameObject(std::string name = "");
-		~GameObject();
+		virtual ~GameObject();
+
+		/*
+		GameObjects, and anything derived from them, come from their own
+		pools - see ObjectPools. The destructor is virtual so that deleting
+		one through a GameObject pointer hands back the right sized block.
+		*/
+		static void* operator new(size_t size) {
+			return ObjectPools::Allocate(PoolType::GameObjects, size);
+		}
 
-		void SetBoundingVolume(CollisionVolume* vol) {
-			boundingVolume = vol;
+		static void operator delete(void* p, size_t size) {
+			ObjectPools::Free(PoolType::GameObjects, p, size);
 		}
 
+		/*
+		The GameWorld keeps its own lists of which objects have which
+		components (see ComponentSet), so components should always be
+		given to an object through these, rather than set directly - they
+		let the world know about it, if the object's in one.
+		*/
+		void SetBoundingVolume(CollisionVolume* vol);
+
 		const CollisionVolume* GetBoundingVolume() const {
 			return boundingVolume;
 		}
@@ -43,13 +66,9 @@ namespace NCL::CSC8503 {
 			return networkObject;
 		}
 
-		void SetRenderObject(RenderObject* newObject) {
-			renderObject = newObject;
-		}
-
-		void SetPhysicsObject(PhysicsObject* newObject) {
-			physicsObject = newObject;
-		}
+		void SetRenderObject(RenderObject* newObject);
+		void SetPhysicsObject(PhysicsObject* newObject);
+		void SetNetworkObject(NetworkObject* newObject);
 
 		const std::string& GetName() const {
 			return name;
@@ -74,6 +93,16 @@ namespace NCL::CSC8503 {
 		int		GetWorldID() const {
 			return worldID;
 		}
+
+		//Set by the GameWorld - null while the object isn't in one
+		void SetWorldHandle(GameWorld* newWorld, GameObjectHandle newHandle) {
+			world		= newWorld;
+			worldHandle = newHandle;
+		}
+
+		GameObjectHandle GetWorldHandle() const {
+			return worldHandle;
+		}
 		bool isTrigger;
 		bool deleteOnTrigger;
 		bool affectedByFriction;
@@ -92,6 +121,8 @@ namespace NCL::CSC8503 {
 
 		bool		isActive;
 		int			worldID;
+		GameWorld*	world;
+		GameObjectHandle worldHandle;
 		std::string	name;
 
 		Vector3 broadphaseAABB;
@@ -3,6 +3,12 @@
 #include "Constraint.h"
 #include "CollisionDetection.h"
 #include "Camera.h"
+#include "AABBVolume.h"
+#include "OBBVolume.h"
+#include "SphereVolume.h"
+#include "CapsuleVolume.h"
+#include "RayPacket.h"
+#include "ThreadPool.h"
 
 
 using namespace NCL;
@@ -15,43 +21,101 @@ GameWorld::GameWorld()	{
 	shuffleObjects		= false;
 	worldIDCounter		= 0;
 	worldStateCounter	= 0;
+	objectsMovedCounter	= 0;
+	raycastBVHStateID	= -1;
+	raycastBVHMovedID	= -1;
+	threadPool			= nullptr;
 }
 
 GameWorld::~GameWorld()	{
 }
 
 void GameWorld::Clear() {
-	gameObjects.clear();
-	constraints.clear();
+	for (GameObject* o : gameObjects) {
+		o->SetWorldHandle(nullptr, GameObjectHandle());
+	}
+	gameObjects.Clear();
+	constraints.Clear();
+	physicsComponents.Clear();
+	collisionComponents.Clear();
+	renderComponents.Clear();
+	networkComponents.Clear();
 	worldIDCounter		= 0;
 	worldStateCounter	= 0;
+	raycastBVH.Clear();
+	raycastBVHStateID	= -1; //The state counter starts again, so this could match a new world
 }
 
 void GameWorld::ClearAndErase() {
-	for (auto& i : gameObjects) {
+	std::vector<GameObject*> objects = gameObjects.GetValues();
+	std::vector<Constraint*> oldConstraints = constraints.GetValues();
+	Clear();
+	for (GameObject* i : objects) {
 		delete i;
-		i = nullptr;
 	}
-	for (auto& i : constraints) {
+	for (Constraint* i : oldConstraints) {
 		delete i;
-		i = nullptr;
 	}
-	Clear();
+	ObjectPools::ResetEmptyPools(); //The next level starts with tightly packed pools again
 }
 
-void GameWorld::AddGameObject(GameObject* o, int worldID) {
-	gameObjects.emplace_back(o);
+GameObjectHandle GameWorld::AddGameObject(GameObject* o, int worldID) {
+	GameObjectHandle handle = gameObjects.Insert(o);
+	o->SetWorldHandle(this, handle);
 	if (worldID == -1)o->SetWorldID(worldIDCounter++);
 	else o->SetWorldID(worldID);
+	UpdateComponents(o);
 	worldStateCounter++;
+	return handle;
 }
 
 void GameWorld::RemoveGameObject(GameObject* o, bool andDelete) {
-	gameObjects.erase(std::remove(gameObjects.begin(), gameObjects.end(), o), gameObjects.end());
+	if (Contains(o)) {
+		uint32_t slot = o->GetWorldHandle().index;
+		physicsComponents.Remove(slot);
+		collisionComponents.Remove(slot);
+		renderComponents.Remove(slot);
+		networkComponents.Remove(slot);
+		gameObjects.Remove(o->GetWorldHandle());
+		o->SetWorldHandle(nullptr, GameObjectHandle());
+		worldStateCounter++;
+	}
 	if (andDelete) {
 		delete o;
 		o = nullptr;
 	}
+}
+
+void GameWorld::RemoveGameObject(GameObjectHandle h, bool andDelete) {
+	if (GameObject* o = GetGameObject(h)) {
+		RemoveGameObject(o, andDelete);
+	}
+}
+
+template<class T>
+static void UpdateComponent(ComponentSet<T>& set, uint32_t slot, T component, GameObject* owner) {
+	if (component) {
+		set.Set(slot, component, owner);
+	}
+	else {
+		set.Remove(slot);
+	}
+}
+
+/*
+Changing what an object's made of counts as a change to the world - the
+physics system only checks for bodies that have gone when the world's
+state counter moves on.
+*/
+void GameWorld::UpdateComponents(GameObject* o) {
+	if (!Contains(o)) {
+		return;
+	}
+	uint32_t slot = o->GetWorldHandle().index;
+	UpdateComponent(physicsComponents, slot, o->GetPhysicsObject(), o);
+	UpdateComponent(collisionComponents, slot, o->GetBoundingVolume(), o);
+	UpdateComponent(renderComponents, slot, o->GetRenderObject(), o);
+	UpdateComponent(networkComponents, slot, o->GetNetworkObject(), o);
 	worldStateCounter++;
 }
 
@@ -64,9 +128,7 @@ void GameWorld::GetObjectIterators(
 }
 
 void GameWorld::OperateOnContents(GameObjectFunc f) {
-	for (GameObject* g : gameObjects) {
-		f(g);
-	}
+	ForEachObject(f);
 }
 
 void GameWorld::UpdateWorld(float dt) {
@@ -76,60 +138,552 @@ void GameWorld::UpdateWorld(float dt) {
 	std::default_random_engine e(seed);
 
 	if (shuffleObjects) {
-		std::shuffle(gameObjects.begin(), gameObjects.end(), e);
+		gameObjects.Shuffle(e);
 	}
 
 	if (shuffleConstraints) {
-		std::shuffle(constraints.begin(), constraints.end(), e);
+		constraints.Shuffle(e);
 	}
+	ObjectsMoved(); //Game code might have moved things since the last frame
+}
+
+/*
+The box each object's volume fits in, wherever it is right now - the
+broadphase AABB is only kept up to date while the broadphase is in use,
+and doesn't cover capsules, so it can't be used here.
+*/
+static bool GetRaycastBounds(GameObject* o, Vector3& min, Vector3& max) {
+	const CollisionVolume* volume = o->GetBoundingVolume();
+	if (!volume) {
+		return false;
+	}
+	Transform&	transform = o->GetTransform();
+	Vector3		halfSize;
+	switch (volume->type) {
+		case VolumeType::AABB: {
+			halfSize = ((const AABBVolume&)*volume).GetHalfDimensions();
+		}break;
+		case VolumeType::OBB: {
+			halfSize = Matrix3(transform.GetOrientation()).Absolute() * ((const OBBVolume&)*volume).GetHalfDimensions();
+		}break;
+		case VolumeType::Sphere: {
+			float r = ((const SphereVolume&)*volume).GetRadius();
+			halfSize = Vector3(r, r, r);
+		}break;
+		case VolumeType::Capsule: {
+			const CapsuleVolume& capsule = (const CapsuleVolume&)*volume;
+			Vector3 up = transform.GetOrientation() * Vector3(0, 1, 0);
+			float	r	= capsule.GetRadius();
+			halfSize = Vector3(std::abs(up.x), std::abs(up.y), std::abs(up.z)) * (capsule.GetHalfHeight() - r) + Vector3(r, r, r);
+			//The ray test's middle box doesn't turn with the capsule, so the box has to cover that too
+			halfSize.y = std::max(halfSize.y, capsule.GetHalfHeight() - r);
+		}break;
+		default: return false;
+	}
+	//The box ray tests let hits through up to 0.0001 outside the box, so rays just grazing it mustn't be culled first
+	halfSize += Vector3(0.001f, 0.001f, 0.001f);
+
+	Vector3 position = transform.GetPosition();
+	min = position - halfSize;
+	max = position + halfSize;
+	return true;
+}
+
+/*
+Objects being added or removed means building the BVH again, but if they've
+only moved, it can just be refit around them - unless it's got so much
+worse that building it again is worth it.
+
+Queries can come from several threads at once, so the first one to find it
+out of date does the work under the lock, and the rest wait, then find it's
+been done. The IDs are only set once it's ready to walk.
+*/
+void GameWorld::UpdateRaycastBVH() const {
+	if (raycastBVHStateID == worldStateCounter && raycastBVHMovedID == objectsMovedCounter) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(raycastBVHMutex);
+	if (raycastBVHStateID == worldStateCounter && raycastBVHMovedID == objectsMovedCounter) {
+		return;
+	}
+	if (raycastBVHStateID == worldStateCounter) {
+		raycastBVH.Refit(GetRaycastBounds);
+	}
+	if (raycastBVHStateID != worldStateCounter || raycastBVH.NeedsRebuild()) {
+		raycastBVH.Build(gameObjects.GetValues(), GetRaycastBounds);
+	}
+	raycastBVHStateID = worldStateCounter;
+	raycastBVHMovedID = objectsMovedCounter;
 }
 
 bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObject, GameObject* ignoreThis) const {
-	//The simplest raycast just goes through each object and sees if there's a collision
+	UpdateRaycastBVH();
+
+	//Only objects whose boxes the ray passes through get tested properly
 	RayCollision collision;
+	raycastBVH.RayCast(r.GetPosition(), r.GetDirection(), FLT_MAX,
+		[&](GameObject* i, float& maxDistance) {
+			if (i->ignoreRaycast || i == ignoreThis) { //objects might not be collideable etc...
+				return true;
+			}
+			RayCollision thisCollision;
+			if (!CollisionDetection::RayIntersection(r, *i, thisCollision)) {
+				return true;
+			}
+			if (!closestObject) {
+				collision		= thisCollision;
+				collision.node	= i;
+				return false;
+			}
+			if (thisCollision.rayDistance < collision.rayDistance) {
+				thisCollision.node	= i;
+				collision			= thisCollision;
+				maxDistance			= std::max(collision.rayDistance, 0.0f); //Nothing further away can be closer
+			}
+			return true;
+		}
+	);
+	if (collision.node) {
+		closestCollision = collision;
+		return true;
+	}
+	return false;
+}
+
+void GameWorld::RaycastBatch(std::span<const Ray> rays, std::span<RayCollision> collisions, std::span<GameObject* const> ignore) const {
+	UpdateRaycastBVH();
+
+	thread_local std::vector<int> rayOrder;
+
+	int rayCount = (int)std::min(rays.size(), collisions.size());
+	SortRaysForPackets(rays.first(rayCount), rayOrder);
 
-	for (auto& i : gameObjects) {
-		if (!i->GetBoundingVolume() || i->ignoreRaycast) { //objects might not be collideable etc...
-			continue;
+	//The pool's threads each have their own rayOrder, so they're handed this one's
+	const int* order = rayOrder.data();
+
+	int packetCount = (rayCount + SimdFloat::Width - 1) / SimdFloat::Width;
+	ThreadPool::ChunkFunc castPackets = [&](int /*chunk*/, int begin, int end) {
+		for (int p = begin; p < end; ++p) {
+			int first = p * SimdFloat::Width;
+			RaycastPacket(&order[first], std::min(SimdFloat::Width, rayCount - first), rays, collisions, ignore);
 		}
-		if (i == ignoreThis) {
-			continue;
+	};
+	if (threadPool) {
+		threadPool->ParallelFor(packetCount, 4, castPackets);
+	}
+	else {
+		castPackets(0, 0, packetCount);
+	}
+}
+
+//Spreads the bits of a 10 bit number out to every third bit
+static uint64_t SpreadBits(uint64_t v) {
+	v = (v | (v << 16)) & 0x030000FF;
+	v = (v | (v << 8))	& 0x0300F00F;
+	v = (v | (v << 4))	& 0x030C30C3;
+	v = (v | (v << 2))	& 0x09249249;
+	return v;
+}
+
+/*
+Rays in a packet only save any work if they go through the same parts of
+the BVH, so the rays are sorted by which way they're pointing (which
+octant), then by where they start, along a Morton curve - rays next to
+each other in the order then tend to start near each other too.
+*/
+void GameWorld::SortRaysForPackets(std::span<const Ray> rays, std::vector<int>& order) {
+	thread_local std::vector<std::pair<uint64_t, int>> rayKeys;
+
+	Vector3 originMin(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vector3 originMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const Ray& r : rays) {
+		Vector3 o = r.GetPosition();
+		for (int i = 0; i < 3; ++i) {
+			originMin[i] = std::min(originMin[i], o[i]);
+			originMax[i] = std::max(originMax[i], o[i]);
 		}
-		RayCollision thisCollision;
-		if (CollisionDetection::RayIntersection(r, *i, thisCollision)) {
-				
-			if (!closestObject) {	
-				closestCollision		= collision;
-				closestCollision.node = i;
-				return true;
+	}
+	Vector3 scale;
+	for (int i = 0; i < 3; ++i) {
+		float extent = originMax[i] - originMin[i];
+		scale[i] = extent > 0.0f ? 1023.0f / extent : 0.0f;
+	}
+
+	rayKeys.resize(rays.size());
+	for (size_t i = 0; i < rays.size(); ++i) {
+		Vector3 o = (rays[i].GetPosition() - originMin) * scale;
+		Vector3 d = rays[i].GetDirection();
+		uint64_t octant = (d.x < 0.0f ? 1 : 0) | (d.y < 0.0f ? 2 : 0) | (d.z < 0.0f ? 4 : 0);
+		uint64_t morton = SpreadBits((uint64_t)o.x) | (SpreadBits((uint64_t)o.y) << 1) | (SpreadBits((uint64_t)o.z) << 2);
+		rayKeys[i] = { (octant << 30) | morton, (int)i };
+	}
+	std::sort(rayKeys.begin(), rayKeys.end());
+
+	order.resize(rays.size());
+	for (size_t i = 0; i < rays.size(); ++i) {
+		order[i] = rayKeys[i].second;
+	}
+}
+
+/*
+Boxes and spheres are tested against the whole packet at once - anything
+else goes through the single ray tests, for each ray that reached it.
+*/
+void GameWorld::RaycastPacket(const int* rayIndices, int rayCount, std::span<const Ray> rays,
+	std::span<RayCollision> collisions, std::span<GameObject* const> ignore) const {
+	const Ray* packetRays[SimdFloat::Width];
+	for (int lane = 0; lane < rayCount; ++lane) {
+		packetRays[lane] = &rays[rayIndices[lane]];
+		collisions[rayIndices[lane]] = RayCollision();
+	}
+	RayPacket packet;
+	packet.Load(packetRays, rayCount);
+
+	auto addHit = [&](GameObject* o, int lane, float distance, const Vector3& point) {
+		int index = rayIndices[lane];
+		if (!ignore.empty() && ignore[index] == o) {
+			return;
+		}
+		RayCollision& closest = collisions[index];
+		if (distance < closest.rayDistance) {
+			closest.node		= o;
+			closest.rayDistance = distance;
+			closest.collidedAt	= point;
+			packet.maxDistance[lane] = std::max(distance, 0.0f); //Nothing further away can be closer
+		}
+	};
+
+	float distances[SimdFloat::Width];
+	raycastBVH.RayCastPacket(packet, [&](GameObject* o, int lanes, RayPacket&) {
+		if (o->ignoreRaycast) {
+			return;
+		}
+		const CollisionVolume* volume = o->GetBoundingVolume();
+		int hits = 0;
+		if (volume->type == VolumeType::AABB) {
+			hits = CollisionDetection::RayBoxPacketIntersection(packet, o->GetTransform().GetPosition(),
+				((const AABBVolume&)*volume).GetHalfDimensions(), distances) & lanes;
+		}
+		else if (volume->type == VolumeType::Sphere) {
+			hits = CollisionDetection::RaySpherePacketIntersection(packet, o->GetTransform().GetPosition(),
+				((const SphereVolume&)*volume).GetRadius(), distances) & lanes;
+		}
+		else {
+			for (int lane = 0; lane < rayCount; ++lane) {
+				RayCollision collision;
+				if ((lanes & (1 << lane)) && CollisionDetection::RayIntersection(*packetRays[lane], *o, collision)) {
+					addHit(o, lane, collision.rayDistance, collision.collidedAt);
+				}
+			}
+			return;
+		}
+		for (int lane = 0; lane < rayCount; ++lane) {
+			if (hits & (1 << lane)) {
+				const Ray& r = *packetRays[lane];
+				addHit(o, lane, distances[lane], r.GetPosition() + (r.GetDirection() * distances[lane]));
 			}
-			else {
-				if (thisCollision.rayDistance < collision.rayDistance) {
-					thisCollision.node = i;
-					collision = thisCollision;
+		}
+	});
+}
+
+
+static float DistanceSquaredToBox(const Vector3& point, const Vector3& boxMin, const Vector3& boxMax) {
+	float total = 0.0f;
+	for (int i = 0; i < 3; ++i) {
+		float d = std::max(std::max(boxMin[i] - point[i], point[i] - boxMax[i]), 0.0f);
+		total += d * d;
+	}
+	return total;
+}
+
+static float DistanceSquaredToSegment(const Vector3& point, const Vector3& a, const Vector3& b) {
+	Vector3 ab		= b - a;
+	float	lengthSq = ab.LengthSquared();
+	float	t		= lengthSq > 0.0f ? std::clamp(Vector3::Dot(point - a, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+	return (a + ab * t - point).LengthSquared();
+}
+
+static void GetCapsuleSegment(GameObject* o, const CapsuleVolume& capsule, Vector3& a, Vector3& b) {
+	Vector3 up = o->GetTransform().GetOrientation() * Vector3(0, 1, 0);
+	Vector3 position = o->GetTransform().GetPosition();
+	float	segment = capsule.GetHalfHeight() - capsule.GetRadius();
+	a = position + up * segment;
+	b = position - up * segment;
+}
+
+/*
+The queries only need a yes or no, so they use their own simple tests
+rather than the physics ones, which work out contact points too, and
+don't handle every pair of shapes.
+*/
+static bool SphereOverlapsObject(const Vector3& centre, float radius, GameObject* o) {
+	const CollisionVolume* volume = o->GetBoundingVolume();
+	Transform& transform = o->GetTransform();
+	switch (volume->type) {
+		case VolumeType::AABB: {
+			Vector3 halfSize = ((const AABBVolume&)*volume).GetHalfDimensions();
+			Vector3 position = transform.GetPosition();
+			return DistanceSquaredToBox(centre, position - halfSize, position + halfSize) <= radius * radius;
+		}
+		case VolumeType::OBB: {
+			Vector3 halfSize	= ((const OBBVolume&)*volume).GetHalfDimensions();
+			Vector3 localCentre = transform.GetOrientation().Conjugate() * (centre - transform.GetPosition());
+			return DistanceSquaredToBox(localCentre, -halfSize, halfSize) <= radius * radius;
+		}
+		case VolumeType::Sphere: {
+			float totalRadius = radius + ((const SphereVolume&)*volume).GetRadius();
+			return (centre - transform.GetPosition()).LengthSquared() <= totalRadius * totalRadius;
+		}
+		case VolumeType::Capsule: {
+			const CapsuleVolume& capsule = (const CapsuleVolume&)*volume;
+			Vector3 a, b;
+			GetCapsuleSegment(o, capsule, a, b);
+			float totalRadius = radius + capsule.GetRadius();
+			return DistanceSquaredToSegment(centre, a, b) <= totalRadius * totalRadius;
+		}
+		default: return false;
+	}
+}
+
+//Separating axis test between an axis aligned box and a rotated one
+static bool BoxOverlapsOBB(const Vector3& centre, const Vector3& halfSize, const Vector3& obbCentre, const Quaternion& obbOrientation, const Vector3& obbHalfSize) {
+	Vector3 axes[3] = {
+		obbOrientation * Vector3(1, 0, 0),
+		obbOrientation * Vector3(0, 1, 0),
+		obbOrientation * Vector3(0, 0, 1)
+	};
+	float r[3][3];
+	float absR[3][3];
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			r[i][j]		= axes[j][i];
+			absR[i][j]	= std::abs(r[i][j]) + 1e-6f; //Stops parallel edges making a cross product of zero look separating
+		}
+	}
+	Vector3 t = obbCentre - centre;
+
+	for (int i = 0; i < 3; ++i) {
+		float rb = obbHalfSize.x * absR[i][0] + obbHalfSize.y * absR[i][1] + obbHalfSize.z * absR[i][2];
+		if (std::abs(t[i]) > halfSize[i] + rb) {
+			return false;
+		}
+	}
+	for (int j = 0; j < 3; ++j) {
+		float ra = halfSize.x * absR[0][j] + halfSize.y * absR[1][j] + halfSize.z * absR[2][j];
+		if (std::abs(Vector3::Dot(t, axes[j])) > ra + obbHalfSize[j]) {
+			return false;
+		}
+	}
+	for (int i = 0; i < 3; ++i) {
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; ++j) {
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+			float ra = halfSize[i1] * absR[i2][j] + halfSize[i2] * absR[i1][j];
+			float rb = obbHalfSize[j1] * absR[i][j2] + obbHalfSize[j2] * absR[i][j1];
+			if (std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool BoxOverlapsObject(const Vector3& centre, const Vector3& halfSize, GameObject* o) {
+	const CollisionVolume* volume = o->GetBoundingVolume();
+	Transform& transform = o->GetTransform();
+	Vector3 boxMin = centre - halfSize;
+	Vector3 boxMax = centre + halfSize;
+	switch (volume->type) {
+		case VolumeType::AABB: {
+			return CollisionDetection::AABBTest(centre, transform.GetPosition(), halfSize, ((const AABBVolume&)*volume).GetHalfDimensions());
+		}
+		case VolumeType::OBB: {
+			return BoxOverlapsOBB(centre, halfSize, transform.GetPosition(), transform.GetOrientation(), ((const OBBVolume&)*volume).GetHalfDimensions());
+		}
+		case VolumeType::Sphere: {
+			float radius = ((const SphereVolume&)*volume).GetRadius();
+			return DistanceSquaredToBox(transform.GetPosition(), boxMin, boxMax) <= radius * radius;
+		}
+		case VolumeType::Capsule: {
+			const CapsuleVolume& capsule = (const CapsuleVolume&)*volume;
+			Vector3 a, b;
+			GetCapsuleSegment(o, capsule, a, b);
+			//How far the capsule's line is from the box only has one low point along it, so it can be searched for
+			float lower = 0.0f;
+			float upper = 1.0f;
+			for (int i = 0; i < 24; ++i) {
+				float t0 = lower + (upper - lower) / 3.0f;
+				float t1 = upper - (upper - lower) / 3.0f;
+				if (DistanceSquaredToBox(a + (b - a) * t0, boxMin, boxMax) < DistanceSquaredToBox(a + (b - a) * t1, boxMin, boxMax)) {
+					upper = t1;
+				}
+				else {
+					lower = t0;
 				}
 			}
+			float radius = capsule.GetRadius();
+			return DistanceSquaredToBox(a + (b - a) * ((lower + upper) * 0.5f), boxMin, boxMax) <= radius * radius;
 		}
+		default: return false;
 	}
-	if (collision.node) {
-		closestCollision		= collision;
-		closestCollision.node	= collision.node;
+}
+
+static bool BoxesOverlap(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB) {
+	return	minA.x <= maxB.x && minB.x <= maxA.x &&
+			minA.y <= maxB.y && minB.y <= maxA.y &&
+			minA.z <= maxB.z && minB.z <= maxA.z;
+}
+
+int GameWorld::OverlapSphere(const Vector3& centre, float radius, std::span<GameObject*> results, const GameObjectFilter& filter) const {
+	if (results.empty()) {
+		return 0;
+	}
+	UpdateRaycastBVH();
+
+	int found = 0;
+	raycastBVH.Query(
+		[&](const Vector3& min, const Vector3& max) {
+			return DistanceSquaredToBox(centre, min, max) <= radius * radius;
+		},
+		[&](GameObject* o) {
+			if ((!filter || filter(o)) && SphereOverlapsObject(centre, radius, o)) {
+				results[found++] = o;
+			}
+			return found < (int)results.size();
+		}
+	);
+	return found;
+}
+
+int GameWorld::OverlapBox(const Vector3& centre, const Vector3& halfSize, std::span<GameObject*> results, const GameObjectFilter& filter) const {
+	if (results.empty()) {
+		return 0;
+	}
+	UpdateRaycastBVH();
+
+	Vector3 queryMin = centre - halfSize;
+	Vector3 queryMax = centre + halfSize;
+	int found = 0;
+	raycastBVH.Query(
+		[&](const Vector3& min, const Vector3& max) {
+			return BoxesOverlap(queryMin, queryMax, min, max);
+		},
+		[&](GameObject* o) {
+			if ((!filter || filter(o)) && BoxOverlapsObject(centre, halfSize, o)) {
+				results[found++] = o;
+			}
+			return found < (int)results.size();
+		}
+	);
+	return found;
+}
+
+bool GameWorld::SweepSphere(const Vector3& start, float radius, const Vector3& displacement, SweepCollision& collision, const GameObjectFilter& filter) const {
+	float distance = displacement.Length();
+	if (distance <= 0.0f) {
+		return false;
+	}
+	UpdateRaycastBVH();
+
+	//The sphere's centre as a ray, against every box grown by the radius
+	Vector3 invDir		= FlatBVH<GameObject*>::GetInverseDirection(displacement / distance);
+	Vector3 grow		= Vector3(radius, radius, radius);
+	float	maxDistance = distance;
+
+	SweepCollision closest;
+	raycastBVH.Query(
+		[&](const Vector3& min, const Vector3& max) {
+			return FlatBVH<GameObject*>::RayHitsBox(start, invDir, min - grow, max + grow, maxDistance);
+		},
+		[&](GameObject* o) {
+			if (filter && !filter(o)) {
+				return true;
+			}
+			float	fraction;
+			Vector3 normal;
+			if (CollisionDetection::SweptSphereIntersection(start, radius, displacement, *o->GetBoundingVolume(), o->GetTransform(), fraction, normal)
+				&& fraction < closest.hitFraction) {
+				closest.node		= o;
+				closest.hitFraction = fraction;
+				closest.hitNormal	= normal;
+				maxDistance			= fraction * distance; //Nothing further along can be hit first
+			}
+			return true;
+		}
+	);
+	if (closest.node) {
+		collision = closest;
 		return true;
 	}
 	return false;
 }
 
+/*
+Keeps the best results so far sorted in the caller's buffer - once it's
+full, only boxes closer than the furthest of them are worth looking in.
+Objects' boxes are always around their positions, so the distance to a
+box is never more than the distance to anything inside it.
+*/
+int GameWorld::FindNearest(const Vector3& position, std::span<GameObject*> results, float maxDistance, const GameObjectFilter& filter) const {
+	if (results.empty()) {
+		return 0;
+	}
+	UpdateRaycastBVH();
+
+	auto distanceSquared = [&](GameObject* o) {
+		return (o->GetTransform().GetPosition() - position).LengthSquared();
+	};
+	int		capacity	= (int)results.size();
+	int		found		= 0;
+	float	limit		= maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+
+	raycastBVH.Query(
+		[&](const Vector3& min, const Vector3& max) {
+			return DistanceSquaredToBox(position, min, max) <= limit;
+		},
+		[&](GameObject* o) {
+			if (filter && !filter(o)) {
+				return true;
+			}
+			float d = distanceSquared(o);
+			if (d > limit) {
+				return true;
+			}
+			//Slides further away results up one - if the buffer's full, the furthest falls off the end
+			int i = std::min(found, capacity - 1);
+			while (i > 0 && distanceSquared(results[i - 1]) > d) {
+				results[i] = results[i - 1];
+				--i;
+			}
+			results[i]	= o;
+			found		= std::min(found + 1, capacity);
+			if (found == capacity) {
+				limit = distanceSquared(results[capacity - 1]);
+			}
+			return true;
+		}
+	);
+	return found;
+}
 
 /*
 Constraint Tutorial Stuff
 */
 
-void GameWorld::AddConstraint(Constraint* c) {
-	constraints.emplace_back(c);
+ConstraintHandle GameWorld::AddConstraint(Constraint* c) {
+	ConstraintHandle handle = constraints.Insert(c);
+	c->SetWorldHandle(handle);
+	return handle;
 }
 
 void GameWorld::RemoveConstraint(Constraint* c, bool andDelete) {
-	constraints.erase(std::remove(constraints.begin(), constraints.end(), c), constraints.end());
+	Constraint* const* found = constraints.Get(c->GetWorldHandle());
+	if (found && *found == c) {
+		constraints.Remove(c->GetWorldHandle());
+		c->SetWorldHandle(ConstraintHandle());
+	}
 	if (andDelete) {
 		delete c;
 	}
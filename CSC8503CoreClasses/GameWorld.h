@@ -4,16 +4,38 @@
 #include "Ray.h"
 #include "CollisionDetection.h"
 #include "QuadTree.h"
+#include "FlatBVH.h"
+#include "SlotMap.h"
+#include "ComponentStore.h"
+#include "GameObject.h"
+#include "Constraint.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <type_traits>
 namespace NCL {
 		class Camera;
 		using Maths::Ray;
 	namespace CSC8503 {
 		class GameObject;
 		class Constraint;
+		class ThreadPool;
+		class PhysicsObject;
+		class RenderObject;
+		class NetworkObject;
 
 		typedef std::function<void(GameObject*)> GameObjectFunc;
+		typedef std::function<bool(GameObject*)> GameObjectFilter;
 		typedef std::vector<GameObject*>::const_iterator GameObjectIterator;
 
+		//Where a swept shape first touched something
+		struct SweepCollision {
+			GameObject* node		= nullptr;
+			float		hitFraction = FLT_MAX;	//How far along the sweep, from 0 to 1
+			Vector3		hitNormal;				//The surface normal of what was hit
+		};
+
 		class GameWorld	{
 		public:
 			GameWorld();
@@ -22,12 +44,62 @@ namespace NCL {
 			void Clear();
 			void ClearAndErase();
 
-			void AddGameObject(GameObject* o, int worldID = -1);
+			/*
+			Objects and constraints are kept in slot maps, so adding and
+			removing them is O(1), and each is given a handle. Anything that
+			needs to keep referring to an object that might be removed (and
+			deleted) before it's done with it should hold on to its handle,
+			rather than a pointer - GetGameObject gives back nullptr for the
+			handle of anything that isn't in the world any more.
+			*/
+			GameObjectHandle AddGameObject(GameObject* o, int worldID = -1);
 			void RemoveGameObject(GameObject* o, bool andDelete = false);
+			void RemoveGameObject(GameObjectHandle h, bool andDelete = false);
+
+			GameObject* GetGameObject(GameObjectHandle h) const {
+				GameObject* const* o = gameObjects.Get(h);
+				return o ? *o : nullptr;
+			}
+
+			//Whether o is in this world - o has to still exist to be asked about
+			bool Contains(const GameObject* o) const {
+				return GetGameObject(o->GetWorldHandle()) == o;
+			}
+
+			/*
+			Alongside the objects themselves, the world keeps a ComponentSet
+			for each kind of component, so each system can walk just the
+			objects it cares about - physics walks the objects with physics
+			objects, the renderer those with render objects, and so on. An
+			object's entries are kept up to date by its component setters,
+			which call UpdateComponents while it's in the world.
+			*/
+			void UpdateComponents(GameObject* o);
+
+			const ComponentSet<PhysicsObject*>& GetPhysicsComponents() const {
+				return physicsComponents;
+			}
+
+			const ComponentSet<const CollisionVolume*>& GetCollisionComponents() const {
+				return collisionComponents;
+			}
+
+			const ComponentSet<RenderObject*>& GetRenderComponents() const {
+				return renderComponents;
+			}
 
-			void AddConstraint(Constraint* c);
+			const ComponentSet<NetworkObject*>& GetNetworkComponents() const {
+				return networkComponents;
+			}
+
+			ConstraintHandle AddConstraint(Constraint* c);
 			void RemoveConstraint(Constraint* c, bool andDelete = false);
 
+			Constraint* GetConstraint(ConstraintHandle h) const {
+				Constraint* const* c = constraints.Get(h);
+				return c ? *c : nullptr;
+			}
+
 			Camera* GetMainCamera() const {
 				return mainCamera;
 			}
@@ -42,10 +114,138 @@ namespace NCL {
 
 			bool Raycast(Ray& r, RayCollision& closestCollision, bool closestObject = false, GameObject* ignore = nullptr) const;
 
+			/*
+			Finds the closest thing each ray hits - collisions[i].node is left
+			as nullptr if rays[i] didn't hit anything. If ignore isn't empty,
+			rays[i] goes straight through ignore[i], so each ray can skip
+			whoever cast it.
+
+			Rays that start close together and point the same way are cast
+			together in packets, a SIMD register's worth at a time, and the
+			packets are split across the thread pool, if there is one. Much
+			faster than calling Raycast for each ray when there are lots of
+			them, like every AI checking if it can see the player.
+
+			Like Raycast, it can be called from any thread (it keeps its
+			scratch space per thread, and only one thread refits the BVH when
+			objects have moved), as long as nothing is moving objects around
+			at the same time.
+			*/
+			void RaycastBatch(std::span<const Ray> rays, std::span<RayCollision> collisions, std::span<GameObject* const> ignore = {}) const;
+
+			/*
+			Spatial queries, answered from the same BVH as raycasts, so they
+			only look at objects near where they're asked about, rather than
+			every object in the world. Results go into the caller's buffer,
+			and nothing is allocated - the counts returned never go past the
+			size of the buffer, and once it's full, the query stops.
+
+			Each can be given a filter, and only looks at objects it says yes
+			to - like only wanting to know about enemies. Small lambdas (a
+			pointer or two of captures) fit inside the std::function without
+			allocating anything either.
+			*/
+
+			//Every object whose volume touches the sphere
+			int OverlapSphere(const Vector3& centre, float radius, std::span<GameObject*> results, const GameObjectFilter& filter = nullptr) const;
+			//Every object whose volume touches the (axis aligned) box
+			int OverlapBox(const Vector3& centre, const Vector3& halfSize, std::span<GameObject*> results, const GameObjectFilter& filter = nullptr) const;
+
+			/*
+			Moves a sphere from start along displacement, and finds the first
+			thing it would hit. Anything the sphere is already touching at the
+			start is left out, as with the swept collision tests it's built on.
+			*/
+			bool SweepSphere(const Vector3& start, float radius, const Vector3& displacement, SweepCollision& collision, const GameObjectFilter& filter = nullptr) const;
+
+			/*
+			The results.size() objects whose positions are closest to position,
+			and no further away than maxDistance, nearest first.
+			*/
+			int FindNearest(const Vector3& position, std::span<GameObject*> results, float maxDistance = FLT_MAX, const GameObjectFilter& filter = nullptr) const;
+
+			//Lets RaycastBatch use these threads - it runs on the calling thread alone without them
+			void SetThreadPool(ThreadPool* pool) {
+				threadPool = pool;
+			}
+
+			/*
+			Raycasts walk a BVH of every object, which is refit to where the
+			objects are the first time it's used after they've moved. Physics
+			and UpdateWorld say when that is - anything else that moves objects
+			around and then raycasts straight away should call this first.
+			*/
+			void ObjectsMoved() {
+				objectsMovedCounter++;
+			}
+
 			virtual void UpdateWorld(float dt);
 
 			void OperateOnContents(GameObjectFunc f);
 
+			/*
+			Calls func on every object - or, given a component type (like
+			PhysicsObject), on just the objects that have one, walking that
+			component's packed array, as func(object, component). func can
+			also take an index first, func(index, object, component), which
+			runs from 0 to GetComponentCount<T>() - handy for filling in an
+			array. Unlike OperateOnContents, func is a template parameter, so
+			it can be inlined, rather than called through a std::function.
+			*/
+			template<class Func>
+			void ForEachObject(Func&& func) const {
+				ForEachObjectInRange(0, gameObjects.GetCount(), func);
+			}
+
+			template<class T, class Func>
+			void ForEach(Func&& func) const {
+				ForEachInRange<T>(0, GetComponentCount<T>(), func);
+			}
+
+			/*
+			The same, but split into chunks across a thread pool - the world's
+			own, unless one's given - or just run here if there isn't one. func
+			is called from several threads at once, so should only change the
+			object it's given (or its own place in an array), and nothing can
+			be added to or taken out of the world until it's done. Calling one
+			of these from inside another on the same pool just runs the inner
+			loop on that thread, and another thread calling in waits for the
+			running loop to finish - unless the pool's using a JobSystem, which
+			can run any number of loops at once, nested or not.
+			*/
+			template<class Func>
+			void ParallelForEachObject(Func&& func, int minChunkSize = 64, ThreadPool* pool = nullptr) const {
+				pool = pool ? pool : threadPool;
+				if (!pool) {
+					ForEachObject(func);
+					return;
+				}
+				pool->ParallelFor(gameObjects.GetCount(), minChunkSize,
+					[&](int /*chunk*/, int begin, int end) {
+						ForEachObjectInRange(begin, end, func);
+					}
+				);
+			}
+
+			template<class T, class Func>
+			void ParallelForEach(Func&& func, int minChunkSize = 64, ThreadPool* pool = nullptr) const {
+				pool = pool ? pool : threadPool;
+				if (!pool) {
+					ForEach<T>(func);
+					return;
+				}
+				pool->ParallelFor(GetComponentCount<T>(), minChunkSize,
+					[&](int /*chunk*/, int begin, int end) {
+						ForEachInRange<T>(begin, end, func);
+					}
+				);
+			}
+
+			template<class T>
+			int GetComponentCount() const {
+				return GetComponentSet<T>().GetCount();
+			}
+
 			void GetObjectIterators(
 				GameObjectIterator& first,
 				GameObjectIterator& last) const;
@@ -59,8 +259,58 @@ namespace NCL {
 			}
 
 		protected:
-			std::vector<GameObject*> gameObjects;
-			std::vector<Constraint*> constraints;
+			template<class T>
+			const ComponentSet<T*>& GetComponentSet() const {
+				if constexpr (std::is_same_v<T, PhysicsObject>) {
+					return physicsComponents;
+				}
+				else if constexpr (std::is_same_v<T, const CollisionVolume>) {
+					return collisionComponents;
+				}
+				else if constexpr (std::is_same_v<T, RenderObject>) {
+					return renderComponents;
+				}
+				else {
+					static_assert(std::is_same_v<T, NetworkObject>, "Not a component the world keeps track of");
+					return networkComponents;
+				}
+			}
+
+			template<class Func>
+			void ForEachObjectInRange(int begin, int end, Func& func) const {
+				GameObject* const* objects = gameObjects.GetValues().data();
+				for (int i = begin; i < end; ++i) {
+					func(objects[i]);
+				}
+			}
+
+			template<class T, class Func>
+			void ForEachInRange(int begin, int end, Func& func) const {
+				const ComponentSet<T*>& set = GetComponentSet<T>();
+				GameObject* const*	owners		= set.GetOwners().data();
+				T* const*			components	= set.GetComponents().data();
+				for (int i = begin; i < end; ++i) {
+					if constexpr (std::is_invocable_v<Func&, int, GameObject*, T*>) {
+						func(i, owners[i], components[i]);
+					}
+					else {
+						func(owners[i], components[i]);
+					}
+				}
+			}
+
+			void UpdateRaycastBVH() const;
+			static void SortRaysForPackets(std::span<const Ray> rays, std::vector<int>& order);
+			void RaycastPacket(const int* rayIndices, int rayCount, std::span<const Ray> rays,
+				std::span<RayCollision> collisions, std::span<GameObject* const> ignore) const;
+
+			SlotMap<GameObject*> gameObjects;
+			SlotMap<Constraint*> constraints;
+
+			ComponentSet<PhysicsObject*>			physicsComponents;
+			ComponentSet<const CollisionVolume*>	collisionComponents;
+			ComponentSet<RenderObject*>				renderComponents;
+			ComponentSet<NetworkObject*>			networkComponents;
 
 			Camera* mainCamera;
 
@@ -68,6 +318,15 @@ namespace NCL {
 			bool shuffleObjects;
 			int		worldIDCounter;
 			int		worldStateCounter;
+			int		objectsMovedCounter;
+
+			//Whichever query comes first after objects move refits the BVH, while any others wait for it
+			mutable FlatBVH<GameObject*>	raycastBVH;
+			mutable std::mutex				raycastBVHMutex;
+			mutable std::atomic<int>		raycastBVHStateID;
+			mutable std::atomic<int>		raycastBVHMovedID;
+
+			ThreadPool* threadPool;
 		};
 	}
 }
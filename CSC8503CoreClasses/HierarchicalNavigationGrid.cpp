@@ -0,0 +1,795 @@
+#include "HierarchicalNavigationGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+using namespace NCL;
+using namespace CSC8503;
+
+//Gaps between clusters wider than this get an entrance at each end, rather than one in the middle
+const int MAX_ENTRANCE_WIDTH = 6;
+
+//How many entrances the search measures distances from, to get a better idea of how far away the goal is
+const int LANDMARK_COUNT = 32;
+
+//How many of those each search uses - whichever say the most about how far apart its start and goal are
+const int ACTIVE_LANDMARK_COUNT = 8;
+
+const float UNREACHABLE	= std::numeric_limits<float>::infinity();
+const float UNMEASURED	= std::numeric_limits<float>::quiet_NaN();	//Which std::max skips over, when it's the second argument
+
+HierarchicalNavigationGrid::HierarchicalNavigationGrid(NavigationGrid& grid, int clusterSize) : grid(grid) {
+	this->clusterSize	= std::max(2, clusterSize);
+	gridWidth			= grid.GetWidth();
+	gridHeight			= grid.GetHeight();
+	heuristicWeight		= 1.0f;
+	landmarksExact		= false;
+	landmarkCosts.resize(LANDMARK_COUNT);
+	clustersX			= (gridWidth + this->clusterSize - 1) / this->clusterSize;
+	clustersY			= (gridHeight + this->clusterSize - 1) / this->clusterSize;
+
+	for (int cy = 0; cy < clustersY; ++cy) {
+		for (int cx = 0; cx < clustersX; ++cx) {
+			Cluster& c	= clusters.emplace_back();
+			c.x			= cx * this->clusterSize;
+			c.y			= cy * this->clusterSize;
+			c.width		= std::min(this->clusterSize, gridWidth - c.x);
+			c.height	= std::min(this->clusterSize, gridHeight - c.y);
+		}
+	}
+	borders.resize(clusters.size() * 2);
+
+	std::vector<int> clusterList(clusters.size());
+	std::vector<int> borderList(borders.size());
+	for (int i = 0; i < (int)clusterList.size(); ++i) {
+		clusterList[i] = i;
+	}
+	for (int i = 0; i < (int)borderList.size(); ++i) {
+		borderList[i] = i;
+	}
+	RebuildClusters(clusterList, borderList);
+	UpdateLandmarks();
+}
+
+HierarchicalNavigationGrid::~HierarchicalNavigationGrid() {
+}
+
+int HierarchicalNavigationGrid::GetCluster(int cell) const {
+	return ((cell / gridWidth / clusterSize) * clustersX) + ((cell % gridWidth) / clusterSize);
+}
+
+int HierarchicalNavigationGrid::GetBorder(int cluster, BorderSide side) const {
+	int cx = cluster % clustersX;
+	int cy = cluster / clustersX;
+	switch (side) {
+		case Left:		return cx > 0				? cluster - 1 : -1;
+		case Right:		return cx < clustersX - 1	? cluster : -1;
+		case Top:		return cy > 0				? (int)clusters.size() + cluster - clustersX : -1;
+		case Bottom:	return cy < clustersY - 1	? (int)clusters.size() + cluster : -1;
+	}
+	return -1;
+}
+
+int HierarchicalNavigationGrid::FindNode(int cluster, int cell) const {
+	for (int node : clusters[cluster].nodes) {
+		if (nodes[node].cell == cell) {
+			return node;
+		}
+	}
+	return -1;
+}
+
+int HierarchicalNavigationGrid::AddNode(int cluster, int cell) {
+	int node = FindNode(cluster, cell);
+	if (node != -1) {
+		return node; //Corner nodes can be on two borders at once
+	}
+	if (freeNodes.empty()) {
+		node = (int)nodes.size();
+		nodes.emplace_back();
+		for (std::vector<float>& costs : landmarkCosts) {
+			costs.emplace_back();
+		}
+	}
+	else {
+		node = freeNodes.back();
+		freeNodes.pop_back();
+	}
+	nodes[node].cell	= cell;
+	nodes[node].x		= cell % gridWidth;
+	nodes[node].y		= cell / gridWidth;
+	nodes[node].cluster	= cluster;
+	nodes[node].slot	= (int)clusters[cluster].nodes.size();
+	clusters[cluster].nodes.emplace_back(node);
+	for (std::vector<float>& costs : landmarkCosts) {
+		costs[node] = UNMEASURED;
+	}
+	return node;
+}
+
+//The two nodes have to be next to each other
+float HierarchicalNavigationGrid::GetStepCost(int from, int to) const {
+	const GridNode& fromNode = grid.GetNode(from);
+	const GridNode* toNode	 = &grid.GetNode(to);
+	for (int i = 0; i < 4; ++i) {
+		if (fromNode.connected[i] == toNode) {
+			return (float)fromNode.costs[i];
+		}
+	}
+	return -1.0f;
+}
+
+/*
+Looks along the edge for runs of nodes that can be walked across, and puts
+a transition in the middle of each, or at both ends of the wider ones.
+*/
+void HierarchicalNavigationGrid::BuildBorder(int border) {
+	std::vector<Transition>& transitions = borders[border];
+	transitions.clear();
+
+	bool vertical	= border < (int)clusters.size();
+	const Cluster& c = clusters[vertical ? border : border - (int)clusters.size()];
+
+	int length	= vertical ? c.height : c.width;
+	int step	= vertical ? gridWidth : 1;
+	int across	= vertical ? 1 : gridWidth;
+	int first	= vertical ? (c.y * gridWidth) + c.x + c.width - 1 : ((c.y + c.height - 1) * gridWidth) + c.x;
+
+	int runStart = -1;
+	for (int i = 0; i <= length; ++i) {
+		int cell = first + (i * step);
+		bool open = i < length && GetStepCost(cell, cell + across) >= 0.0f && GetStepCost(cell + across, cell) >= 0.0f;
+		if (open && runStart == -1) {
+			runStart = i;
+		}
+		if (open || runStart == -1) {
+			continue;
+		}
+		int runLength = i - runStart;
+		if (runLength > MAX_ENTRANCE_WIDTH) {
+			int a = first + (runStart * step);
+			int b = first + ((i - 1) * step);
+			transitions.emplace_back(a, a + across);
+			transitions.emplace_back(b, b + across);
+		}
+		else {
+			int a = first + ((runStart + (runLength / 2)) * step);
+			transitions.emplace_back(a, a + across);
+		}
+		runStart = -1;
+	}
+}
+
+//Which way each of a GridNode's connections go - up, down, left, right
+static const int DIR_X[4] = { 0, 0, -1, 1 };
+static const int DIR_Y[4] = { -1, 1, 0, 0 };
+
+static bool IsClosed(const GridSearchScratch& s, int node) {
+	return (s.closed[node / 64] & ((uint64_t)1 << (node % 64))) != 0;
+}
+
+static void Close(GridSearchScratch& s, int node) {
+	s.closed[node / 64] |= (uint64_t)1 << (node % 64);
+}
+
+/*
+Works out the cost from one node to every other in the cluster (or to it,
+going in reverse, so a search from the goal can say how much it costs to
+get there from everywhere else). Every step on a grid costs 0 or 1, so
+rather than a heap, the nodes are gone through a cost at a time - all of
+the nodes one more step away go on the next frontier, and anything that
+costs nothing to get to goes on the end of this one.
+*/
+void HierarchicalNavigationGrid::FloodCluster(const Cluster& c, int from, bool reverse, HierarchicalSearchScratch& scratch) const {
+	GridSearchScratch& s = scratch.localSearch;
+	s.Begin(c.width * c.height);
+
+	int start = GetLocalIndex(c, from);
+	s.g[start]			= 0;
+	s.parent[start]		= -1;
+	s.reachedIn[start]	= s.search;
+
+	scratch.frontier.clear();
+	scratch.frontier.emplace_back(start);
+
+	for (float cost = 0.0f; !scratch.frontier.empty(); cost += 1.0f) {
+		scratch.nextFrontier.clear();
+		for (size_t f = 0; f < scratch.frontier.size(); ++f) {
+			int best = scratch.frontier[f];
+			if (IsClosed(s, best)) {
+				continue; //Got here for nothing after it was put on the next frontier
+			}
+			Close(s, best);
+			s.expansions++;
+
+			int x = best % c.width;
+			int y = best / c.width;
+			const GridNode& node = grid.GetNode(GetCell(c, best));
+
+			for (int i = 0; i < 4; ++i) {
+				const GridNode* neighbourNode = node.connected[i];
+				int nx = x + DIR_X[i];
+				int ny = y + DIR_Y[i];
+				if (!neighbourNode || nx < 0 || nx >= c.width || ny < 0 || ny >= c.height) {
+					continue; //Not connected, or outside of the cluster
+				}
+				int stepCost = node.costs[i];
+				if (reverse) {
+					if (!neighbourNode->connected[i ^ 1]) {
+						continue; //Can get out of this node, but not back into it
+					}
+					stepCost = neighbourNode->costs[i ^ 1];
+				}
+				int neighbour = (ny * c.width) + nx;
+				float g = cost + (float)stepCost;
+				if (IsClosed(s, neighbour) || (s.reachedIn[neighbour] == s.search && g >= s.g[neighbour])) {
+					continue;
+				}
+				s.g[neighbour]			= g;
+				s.parent[neighbour]		= best;
+				s.reachedIn[neighbour]	= s.search;
+				(stepCost == 0 ? scratch.frontier : scratch.nextFrontier).emplace_back(neighbour);
+			}
+		}
+		std::swap(scratch.frontier, scratch.nextFrontier);
+	}
+}
+
+//A* from one node to another, without leaving the cluster
+bool HierarchicalNavigationGrid::SearchCluster(const Cluster& c, int from, int to, GridSearchScratch& scratch) const {
+	scratch.Begin(c.width * c.height);
+
+	bool useHeuristic	= grid.IsUniformCost();
+	int target			= GetLocalIndex(c, to);
+	int targetX			= target % c.width;
+	int targetY			= target / c.width;
+
+	int start = GetLocalIndex(c, from);
+	scratch.g[start]			= 0;
+	scratch.f[start]			= 0;
+	scratch.parent[start]		= -1;
+	scratch.reachedIn[start]	= scratch.search;
+	scratch.Push(start);
+
+	while (!scratch.heap.empty()) {
+		int best = scratch.Pop();
+		scratch.expansions++;
+		if (best == target) {
+			return true;
+		}
+		Close(scratch, best);
+
+		int x = best % c.width;
+		int y = best / c.width;
+		const GridNode& node = grid.GetNode(GetCell(c, best));
+
+		for (int i = 0; i < 4; ++i) {
+			int nx = x + DIR_X[i];
+			int ny = y + DIR_Y[i];
+			if (!node.connected[i] || nx < 0 || nx >= c.width || ny < 0 || ny >= c.height) {
+				continue;
+			}
+			int neighbour = (ny * c.width) + nx;
+			if (IsClosed(scratch, neighbour)) {
+				continue;
+			}
+			float g = scratch.g[best] + (float)node.costs[i];
+			bool inOpen = scratch.reachedIn[neighbour] == scratch.search;
+			if (inOpen && g >= scratch.g[neighbour]) {
+				continue;
+			}
+			scratch.parent[neighbour]	= best;
+			scratch.g[neighbour]		= g;
+			scratch.f[neighbour]		= useHeuristic ? g + (float)(std::abs(nx - targetX) + std::abs(ny - targetY)) : g;
+			if (inOpen) {
+				scratch.Decrease(neighbour);
+			}
+			else {
+				scratch.reachedIn[neighbour] = scratch.search;
+				scratch.Push(neighbour);
+			}
+		}
+	}
+	return false;
+}
+
+/*
+Every entrance in the cluster gets an edge to every other it can get to,
+unless going by way of some third entrance costs just the same - there's
+no need for the search to look at both, and in a cluster full of narrow
+corridors, that's most of them. Both halves of the way round have to
+cost something, or two edges could each be dropped in favour of the other.
+*/
+void HierarchicalNavigationGrid::BuildEdges(int cluster) {
+	const Cluster& c = clusters[cluster];
+	int count = (int)c.nodes.size();
+
+	std::vector<float> costs(count * count, -1.0f);
+	HierarchicalSearchScratch scratch;
+	const GridSearchScratch& local = scratch.localSearch;
+	for (int i = 0; i < count; ++i) {
+		FloodCluster(c, nodes[c.nodes[i]].cell, false, scratch);
+		for (int j = 0; j < count; ++j) {
+			int index = GetLocalIndex(c, nodes[c.nodes[j]].cell);
+			if (i != j && local.reachedIn[index] == local.search) {
+				costs[(i * count) + j] = local.g[index];
+			}
+		}
+	}
+	for (int i = 0; i < count; ++i) {
+		for (int j = 0; j < count; ++j) {
+			float cost = costs[(i * count) + j];
+			if (cost < 0.0f) {
+				continue;
+			}
+			bool redundant = false;
+			for (int k = 0; k < count && !redundant; ++k) {
+				float first		= costs[(i * count) + k];
+				float second	= costs[(k * count) + j];
+				redundant = first > 0.0f && second > 0.0f && first + second <= cost;
+			}
+			if (!redundant) {
+				nodes[c.nodes[i]].edges.emplace_back(AbstractEdge{ c.nodes[j], cost });
+			}
+		}
+	}
+}
+
+/*
+Every border in borderList has to be between two clusters in clusterList.
+Those clusters lose all of their entrances, and get new ones from their
+borders, rebuilt or not - so any cluster next to them that's not being
+rebuilt still has its entrances, but needs new edges across to them.
+*/
+void HierarchicalNavigationGrid::RebuildClusters(const std::vector<int>& clusterList, const std::vector<int>& borderList) {
+	const BorderSide sides[4] = { Left, Right, Top, Bottom };
+	landmarksExact = false;
+
+	for (int cluster : clusterList) {
+		for (int node : clusters[cluster].nodes) {
+			nodes[node].cluster = -1;
+			nodes[node].edges.clear();
+			freeNodes.emplace_back(node);
+		}
+		clusters[cluster].nodes.clear();
+	}
+	for (int cluster : clusterList) {
+		for (BorderSide side : sides) {
+			int border = GetBorder(cluster, side);
+			if (border == -1) {
+				continue;
+			}
+			for (const Transition& t : borders[border]) {
+				int outside = side == Left || side == Top ? t.first : t.second;
+				int node = FindNode(GetCluster(outside), outside);
+				if (node != -1) {
+					std::erase_if(nodes[node].edges, [&](const AbstractEdge& e) { return nodes[e.to].cluster == -1; });
+				}
+			}
+		}
+	}
+	for (int border : borderList) {
+		BuildBorder(border);
+	}
+	for (int cluster : clusterList) {
+		for (BorderSide side : sides) {
+			int border = GetBorder(cluster, side);
+			if (border == -1) {
+				continue;
+			}
+			for (const Transition& t : borders[border]) {
+				AddNode(cluster, side == Left || side == Top ? t.second : t.first);
+			}
+		}
+	}
+	for (int cluster : clusterList) {
+		for (BorderSide side : sides) {
+			int border = GetBorder(cluster, side);
+			if (border == -1) {
+				continue;
+			}
+			for (const Transition& t : borders[border]) {
+				int inside	= side == Left || side == Top ? t.second : t.first;
+				int outside = side == Left || side == Top ? t.first : t.second;
+
+				int outsideCluster	= GetCluster(outside);
+				int insideNode		= FindNode(cluster, inside);
+				int outsideNode		= FindNode(outsideCluster, outside);
+
+				nodes[insideNode].edges.emplace_back(AbstractEdge{ outsideNode, GetStepCost(inside, outside) });
+				if (std::find(clusterList.begin(), clusterList.end(), outsideCluster) == clusterList.end()) {
+					nodes[outsideNode].edges.emplace_back(AbstractEdge{ insideNode, GetStepCost(outside, inside) });
+				}
+			}
+		}
+	}
+	for (int cluster : clusterList) {
+		BuildEdges(cluster);
+	}
+}
+
+void HierarchicalNavigationGrid::SetNodeType(int x, int y, char type) {
+	grid.SetNodeType(x, y, type);
+	NodeChanged(x, y);
+}
+
+void HierarchicalNavigationGrid::NodeChanged(int x, int y) {
+	if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight) {
+		return;
+	}
+	int cluster = GetCluster((y * gridWidth) + x);
+	const Cluster& c = clusters[cluster];
+
+	std::vector<int> clusterList = { cluster };
+	std::vector<int> borderList;
+
+	auto addSide = [&](BorderSide side, bool onEdge, int neighbour) {
+		int border = GetBorder(cluster, side);
+		if (onEdge && border != -1) {
+			borderList.emplace_back(border);
+			clusterList.emplace_back(neighbour);
+		}
+	};
+	addSide(Left,	x == c.x,					cluster - 1);
+	addSide(Right,	x == c.x + c.width - 1,		cluster + 1);
+	addSide(Top,	y == c.y,					cluster - clustersX);
+	addSide(Bottom,	y == c.y + c.height - 1,	cluster + clustersX);
+
+	RebuildClusters(clusterList, borderList);
+}
+
+//Dijkstra over the entrances, filling in how far each one is from the landmark, with the same buckets as the search
+void HierarchicalNavigationGrid::MeasureLandmark(int landmark, int from, std::vector<std::vector<int>>& buckets) {
+	std::vector<float>& costs = landmarkCosts[landmark];
+	std::fill(costs.begin(), costs.end(), UNREACHABLE);
+	costs[from] = 0.0f;
+
+	buckets.assign(1, { from });
+	for (size_t cost = 0; cost < buckets.size(); ++cost) {
+		while (!buckets[cost].empty()) {
+			int best = buckets[cost].back();
+			buckets[cost].pop_back();
+			if (costs[best] < (float)cost) {
+				continue; //Already got here for less
+			}
+			for (const AbstractEdge& e : nodes[best].edges) {
+				float g = (float)cost + e.cost;
+				if (g >= costs[e.to]) {
+					continue;
+				}
+				costs[e.to] = g;
+				if ((size_t)g >= buckets.size()) {
+					buckets.resize((size_t)g + 1);
+				}
+				buckets[(size_t)g].emplace_back(e.to);
+			}
+		}
+	}
+}
+
+/*
+Each landmark is whichever entrance is furthest from all of the ones
+picked so far, so they end up spread around the edges of the map, where
+they're behind as much of it as possible. The first is the furthest from
+whichever entrance comes first.
+*/
+void HierarchicalNavigationGrid::UpdateLandmarks() {
+	std::vector<std::vector<int>> buckets;
+	std::vector<float> nearest(nodes.size(), -1.0f); //How far each entrance is from the nearest landmark
+
+	int from = 0;
+	while (from < (int)nodes.size() && nodes[from].cluster == -1) {
+		from++;
+	}
+	if (from == (int)nodes.size()) {
+		return;
+	}
+	for (int landmark = -1; landmark < LANDMARK_COUNT; ++landmark) {
+		MeasureLandmark(std::max(landmark, 0), from, buckets);
+
+		float furthest = 0.0f;
+		for (int i = 0; i < (int)nodes.size(); ++i) {
+			float cost = landmarkCosts[std::max(landmark, 0)][i];
+			if (nodes[i].cluster == -1 || cost == UNREACHABLE) {
+				continue;
+			}
+			if (landmark >= 0) {
+				cost = nearest[i] = nearest[i] < 0.0f ? cost : std::min(nearest[i], cost);
+			}
+			if (cost > furthest) {
+				furthest	= cost;
+				from		= i;
+			}
+		}
+	}
+	landmarksExact = true;
+}
+
+/*
+The start and goal are put into the graph just for this search - the
+start gets an edge to every entrance of its cluster it can get to, and
+each entrance of the goal's cluster that can get to the goal gets an edge
+to it. If they're in the same cluster, there's an edge straight between
+them too, if there's a way that doesn't leave the cluster.
+
+Entrances only ever join up nodes that can be walked on, so unlike the
+NavigationGrid's own searches, a start inside a wall never has a path.
+*/
+bool HierarchicalNavigationGrid::FindAbstractPath(const Vector3& from, const Vector3& to, HierarchicalPath& outPath, HierarchicalSearchScratch& scratch) const {
+	outPath.Clear();
+
+	int start;
+	int goal;
+	if (!grid.GetNodeIndex(from, start) || !grid.GetNodeIndex(to, goal)) {
+		return false;
+	}
+	if (!grid.IsWalkable(start % gridWidth, start / gridWidth)) {
+		return false;
+	}
+	int startCluster	= GetCluster(start);
+	int goalCluster		= GetCluster(goal);
+	const Cluster& sc	= clusters[startCluster];
+	const Cluster& gc	= clusters[goalCluster];
+
+	GridSearchScratch& local = scratch.localSearch;
+
+	float directCost = -1.0f;
+	FloodCluster(sc, start, false, scratch);
+	scratch.startCosts.clear();
+	for (int node : sc.nodes) {
+		int i = GetLocalIndex(sc, nodes[node].cell);
+		if (local.reachedIn[i] == local.search) {
+			scratch.startCosts.emplace_back(node, local.g[i]);
+		}
+	}
+	if (startCluster == goalCluster && local.reachedIn[GetLocalIndex(sc, goal)] == local.search) {
+		directCost = local.g[GetLocalIndex(sc, goal)];
+	}
+
+	FloodCluster(gc, goal, true, scratch);
+	scratch.goalCosts.assign(gc.nodes.size(), -1.0f);
+	for (int node : gc.nodes) {
+		int i = GetLocalIndex(gc, nodes[node].cell);
+		if (local.reachedIn[i] == local.search) {
+			scratch.goalCosts[nodes[node].slot] = local.g[i];
+		}
+	}
+
+	int startNode	= (int)nodes.size();
+	int goalNode	= startNode + 1;
+	bool useHeuristic = grid.IsUniformCost();
+	int goalX = goal % gridWidth;
+	int goalY = goal / gridWidth;
+
+	/*
+	The goal can only be got to through its cluster's entrances, so how far
+	it is from a landmark is just the least of how far each of those is,
+	plus the rest of the way, and the same goes for the start. If any of
+	them hasn't been measured since its cluster was rebuilt, that landmark
+	can't be used. Of the rest, the search only looks at the few that put
+	the start and goal furthest apart.
+	*/
+	auto addWay = [](float& least, float cost) {
+		least = std::isnan(least) || std::isnan(cost) ? UNMEASURED : std::min(least, cost);
+	};
+	float			goalLandmarkCosts[LANDMARK_COUNT];
+	float			landmarkSpans[LANDMARK_COUNT];
+	const float*	landmarkNodeCosts[LANDMARK_COUNT];
+	int				landmarkCount = 0;
+	for (const std::vector<float>& costs : landmarkCosts) {
+		if (!useHeuristic) {
+			break;
+		}
+		float toGoal	= UNREACHABLE;
+		float toStart	= UNREACHABLE;
+		for (int node : gc.nodes) {
+			float cost = scratch.goalCosts[nodes[node].slot];
+			if (cost >= 0.0f) {
+				addWay(toGoal, costs[node] + cost);
+			}
+		}
+		for (const auto& [node, cost] : scratch.startCosts) {
+			addWay(toStart, costs[node] + cost);
+		}
+		if (std::isnan(toGoal) || (toGoal == UNREACHABLE && !landmarksExact)) {
+			continue; //Can't tell, or might have been joined up since
+		}
+		goalLandmarkCosts[landmarkCount]	= toGoal;
+		landmarkSpans[landmarkCount]		= std::isnan(toStart) ? 0.0f : std::abs(toGoal - toStart);
+		landmarkNodeCosts[landmarkCount]	= costs.data();
+		landmarkCount++;
+	}
+	for (int i = 0; i < std::min(landmarkCount, ACTIVE_LANDMARK_COUNT); ++i) {
+		int best = (int)(std::max_element(landmarkSpans + i, landmarkSpans + landmarkCount) - landmarkSpans);
+		std::swap(goalLandmarkCosts[i], goalLandmarkCosts[best]);
+		std::swap(landmarkSpans[i], landmarkSpans[best]);
+		std::swap(landmarkNodeCosts[i], landmarkNodeCosts[best]);
+	}
+	landmarkCount = std::min(landmarkCount, ACTIVE_LANDMARK_COUNT);
+
+	GridSearchScratch& s = scratch.abstractSearch;
+	s.Begin(startNode + 2);
+
+	/*
+	Every step costs a whole number, and so do both estimates (unless the
+	heuristic weight isn't, when near enough will do), so rather than a
+	heap, the open list is a bucket for each f, gone through in order.
+	Newest first in each, which goes for whichever's furthest along.
+	A node that's found a better way is just put in again, and whichever
+	comes out second is skipped, as it's been closed by then.
+	*/
+	std::vector<std::vector<int>>& buckets = scratch.buckets;
+	for (std::vector<int>& bucket : buckets) {
+		bucket.clear();
+	}
+	int bucket = 0;
+	auto push = [&](int node) {
+		size_t b = (size_t)std::max((int)s.f[node], bucket);
+		if (b >= buckets.size()) {
+			buckets.resize(b + 1);
+		}
+		buckets[b].emplace_back(node);
+	};
+
+	s.g[startNode]			= 0;
+	s.f[startNode]			= 0;
+	s.parent[startNode]		= -1;
+	s.reachedIn[startNode]	= s.search;
+	push(startNode);
+
+	auto getCell = [&](int node) {
+		return node == startNode ? start : (node == goalNode ? goal : nodes[node].cell);
+	};
+	auto getHeuristic = [&](int node) {
+		if (!useHeuristic || node == goalNode) {
+			return 0.0f;
+		}
+		int x = node == startNode ? start % gridWidth : nodes[node].x;
+		int y = node == startNode ? start / gridWidth : nodes[node].y;
+		float distance = (float)(std::abs(x - goalX) + std::abs(y - goalY));
+		float estimate = distance;
+		if (node != startNode) {
+			for (int i = 0; i < landmarkCount; ++i) {
+				estimate = std::max(estimate, std::abs(goalLandmarkCosts[i] - landmarkNodeCosts[i][node]));
+			}
+			if (estimate == UNREACHABLE && !landmarksExact) {
+				estimate = distance; //Might have been joined up to the goal since it was measured
+			}
+		}
+		return estimate == UNREACHABLE ? UNREACHABLE : heuristicWeight * estimate;
+	};
+
+	while (true) {
+		while (bucket < (int)buckets.size() && buckets[bucket].empty()) {
+			bucket++;
+		}
+		if (bucket == (int)buckets.size()) {
+			break;
+		}
+		int best = buckets[bucket].back();
+		buckets[bucket].pop_back();
+		if (IsClosed(s, best)) {
+			continue;
+		}
+		s.expansions++;
+
+		if (best == goalNode) {
+			for (int node = goalNode; node != -1; node = s.parent[node]) {
+				int cell = getCell(node);
+				if (outPath.nodes.empty() || outPath.nodes.back() != cell) {
+					outPath.nodes.emplace_back(cell);
+				}
+			}
+			std::reverse(outPath.nodes.begin(), outPath.nodes.end());
+			return true;
+		}
+		Close(s, best);
+
+		auto relax = [&](int next, float cost) {
+			if (IsClosed(s, next)) {
+				return;
+			}
+			float g = s.g[best] + cost;
+			bool inOpen = s.reachedIn[next] == s.search;
+			if (inOpen && g >= s.g[next]) {
+				return;
+			}
+			float h = inOpen ? s.f[next] - s.g[next] : getHeuristic(next);
+			if (h == UNREACHABLE) {
+				return; //On the other side of a landmark the goal can't be got to from
+			}
+			s.parent[next]		= best;
+			s.g[next]			= g;
+			s.f[next]			= g + h;
+			s.reachedIn[next]	= s.search;
+			push(next);
+		};
+
+		if (best == startNode) {
+			for (const auto& [node, cost] : scratch.startCosts) {
+				relax(node, cost);
+			}
+			if (directCost >= 0.0f) {
+				relax(goalNode, directCost);
+			}
+			continue;
+		}
+		const AbstractNode& node = nodes[best];
+		for (const AbstractEdge& e : node.edges) {
+			relax(e.to, e.cost);
+		}
+		if (node.cluster == goalCluster && scratch.goalCosts[node.slot] >= 0.0f) {
+			relax(goalNode, scratch.goalCosts[node.slot]);
+		}
+	}
+	return false;
+}
+
+//Fills scratch.segment with every node from one to the other, both included
+bool HierarchicalNavigationGrid::RefineSegment(int from, int to, HierarchicalSearchScratch& scratch) const {
+	scratch.segment.clear();
+	if (from == to) {
+		scratch.segment.emplace_back(from);
+		return true;
+	}
+	int cluster = GetCluster(from);
+	if (cluster != GetCluster(to)) {
+		if (GetStepCost(from, to) < 0.0f) {
+			return false; //Must have been a step across a border that's since been blocked
+		}
+		scratch.segment.emplace_back(from);
+		scratch.segment.emplace_back(to);
+		return true;
+	}
+	const Cluster& c = clusters[cluster];
+	GridSearchScratch& local = scratch.localSearch;
+	if (!SearchCluster(c, from, to, local)) {
+		return false;
+	}
+	for (int i = GetLocalIndex(c, to); i != -1; i = local.parent[i]) {
+		scratch.segment.emplace_back(GetCell(c, i));
+	}
+	std::reverse(scratch.segment.begin(), scratch.segment.end());
+	return true;
+}
+
+bool HierarchicalNavigationGrid::RefineNextSegment(HierarchicalPath& path, NavigationPath& outPath, HierarchicalSearchScratch& scratch) const {
+	if (path.IsFinished()) {
+		return false;
+	}
+	int from	= path.nodes[path.nextSegment];
+	int to		= path.nodes[std::min(path.nextSegment + 1, (int)path.nodes.size() - 1)];
+	if (!RefineSegment(from, to, scratch)) {
+		return false;
+	}
+	path.nextSegment++;
+	for (auto i = scratch.segment.rbegin(); i != scratch.segment.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNode(*i).position);
+	}
+	return true;
+}
+
+bool HierarchicalNavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+	static thread_local HierarchicalSearchScratch	scratch;
+	static thread_local HierarchicalPath			path;
+	static thread_local std::vector<int>			cells;
+
+	if (!FindAbstractPath(from, to, path, scratch)) {
+		return false;
+	}
+	cells.clear();
+	for (int i = 0; i < path.GetSegmentCount(); ++i) {
+		int segmentTo = path.nodes[std::min(i + 1, (int)path.nodes.size() - 1)];
+		if (!RefineSegment(path.nodes[i], segmentTo, scratch)) {
+			return false;
+		}
+		//Each segment starts where the last one finished
+		cells.insert(cells.end(), scratch.segment.begin() + (cells.empty() ? 0 : 1), scratch.segment.end());
+	}
+	for (auto i = cells.rbegin(); i != cells.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNode(*i).position);
+	}
+	return true;
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include "NavigationGrid.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A path through a HierarchicalNavigationGrid, as just the nodes where
+		it goes from one cluster into another (plus the start and goal),
+		rather than every node along the way. Each pair of neighbouring
+		nodes in the list is a segment, which RefineNextSegment turns into
+		proper waypoints when they're needed.
+		*/
+		struct HierarchicalPath {
+			std::vector<int>	nodes;			//Grid node indices, start first
+			int					nextSegment = 0;
+
+			void Clear() {
+				nodes.clear();
+				nextSegment = 0;
+			}
+
+			int GetSegmentCount() const {
+				return nodes.size() > 1 ? (int)nodes.size() - 1 : (int)nodes.size();
+			}
+
+			bool IsFinished() const {
+				return nextSegment >= GetSegmentCount();
+			}
+		};
+
+		struct HierarchicalSearchScratch {
+			GridSearchScratch	abstractSearch;	//Over the entrances, and the start and goal
+			GridSearchScratch	localSearch;	//Over the nodes of one cluster
+			std::vector<std::pair<int, float>>	startCosts;	//To each entrance the start can get to
+			std::vector<float>					goalCosts;	//From each of the goal cluster's entrances, -1 for none
+			std::vector<std::vector<int>>		buckets;	//The abstract search's open list, by f
+			std::vector<int>					segment;
+			std::vector<int>					frontier;
+			std::vector<int>					nextFrontier;
+		};
+
+		/*
+		Hierarchical pathfinding (HPA*) over a NavigationGrid. The grid is
+		split into square clusters, and wherever a cluster can be walked out
+		of into the one next to it, there's an entrance on either side of
+		the gap - one in the middle of a short gap, or one at each end of a
+		long one. How much it costs to get from each entrance to every other
+		in the same cluster is worked out up front, so a search only ever
+		has to go between entrances, which is far fewer nodes than the grid
+		has, rather than through every node on the way.
+
+		A search only has to look inside two clusters - the start's, to see
+		which entrances it can get to, and the goal's, to see which can get
+		to it. What comes out is just the entrances the path goes through,
+		and each stretch between two of them is only worked out node by node
+		(with a search that can't leave the cluster) when it's asked for, so
+		an agent that only needs to know where to go next doesn't pay for the
+		rest of the path, which might well change before it gets there.
+
+		On a big grid, the search can still have a lot of entrances to look
+		through, and how far away the goal looks in a straight line says
+		very little in a maze. So how far every entrance is from each of a
+		few landmarks (entrances spread out around the edges of the map) is
+		worked out up front too - the goal can't be any closer to an
+		entrance than the difference between how far each is from the same
+		landmark, which is usually much nearer the real distance.
+
+		Paths aren't always the shortest possible, as they have to go
+		through the entrances, but they're never far off - unless the
+		heuristic weight has been turned up, which gets longer paths much
+		quicker on big grids.
+
+		Changing a node only rebuilds the cluster it's in, and if it's on the
+		edge of the cluster, the one on the other side too. The landmark
+		distances are left as they are until UpdateLandmarks is called.
+		*/
+		class HierarchicalNavigationGrid : public NavigationMap {
+		public:
+			HierarchicalNavigationGrid(NavigationGrid& grid, int clusterSize = 32);
+			~HierarchicalNavigationGrid();
+
+			//The whole path, all refined at once. Uses scratch belonging to the calling thread
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+
+			bool FindAbstractPath(const Vector3& from, const Vector3& to, HierarchicalPath& outPath, HierarchicalSearchScratch& scratch) const;
+
+			/*
+			Adds the waypoints of the path's next segment (both ends included)
+			to an empty outPath, and moves the path on to the segment after.
+			Returns false if there aren't any segments left, or if the segment
+			can't be walked any more since the grid was changed, in which case
+			a new path is needed.
+			*/
+			bool RefineNextSegment(HierarchicalPath& path, NavigationPath& outPath, HierarchicalSearchScratch& scratch) const;
+
+			//Changes the node on the grid, and rebuilds whatever clusters it was part of
+			void SetNodeType(int x, int y, char type);
+
+			//For when a node's been changed on the grid directly
+			void NodeChanged(int x, int y);
+
+			/*
+			Picks the landmarks again, and measures how far every entrance
+			is from them - up to a second or so on a 2048 by 2048 grid.
+			Entrances in rebuilt clusters aren't measured until this is
+			called, which only makes searches slower around them, but if
+			changes have opened up shorter ways round, paths can come out a
+			little longer than they should until it is.
+			*/
+			void UpdateLandmarks();
+
+			/*
+			How much the search trusts its estimate of how far away the goal
+			is - above 1, it heads straight for the goal rather than looking
+			around for anything shorter, which makes it much quicker on big
+			grids, for paths that can be a little longer.
+			*/
+			void SetHeuristicWeight(float weight) {
+				heuristicWeight = weight;
+			}
+
+			int GetClusterSize() const {
+				return clusterSize;
+			}
+
+			int GetEntranceCount() const {
+				return (int)nodes.size() - (int)freeNodes.size();
+			}
+
+		protected:
+			struct AbstractEdge {
+				int		to;
+				float	cost;
+			};
+
+			struct AbstractNode {
+				int		cell	= -1;	//Which grid node it is
+				int		x		= 0;
+				int		y		= 0;
+				int		cluster	= -1;	//-1 if it's not being used
+				int		slot	= -1;	//Where it is in its cluster's list
+				std::vector<AbstractEdge> edges;
+			};
+
+			struct Cluster {
+				int x;
+				int y;
+				int width;
+				int height;
+				std::vector<int> nodes;
+			};
+
+			//A step across the edge between two clusters, from first to second
+			typedef std::pair<int, int> Transition;
+
+			enum BorderSide {
+				Left,
+				Right,
+				Top,
+				Bottom
+			};
+
+			void	RebuildClusters(const std::vector<int>& clusterList, const std::vector<int>& borderList);
+			void	BuildBorder(int border);
+			void	BuildEdges(int cluster);
+
+			int		GetBorder(int cluster, BorderSide side) const;
+			int		GetCluster(int cell) const;
+			int		FindNode(int cluster, int cell) const;
+			int		AddNode(int cluster, int cell);
+			float	GetStepCost(int from, int to) const;
+			void	MeasureLandmark(int landmark, int from, std::vector<std::vector<int>>& buckets);
+
+			void	FloodCluster(const Cluster& c, int from, bool reverse, HierarchicalSearchScratch& scratch) const;
+			bool	SearchCluster(const Cluster& c, int from, int to, GridSearchScratch& scratch) const;
+			bool	RefineSegment(int from, int to, HierarchicalSearchScratch& scratch) const;
+
+			int GetLocalIndex(const Cluster& c, int cell) const {
+				return (((cell / gridWidth) - c.y) * c.width) + ((cell % gridWidth) - c.x);
+			}
+
+			int GetCell(const Cluster& c, int localIndex) const {
+				return ((c.y + (localIndex / c.width)) * gridWidth) + c.x + (localIndex % c.width);
+			}
+
+			NavigationGrid&	grid;
+			int				gridWidth;
+			int				gridHeight;
+			int				clusterSize;
+			int				clustersX;
+			int				clustersY;
+			float			heuristicWeight;
+
+			std::vector<Cluster>		clusters;
+			std::vector<AbstractNode>	nodes;
+			std::vector<int>			freeNodes;
+			std::vector<std::vector<float>>	landmarkCosts;	//How far each node is from each landmark - NaN if not measured
+			bool						landmarksExact;	//Nothing's been rebuilt since they were measured
+
+			/*
+			Every edge between two clusters - the vertical edges between each
+			cluster and the one to its right first, then the horizontal edges
+			between each and the one below it.
+			*/
+			std::vector<std::vector<Transition>> borders;
+		};
+	}
+}
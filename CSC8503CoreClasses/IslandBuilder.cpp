@@ -0,0 +1,101 @@
+#include "IslandBuilder.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+IslandBuilder::IslandBuilder() {
+}
+
+IslandBuilder::~IslandBuilder() {
+}
+
+void IslandBuilder::Reset(int bodyCount) {
+	parents.resize(bodyCount);
+	for (int i = 0; i < bodyCount; ++i) {
+		parents[i] = i;
+	}
+	islands.clear();
+	manifoldEntries.clear();
+}
+
+/*
+Each step up the tree also points the body at its grandparent, so the
+paths stay short without needing a second pass.
+*/
+int IslandBuilder::Find(int body) {
+	while (parents[body] != body) {
+		parents[body] = parents[parents[body]];
+		body = parents[body];
+	}
+	return body;
+}
+
+//The lower index always becomes the root, so the result doesn't depend on the join order
+void IslandBuilder::Join(int bodyA, int bodyB) {
+	int rootA = Find(bodyA);
+	int rootB = Find(bodyB);
+	if (rootA < rootB) {
+		parents[rootB] = rootA;
+	}
+	else if (rootB < rootA) {
+		parents[rootA] = rootB;
+	}
+}
+
+/*
+Islands are numbered in order of their root body, which is always the
+lowest numbered body in them - so the numbering only depends on which
+bodies are joined, not the order it happened in.
+*/
+void IslandBuilder::Build(int bodyCount) {
+	islands.clear();
+	bodyIslands.resize(bodyCount);
+
+	for (int i = 0; i < bodyCount; ++i) {
+		int root = Find(i);
+		if (root == i) {
+			bodyIslands[i] = (int)islands.size();
+			islands.push_back({ 0, 0, 0, 0 });
+		}
+		else {
+			bodyIslands[i] = bodyIslands[root];
+		}
+		islands[bodyIslands[i]].bodyCount++;
+	}
+
+	int first = 0;
+	for (Island& island : islands) {
+		island.firstBody	= first;
+		first				+= island.bodyCount;
+		island.bodyCount	= 0;
+	}
+	islandBodies.resize(bodyCount);
+	for (int i = 0; i < bodyCount; ++i) {
+		Island& island = islands[bodyIslands[i]];
+		islandBodies[island.firstBody + island.bodyCount++] = i;
+	}
+}
+
+void IslandBuilder::AddManifold(int body, int manifold) {
+	manifoldEntries.emplace_back(bodyIslands[body], manifold);
+}
+
+//A counting sort - count how many each island has, then drop each entry into place
+void IslandBuilder::Finish() {
+	for (auto& [island, manifold] : manifoldEntries) {
+		islands[island].manifoldCount++;
+	}
+
+	int firstManifold = 0;
+	for (Island& island : islands) {
+		island.firstManifold	= firstManifold;
+		firstManifold			+= island.manifoldCount;
+		island.manifoldCount	= 0;
+	}
+
+	islandManifolds.resize(manifoldEntries.size());
+	for (auto& [i, manifold] : manifoldEntries) {
+		Island& island = islands[i];
+		islandManifolds[island.firstManifold + island.manifoldCount++] = manifold;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Splits bodies up into islands - groups of bodies that are touching, or
+		joined by a constraint, either directly or through other bodies in the
+		group. Nothing in one island can affect anything in another during a
+		step, so islands can be solved on different threads, and an island can
+		only go to sleep (or wake up) as a whole.
+
+		Bodies are joined up in pairs with a union-find - each body points at
+		another in its group, and following them leads to the same root body
+		for every body in the group. Build then gives each group an island,
+		and the contacts are handed to whichever island their bodies ended up
+		in. Each island's bodies and contacts are stored contiguously, in the
+		order they were given.
+		*/
+		class IslandBuilder {
+		public:
+			struct Island {
+				int firstBody;
+				int bodyCount;
+				int firstManifold;
+				int manifoldCount;
+			};
+
+			IslandBuilder();
+			~IslandBuilder();
+
+			//Starts again, with every body in its own group
+			void Reset(int bodyCount);
+
+			void Join(int bodyA, int bodyB);
+			//The root body of body's group
+			int  Find(int body);
+
+			//Turns the groups of bodies [0, bodyCount) into islands
+			void Build(int bodyCount);
+
+			//Must only be given bodies that Build was told about
+			void AddManifold(int body, int manifold);
+
+			//Sorts the manifolds into their islands
+			void Finish();
+
+			int GetIslandCount() const {
+				return (int)islands.size();
+			}
+
+			const Island& GetIsland(int i) const {
+				return islands[i];
+			}
+
+			int GetIslandOf(int body) const {
+				return bodyIslands[body];
+			}
+
+			const int* GetBodies() const {
+				return islandBodies.data();
+			}
+
+			const int* GetManifolds() const {
+				return islandManifolds.data();
+			}
+
+		protected:
+			std::vector<int> parents;
+
+			std::vector<Island> islands;
+			std::vector<int>	bodyIslands;
+			std::vector<int>	islandBodies;
+
+			//Filled in by AddManifold, then sorted by Finish
+			std::vector<std::pair<int, int>>	manifoldEntries;
+			std::vector<int>					islandManifolds;
+		};
+	}
+}
@@ -0,0 +1,197 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <memory>
+
+using namespace NCL;
+using namespace CSC8503;
+
+//Which queue the calling thread owns, if it's one of a JobSystem's workers
+static thread_local const JobSystem*	workerSystem	= nullptr;
+static thread_local int					workerQueue		= 0;
+
+/*
+The calling thread's ParallelFor jobs - a set for each loop it's inside
+of at once, as a chunk it runs while waiting can start a loop of its own.
+Each set is only ever made bigger, and never moves once it's made.
+*/
+struct ChunkJobs {
+	std::unique_ptr<Job[]>	jobs;
+	int						size = 0;
+};
+static thread_local std::vector<ChunkJobs>	chunkJobs;
+static thread_local int						chunkJobDepth	= 0;
+
+JobSystem::JobSystem(int threadCount) : queues(std::max(1, threadCount > 0 ? threadCount : (int)std::thread::hardware_concurrency())) {
+	mainThreadID	= std::this_thread::get_id();
+	queuedJobs		= 0;
+	shuttingDown	= false;
+
+	for (int i = 1; i < (int)queues.size(); ++i) {
+		workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		shuttingDown = true;
+	}
+	wakeUp.notify_all();
+	for (std::thread& t : workers) {
+		t.join();
+	}
+}
+
+int JobSystem::GetQueueIndex() const {
+	return workerSystem == this ? workerQueue : 0;
+}
+
+void JobSystem::Submit(Job& job) {
+	WorkQueue& queue = job.mainThreadOnly ? mainThreadJobs : queues[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.lock);
+		queue.jobs.push_back(&job);
+	}
+	if (job.mainThreadOnly) {
+		return;
+	}
+	queuedJobs++;
+	{
+		//Taking the lock means a worker can't miss this between checking for jobs and going to sleep
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeUp.notify_one();
+}
+
+Job* JobSystem::PopJob(int queueIndex) {
+	if (queueIndex == 0 && IsMainThread()) {
+		std::lock_guard<std::mutex> lock(mainThreadJobs.lock);
+		if (!mainThreadJobs.jobs.empty()) {
+			Job* job = mainThreadJobs.jobs.back();
+			mainThreadJobs.jobs.pop_back();
+			return job;
+		}
+	}
+	WorkQueue& queue = queues[queueIndex];
+	std::lock_guard<std::mutex> lock(queue.lock);
+	if (queue.jobs.empty()) {
+		return nullptr;
+	}
+	Job* job = queue.jobs.back();
+	queue.jobs.pop_back();
+	return job;
+}
+
+//Tries every other queue in turn, starting with the next one along, so thieves don't all pick on the same one
+Job* JobSystem::StealJob(int thiefIndex) {
+	int queueCount = (int)queues.size();
+	for (int i = 1; i < queueCount; ++i) {
+		WorkQueue& queue = queues[(thiefIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.lock);
+		if (!queue.jobs.empty()) {
+			Job* job = queue.jobs.front();
+			queue.jobs.pop_front();
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+bool JobSystem::RunOneJob(int queueIndex) {
+	Job* job = PopJob(queueIndex);
+	if (!job) {
+		job = StealJob(queueIndex);
+	}
+	if (!job) {
+		return false;
+	}
+	if (!job->mainThreadOnly) {
+		queuedJobs--;
+	}
+	RunJob(job);
+	return true;
+}
+
+/*
+Everything about the job is read before its counter is touched - whoever
+is waiting on the counter is free to get rid of the job as soon as it hits 0.
+*/
+void JobSystem::RunJob(Job* job) {
+	if (job->chunkFunc) {
+		(*job->chunkFunc)(job->chunk, job->begin, job->end);
+	}
+	else {
+		job->func();
+	}
+
+	JobCounter* counter = job->counter;
+	for (Job* dependent : job->dependents) {
+		if (--dependent->pendingDependencies == 0) {
+			Submit(*dependent);
+		}
+	}
+	if (counter) {
+		counter->count--;
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	int queueIndex = GetQueueIndex();
+	while (counter.count > 0) {
+		if (!RunOneJob(queueIndex)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerLoop(int queueIndex) {
+	workerSystem	= this;
+	workerQueue		= queueIndex;
+	while (true) {
+		if (RunOneJob(queueIndex)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [&]() { return shuttingDown || queuedJobs > 0; });
+		if (shuttingDown) {
+			return;
+		}
+	}
+}
+
+int JobSystem::ParallelFor(int count, int minChunkSize, const ChunkFunc& func) {
+	if (count <= 0) {
+		return 0;
+	}
+	int chunks = std::min(GetThreadCount(), std::max(1, count / std::max(1, minChunkSize)));
+	if (chunks == 1) {
+		func(0, 0, count);
+		return 1;
+	}
+	if ((int)chunkJobs.size() <= chunkJobDepth) {
+		chunkJobs.resize(chunkJobDepth + 1);
+	}
+	ChunkJobs& set = chunkJobs[chunkJobDepth];
+	if (set.size < chunks) {
+		set.jobs.reset(new Job[chunks]);
+		set.size = chunks;
+	}
+	Job* jobs = set.jobs.get();
+	chunkJobDepth++;
+
+	JobCounter counter;
+	counter.count = chunks;
+	for (int chunk = 0; chunk < chunks; ++chunk) {
+		Job& job		= jobs[chunk];
+		job.chunkFunc	= &func;
+		job.chunk		= chunk;
+		job.begin		= (int)(((long long)count * chunk) / chunks);
+		job.end			= (int)(((long long)count * (chunk + 1)) / chunks);
+		job.counter		= &counter;
+		Submit(job);
+	}
+	Wait(counter);
+
+	chunkJobDepth--;
+	return chunks;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Counts how many jobs are still to finish - each job given a counter
+		takes one off it when it's done, and JobSystem::Wait waits for it to
+		get to zero.
+		*/
+		struct JobCounter {
+			std::atomic<int> count = 0;
+		};
+
+		/*
+		One piece of work for the JobSystem. Jobs don't belong to the job
+		system - whoever makes one keeps hold of it until it's done, so a
+		set of jobs (like a TaskGraph) can be made once and run again every
+		frame, without allocating anything.
+
+		A job with dependencies isn't run until they've all finished - each
+		finished job takes one off the pendingDependencies of every job in
+		its dependents list, and submits any that get to zero. Some things
+		(like anything that talks to OpenGL) can only be done on the main
+		thread, so those jobs are only ever picked up by it.
+
+		A job can be one chunk of a ParallelFor instead, which just points
+		at the loop's function and says which chunk - a std::function
+		holding all of that would be too big to keep without allocating.
+		*/
+		struct Job {
+			typedef std::function<void(int chunk, int begin, int end)> ChunkFunc;
+
+			std::function<void()>	func;
+			const ChunkFunc*		chunkFunc	= nullptr;	//Called instead of func, if it's set
+			int						chunk		= 0;
+			int						begin		= 0;
+			int						end			= 0;
+			std::vector<Job*>		dependents;
+			std::atomic<int>		pendingDependencies = 0;
+			JobCounter*				counter				= nullptr;
+			bool					mainThreadOnly		= false;
+		};
+
+		/*
+		A set of worker threads, each with its own queue of jobs. Jobs a
+		thread submits go on the back of its own queue, and it takes the
+		newest job off the back again when it's ready for more - the job it
+		just made is the one most likely to still be in its cache. When a
+		thread's own queue runs dry, it steals the oldest job from the front
+		of someone else's instead, so work spreads out across every thread
+		without them all fighting over one shared queue.
+
+		The thread that makes the JobSystem counts as its main thread, and
+		joins in whenever it's waiting on a counter - it's also the only one
+		that runs mainThreadOnly jobs. Threads that aren't part of the
+		system put what they submit on the main thread's queue.
+		*/
+		class JobSystem {
+		public:
+			typedef Job::ChunkFunc ChunkFunc;
+
+			//0 threads means one per hardware thread, including the main thread
+			JobSystem(int threadCount = 0);
+			~JobSystem();
+
+			int GetThreadCount() const {
+				return (int)queues.size();
+			}
+
+			//The job's pendingDependencies must already be 0
+			void Submit(Job& job);
+
+			//Runs jobs on the calling thread until the counter gets to 0
+			void Wait(JobCounter& counter);
+
+			/*
+			Like ThreadPool::ParallelFor - splits [0, count) into at most
+			GetThreadCount() chunks of at least minChunkSize items, runs them
+			as jobs, and waits for them all. The chunks are always the same
+			for the same count, so per-chunk results can be put back together
+			in chunk order. Returns the number of chunks used. The jobs are
+			kept by the calling thread and used again, so nothing is
+			allocated once a thread has run a loop this wide before.
+			*/
+			int ParallelFor(int count, int minChunkSize, const ChunkFunc& func);
+
+			bool IsMainThread() const {
+				return std::this_thread::get_id() == mainThreadID;
+			}
+
+		protected:
+			struct WorkQueue {
+				std::mutex			lock;
+				std::deque<Job*>	jobs;
+			};
+
+			void WorkerLoop(int queueIndex);
+
+			Job*	PopJob(int queueIndex);
+			Job*	StealJob(int thiefIndex);
+			bool	RunOneJob(int queueIndex);
+			void	RunJob(Job* job);
+			int		GetQueueIndex() const;
+
+			std::vector<WorkQueue>		queues;	//One per thread, the main thread's first
+			WorkQueue					mainThreadJobs;
+			std::vector<std::thread>	workers;
+			std::thread::id				mainThreadID;
+
+			std::atomic<int>		queuedJobs;	//Jobs the workers could be running, so they know when to wake up
+			std::mutex				sleepMutex;
+			std::condition_variable	wakeUp;
+			bool					shuttingDown;
+		};
+	}
+}
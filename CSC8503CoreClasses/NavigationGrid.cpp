@@ -1,6 +1,8 @@
 #include "NavigationGrid.h"
 #include "Assets.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 
 using namespace NCL;
@@ -19,14 +21,11 @@ NavigationGrid::NavigationGrid()	{
 	gridWidth	= 0;
 	gridHeight	= 0;
 	allNodes	= nullptr;
+	unevenNodes	= 0;
+	pathMode	= GridPathMode::AStar;
 }
 
 NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
-
-	
-
-
-
 	std::ifstream infile(Assets::DATADIR + filename);
 
 	infile >> nodeSize;
@@ -45,35 +44,68 @@ NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
 
 		}
 	}
-	
-	//now to build the connectivity between the nodes
+	BuildConnections();
+	PrecomputeJumpDistances();
+}
+
+NavigationGrid::NavigationGrid(int nodeSize, int gridWidth, int gridHeight, const std::vector<char>& nodeTypes) : NavigationGrid() {
+	this->nodeSize		= nodeSize;
+	this->gridWidth		= gridWidth;
+	this->gridHeight	= gridHeight;
+
+	allNodes = new GridNode[gridWidth * gridHeight];
+
 	for (int y = 0; y < gridHeight; ++y) {
 		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];		
+			GridNode&n = allNodes[(gridWidth * y) + x];
+			n.type = nodeTypes[(gridWidth * y) + x];
+			n.position = Vector3((float)(x * nodeSize), 0, (float)(y * nodeSize));
+		}
+	}
+	BuildConnections();
+	PrecomputeJumpDistances();
+}
 
-			if (y > 0) { //get the above node
-				n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
-			}
-			if (y < gridHeight - 1) { //get the below node
-				n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
-			}
-			if (x > 0) { //get left node
-				n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
+void NavigationGrid::BuildConnections() {
+	unevenNodes = 0;
+	for (int y = 0; y < gridHeight; ++y) {
+		for (int x = 0; x < gridWidth; ++x) {
+			ConnectNode(x, y);
+			if (IsWalkable(x, y) && allNodes[(gridWidth * y) + x].type != FLOOR_NODE) {
+				unevenNodes++; //Anything else walkable costs nothing to step onto
 			}
-			if (x < gridWidth - 1) { //get right node
-				n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
+		}	
+	}
+}
+
+void NavigationGrid::ConnectNode(int x, int y) {
+	GridNode&n = allNodes[(gridWidth * y) + x];		
+
+	for (int i = 0; i < 4; ++i) {
+		n.connected[i]	= nullptr;
+		n.costs[i]		= 0;
+	}
+	if (y > 0) { //get the above node
+		n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
+	}
+	if (y < gridHeight - 1) { //get the below node
+		n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
+	}
+	if (x > 0) { //get left node
+		n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
+	}
+	if (x < gridWidth - 1) { //get right node
+		n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
+	}
+	for (int i = 0; i < 4; ++i) {
+		if (n.connected[i]) {
+			if (n.connected[i]->type == '.') {
+				n.costs[i]		= 1;
 			}
-			for (int i = 0; i < 4; ++i) {
-				if (n.connected[i]) {
-					if (n.connected[i]->type == '.') {
-						n.costs[i]		= 1;
-					}
-					if (n.connected[i]->type == 'x' || n.connected[i]->type == 'g') {
-						n.connected[i] = nullptr; //actually a wall, disconnect!
-					}
-				}
+			if (n.connected[i]->type == 'x' || n.connected[i]->type == 'g') {
+				n.connected[i] = nullptr; //actually a wall, disconnect!
 			}
-		}	
+		}
 	}
 }
 
@@ -81,102 +113,502 @@ NavigationGrid::~NavigationGrid()	{
 	delete[] allNodes;
 }
 
-bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
-	//need to work out which node 'from' sits in, and 'to' sits in
-	int fromX = ((int)from.x / nodeSize);
-	int fromZ = ((int)from.z / nodeSize);
+void GridSearchScratch::Begin(int nodeCount) {
+	if ((int)g.size() != nodeCount) {
+		g.assign(nodeCount, 0.0f);
+		f.assign(nodeCount, 0.0f);
+		parent.assign(nodeCount, -1);
+		heapIndex.assign(nodeCount, -1);
+		reachedIn.assign(nodeCount, 0);
+		arrivals.assign(nodeCount, 0);
+		search = 0;
+	}
+	closed.assign((nodeCount + 63) / 64, 0);
+	heap.clear();
+	expansions = 0;
+	if (++search == 0) { //Wrapped around - every old stamp could match again
+		std::fill(reachedIn.begin(), reachedIn.end(), 0);
+		search = 1;
+	}
+}
+
+static void HeapSwap(GridSearchScratch& s, int a, int b) {
+	std::swap(s.heap[a], s.heap[b]);
+	s.heapIndex[s.heap[a]] = a;
+	s.heapIndex[s.heap[b]] = b;
+}
 
-	int toX = ((int)to.x / nodeSize);
-	int toZ = ((int)to.z / nodeSize);
+static void HeapUp(GridSearchScratch& s, int i) {
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (s.f[s.heap[parent]] <= s.f[s.heap[i]]) {
+			return;
+		}
+		HeapSwap(s, i, parent);
+		i = parent;
+	}
+}
 
-	if (fromX < 0 || fromX > gridWidth - 1 ||
-		fromZ < 0 || fromZ > gridHeight - 1) {
-		return false; //outside of map region!
+static void HeapDown(GridSearchScratch& s, int i) {
+	int count = (int)s.heap.size();
+	while (true) {
+		int best	= i;
+		int left	= (i * 2) + 1;
+		int right	= left + 1;
+		if (left < count && s.f[s.heap[left]] < s.f[s.heap[best]]) {
+			best = left;
+		}
+		if (right < count && s.f[s.heap[right]] < s.f[s.heap[best]]) {
+			best = right;
+		}
+		if (best == i) {
+			return;
+		}
+		HeapSwap(s, i, best);
+		i = best;
 	}
+}
 
-	if (toX < 0 || toX > gridWidth - 1 ||
-		toZ < 0 || toZ > gridHeight - 1) {
-		return false; //outside of map region!
+int GridSearchScratch::Pop() {
+	int node = heap[0];
+	HeapSwap(*this, 0, (int)heap.size() - 1);
+	heap.pop_back();
+	heapIndex[node] = -1;
+	if (!heap.empty()) {
+		HeapDown(*this, 0);
 	}
+	return node;
+}
 
-	GridNode* startNode = &allNodes[(fromZ * gridWidth) + fromX];
-	GridNode* endNode	= &allNodes[(toZ * gridWidth) + toX];
+void GridSearchScratch::Push(int node) {
+	heapIndex[node] = (int)heap.size();
+	heap.emplace_back(node);
+	HeapUp(*this, (int)heap.size() - 1);
+}
 
-	std::vector<GridNode*>  openList;
-	std::vector<GridNode*>  closedList;
+void GridSearchScratch::Decrease(int node) {
+	HeapUp(*this, heapIndex[node]);
+}
 
-	openList.push_back(startNode);
+bool NavigationGrid::GetNodeIndex(const Vector3& position, int& index) const {
+	int x = ((int)position.x / nodeSize);
+	int z = ((int)position.z / nodeSize);
 
-	startNode->f = 0;
-	startNode->g = 0;
-	startNode->parent = nullptr;
+	if (x < 0 || x > gridWidth - 1 ||
+		z < 0 || z > gridHeight - 1) {
+		return false; //outside of map region!
+	}
+	index = (z * gridWidth) + x;
+	return true;
+}
 
-	GridNode* currentBestNode = nullptr;
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+	static thread_local GridSearchScratch scratch;
+	switch (pathMode) {
+		case GridPathMode::JumpPoint:		return FindJumpPointPath(from, to, outPath, scratch, false);
+		case GridPathMode::JumpPointPlus:	return FindJumpPointPath(from, to, outPath, scratch, true);
+		default:							return FindPath(from, to, outPath, scratch);
+	}
+}
 
-	while (!openList.empty()) {
-		currentBestNode = RemoveBestNode(openList);
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearchScratch& scratch) const {
+	//need to work out which node 'from' sits in, and 'to' sits in
+	int startIndex;
+	int endIndex;
+	if (!GetNodeIndex(from, startIndex) || !GetNodeIndex(to, endIndex)) {
+		return false;
+	}
+	const GridNode* endNode = &allNodes[endIndex];
+
+	scratch.Begin(gridWidth * gridHeight);
+
+	scratch.g[startIndex]			= 0;
+	scratch.f[startIndex]			= 0;
+	scratch.parent[startIndex]		= -1;
+	scratch.reachedIn[startIndex]	= scratch.search;
+	scratch.Push(startIndex);
 
-		if (currentBestNode == endNode) {			//we've found the path!
-			GridNode* node = endNode;
-			while (node != nullptr) {
-				outPath.PushWaypoint(node->position);
-				node = node->parent;
+	while (!scratch.heap.empty()) {
+		int best = scratch.Pop();
+		scratch.expansions++;
+
+		if (best == endIndex) {			//we've found the path!
+			for (int node = endIndex; node != -1; node = scratch.parent[node]) {
+				outPath.PushWaypoint(allNodes[node].position);
 			}
 			return true;
 		}
-		else {
-			for (int i = 0; i < 4; ++i) {
-				GridNode* neighbour = currentBestNode->connected[i];
-				if (!neighbour) { //might not be connected...
-					continue;
-				}	
-				bool inClosed	= NodeInList(neighbour, closedList);
-				if (inClosed) {
-					continue; //already discarded this neighbour...
-				}
+		scratch.closed[best / 64] |= (uint64_t)1 << (best % 64);
 
-				float h = Heuristic(neighbour, endNode);				
-				float g = currentBestNode->g + currentBestNode->costs[i];
-				float f = h + g;
+		const GridNode& bestNode = allNodes[best];
+		for (int i = 0; i < 4; ++i) {
+			const GridNode* neighbourNode = bestNode.connected[i];
+			if (!neighbourNode) { //might not be connected...
+				continue;
+			}
+			int neighbour = (int)(neighbourNode - allNodes);
+			if (scratch.closed[neighbour / 64] & ((uint64_t)1 << (neighbour % 64))) {
+				continue; //already discarded this neighbour...
+			}
 
-				bool inOpen		= NodeInList(neighbour, openList);
+			float h = Heuristic(neighbourNode, endNode);
+			float g = scratch.g[best] + bestNode.costs[i];
+			float f = h + g;
 
-				if (!inOpen) { //first time we've seen this neighbour
-					openList.emplace_back(neighbour);
-				}
-				if (!inOpen || f < neighbour->f) {//might be a better route to this neighbour
-					neighbour->parent = currentBestNode;
-					neighbour->f = f;
-					neighbour->g = g;
-				}
+			bool inOpen = scratch.reachedIn[neighbour] == scratch.search;
+
+			if (inOpen && f >= scratch.f[neighbour]) {
+				continue;
+			}
+			//first time we've seen this neighbour, or a better route to it
+			scratch.parent[neighbour]	= best;
+			scratch.f[neighbour]		= f;
+			scratch.g[neighbour]		= g;
+			if (inOpen) {
+				scratch.Decrease(neighbour);
+			}
+			else {
+				scratch.reachedIn[neighbour] = scratch.search;
+				scratch.Push(neighbour);
 			}
-			closedList.emplace_back(currentBestNode);
 		}
 	}
 	return false; //open list emptied out with no path!
 }
 
-bool NavigationGrid::NodeInList(GridNode* n, std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator i = std::find(list.begin(), list.end(), n);
-	return i == list.end() ? false : true;
+float NavigationGrid::Heuristic(const GridNode* hNode, const GridNode* endNode) const {
+	return (hNode->position - endNode->position).Length();
 }
 
-GridNode*  NavigationGrid::RemoveBestNode(std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator bestI = list.begin();
+//Which way each of a GridNode's connections go - up, down, left, right
+static const int DIR_X[4] = { 0, 0, -1, 1 };
+static const int DIR_Y[4] = { -1, 1, 0, 0 };
 
-	GridNode* bestNode = *list.begin();
+static const uint8_t START_ARRIVAL = 1 << 4; //The start node wasn't reached from anywhere, so can go any way
 
-	for (auto i = list.begin(); i != list.end(); ++i) {
-		if ((*i)->f < bestNode->f) {
-			bestNode	= (*i);
-			bestI		= i;
+bool NavigationGrid::IsWalkable(int x, int y) const {
+	if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight) {
+		return false;
+	}
+	int type = allNodes[(gridWidth * y) + x].type;
+	return type != WALL_NODE && type != 'g';
+}
+
+/*
+Moving along a row, a node is worth turning at if there's a way up or down
+from it that there wasn't from the node before - any shortest path that
+turns anywhere else could have turned one node earlier instead.
+*/
+bool NavigationGrid::IsForced(int x, int y, int dx) const {
+	return (IsWalkable(x, y - 1) && !IsWalkable(x - dx, y - 1)) ||
+		   (IsWalkable(x, y + 1) && !IsWalkable(x - dx, y + 1));
+}
+
+int NavigationGrid::JumpHorizontal(int x, int y, int dx, int goal) const {
+	while (true) {
+		x += dx;
+		if (!IsWalkable(x, y)) {
+			return -1;
+		}
+		int node = (gridWidth * y) + x;
+		if (node == goal || IsForced(x, y, dx)) {
+			return node;
 		}
 	}
-	list.erase(bestI);
+}
 
-	return bestNode;
+//Moving along a column, any node that a row search from would find something is a jump point
+int NavigationGrid::JumpVertical(int x, int y, int dy, int goal) const {
+	while (true) {
+		y += dy;
+		if (!IsWalkable(x, y)) {
+			return -1;
+		}
+		int node = (gridWidth * y) + x;
+		if (node == goal || JumpHorizontal(x, y, 1, goal) != -1 || JumpHorizontal(x, y, -1, goal) != -1) {
+			return node;
+		}
+	}
 }
 
-float NavigationGrid::Heuristic(GridNode* hNode, GridNode* endNode) const {
-	return (hNode->position - endNode->position).Length();
-}
\ No newline at end of file
+/*
+For every node and direction, how many steps it is to the next jump point
+that JumpHorizontal / JumpVertical would find if there was no goal, or if
+there isn't one before a wall, minus how many steps can be taken before
+the wall. Each row (or column) is done in one sweep, back to front, as a
+node's distance is just one more than the next node's, unless the next
+node is a jump point or a wall. Columns need the rows done first, as a
+node is a vertical jump point if there's a jump point to either side of it.
+*/
+void NavigationGrid::PrecomputeJumpDistances() {
+	jumpDistances.clear();
+	if (unevenNodes > 0) {
+		return;
+	}
+	jumpDistances.resize(gridWidth * gridHeight * 4, 0);
+
+	for (int y = 0; y < gridHeight; ++y) {
+		SweepRow(y, 2);
+		SweepRow(y, 3);
+	}
+	for (int x = 0; x < gridWidth; ++x) {
+		SweepColumn(x, 0);
+		SweepColumn(x, 1);
+	}
+}
+
+void NavigationGrid::SweepRow(int y, int dir) {
+	int dx = DIR_X[dir];
+	for (int i = 0; i < gridWidth; ++i) {
+		int x		= dx > 0 ? gridWidth - 1 - i : i;
+		int next	= (gridWidth * y) + x + dx;
+		int& distance = jumpDistances[(((gridWidth * y) + x) * 4) + dir];
+		if (!IsWalkable(x + dx, y)) {
+			distance = 0;
+		}
+		else if (IsForced(x + dx, y, dx)) {
+			distance = 1;
+		}
+		else {
+			int nextDistance = jumpDistances[(next * 4) + dir];
+			distance = nextDistance > 0 ? nextDistance + 1 : nextDistance - 1;
+		}
+	}
+}
+
+void NavigationGrid::SweepColumn(int x, int dir) {
+	int dy = DIR_Y[dir];
+	for (int i = 0; i < gridHeight; ++i) {
+		int y		= dy > 0 ? gridHeight - 1 - i : i;
+		int next	= (gridWidth * (y + dy)) + x;
+		int& distance = jumpDistances[(((gridWidth * y) + x) * 4) + dir];
+		if (!IsWalkable(x, y + dy)) {
+			distance = 0;
+		}
+		else if (IsVerticalJumpPoint(next)) {
+			distance = 1;
+		}
+		else {
+			int nextDistance = jumpDistances[(next * 4) + dir];
+			distance = nextDistance > 0 ? nextDistance + 1 : nextDistance - 1;
+		}
+	}
+}
+
+bool NavigationGrid::IsVerticalJumpPoint(int node) const {
+	return jumpDistances[(node * 4) + 2] > 0 || jumpDistances[(node * 4) + 3] > 0;
+}
+
+/*
+A node only changes its own connections, and those of its neighbours, but
+its JPS+ distances can reach a lot further - a whole row either side of it
+can gain or lose a forced neighbour, so those three rows are swept again.
+Any column that then has a vertical jump point appear or go away in those
+rows is swept again too, as is the node's own column.
+*/
+void NavigationGrid::SetNodeType(int x, int y, char type) {
+	if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight) {
+		return;
+	}
+	GridNode& n = allNodes[(gridWidth * y) + x];
+	bool wasUneven = IsWalkable(x, y) && n.type != FLOOR_NODE;
+	n.type = type;
+	bool isUneven = IsWalkable(x, y) && n.type != FLOOR_NODE;
+
+	ConnectNode(x, y);
+	for (int i = 0; i < 4; ++i) {
+		int nx = x + DIR_X[i];
+		int ny = y + DIR_Y[i];
+		if (nx >= 0 && nx < gridWidth && ny >= 0 && ny < gridHeight) {
+			ConnectNode(nx, ny);
+		}
+	}
+	bool wasUniform = IsUniformCost();
+	unevenNodes += (isUneven ? 1 : 0) - (wasUneven ? 1 : 0);
+
+	if (wasUniform != IsUniformCost()) {
+		PrecomputeJumpDistances();
+		return;
+	}
+	if (!IsUniformCost()) {
+		return;
+	}
+	int firstRow	= std::max(0, y - 1);
+	int lastRow		= std::min(gridHeight - 1, y + 1);
+
+	std::vector<bool> wasJumpPoint;
+	for (int row = firstRow; row <= lastRow; ++row) {
+		for (int col = 0; col < gridWidth; ++col) {
+			wasJumpPoint.emplace_back(IsVerticalJumpPoint((gridWidth * row) + col));
+		}
+	}
+	for (int row = firstRow; row <= lastRow; ++row) {
+		SweepRow(row, 2);
+		SweepRow(row, 3);
+	}
+	for (int col = 0; col < gridWidth; ++col) {
+		bool changed = col == x;
+		for (int row = firstRow; row <= lastRow && !changed; ++row) {
+			changed = wasJumpPoint[((row - firstRow) * gridWidth) + col] != IsVerticalJumpPoint((gridWidth * row) + col);
+		}
+		if (changed) {
+			SweepColumn(col, 0);
+			SweepColumn(col, 1);
+		}
+	}
+}
+
+/*
+Fills jumpPoints with where a jump from node in direction dir ends up, and
+returns how many there are (0 to 2). The precomputed distances don't know
+where the goal is, so anything to do with it is checked here instead - the
+goal itself if it's in reach straight ahead, and, going along a column, the
+node on the goal's row, as a row search from there could reach the goal.
+*/
+int NavigationGrid::GetJumpPoints(int node, int dir, int goal, bool usePrecomputed, int* jumpPoints) const {
+	int x	= node % gridWidth;
+	int y	= node / gridWidth;
+	int dx	= DIR_X[dir];
+	int dy	= DIR_Y[dir];
+
+	if (!usePrecomputed) {
+		int jumpPoint = dx != 0 ? JumpHorizontal(x, y, dx, goal) : JumpVertical(x, y, dy, goal);
+		if (jumpPoint == -1) {
+			return 0;
+		}
+		jumpPoints[0] = jumpPoint;
+		return 1;
+	}
+	int count		= 0;
+	int distance	= jumpDistances[(node * 4) + dir];
+	int freeSteps	= std::abs(distance);
+
+	int goalX = goal % gridWidth;
+	int goalY = goal / gridWidth;
+	int goalSteps	= dx != 0 ? (goalX - x) * dx : (goalY - y) * dy;
+	bool goalInLine = dx != 0 ? goalY == y : goalX == x;
+
+	if (goalSteps > 0 && goalSteps <= freeSteps) {
+		if (goalInLine) {
+			jumpPoints[0] = goal;
+			return 1;
+		}
+		if (dy != 0 && (distance <= 0 || goalSteps < distance)) {
+			jumpPoints[count++] = node + (goalSteps * dy * gridWidth);
+		}
+	}
+	if (distance > 0) {
+		jumpPoints[count++] = node + (distance * (dx + (dy * gridWidth)));
+	}
+	return count;
+}
+
+/*
+Each node remembers which ways it was reached with its lowest cost so far -
+a node reached along a row can only carry on along it, or turn where it's
+forced to, but one reached along a column can carry on, or turn either way.
+If a node is reached just as cheaply a different way, that way's added on,
+and the node is looked at again if it's already been closed, as there might
+be somewhere it could only go after arriving that way.
+*/
+bool NavigationGrid::FindJumpPointPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearchScratch& scratch, bool usePrecomputed) const {
+	if (unevenNodes > 0) {
+		return FindPath(from, to, outPath, scratch);
+	}
+	int startIndex;
+	int endIndex;
+	if (!GetNodeIndex(from, startIndex) || !GetNodeIndex(to, endIndex)) {
+		return false;
+	}
+	int goalX = endIndex % gridWidth;
+	int goalY = endIndex / gridWidth;
+
+	scratch.Begin(gridWidth * gridHeight);
+
+	scratch.g[startIndex]			= 0;
+	scratch.f[startIndex]			= (float)(std::abs((startIndex % gridWidth) - goalX) + std::abs((startIndex / gridWidth) - goalY));
+	scratch.parent[startIndex]		= -1;
+	scratch.reachedIn[startIndex]	= scratch.search;
+	scratch.arrivals[startIndex]	= START_ARRIVAL;
+	scratch.Push(startIndex);
+
+	while (!scratch.heap.empty()) {
+		int best = scratch.Pop();
+		scratch.expansions++;
+
+		if (best == endIndex) {
+			for (int node = endIndex; node != -1; node = scratch.parent[node]) {
+				outPath.PushWaypoint(allNodes[node].position);
+				int parent = scratch.parent[node];
+				if (parent == -1) {
+					break;
+				}
+				//Put back the nodes that were jumped over
+				int step = (parent / gridWidth) == (node / gridWidth) ? 1 : gridWidth;
+				step = parent > node ? step : -step;
+				for (int between = node + step; between != parent; between += step) {
+					outPath.PushWaypoint(allNodes[between].position);
+				}
+			}
+			return true;
+		}
+		scratch.closed[best / 64] |= (uint64_t)1 << (best % 64);
+
+		int x = best % gridWidth;
+		int y = best / gridWidth;
+		uint8_t arrivedFrom = scratch.arrivals[best];
+
+		for (int dir = 0; dir < 4; ++dir) {
+			bool canGo = (arrivedFrom & START_ARRIVAL) != 0;
+			for (int arrival = 0; arrival < 4 && !canGo; ++arrival) {
+				if (!(arrivedFrom & (1 << arrival)) || (arrival ^ 1) == dir) {
+					continue; //Not reached this way, or it'd be going straight back
+				}
+				if (arrival == dir || DIR_X[arrival] == 0) {
+					canGo = true;
+				}
+				else {
+					canGo = IsWalkable(x, y + DIR_Y[dir]) && !IsWalkable(x - DIR_X[arrival], y + DIR_Y[dir]);
+				}
+			}
+			if (!canGo) {
+				continue;
+			}
+			int jumpPoints[2];
+			int jumpCount = GetJumpPoints(best, dir, endIndex, usePrecomputed, jumpPoints);
+
+			for (int i = 0; i < jumpCount; ++i) {
+				int jumpPoint	= jumpPoints[i];
+				int jumpX		= jumpPoint % gridWidth;
+				int jumpY		= jumpPoint / gridWidth;
+				float g			= scratch.g[best] + (float)(std::abs(jumpX - x) + std::abs(jumpY - y));
+				uint8_t arrival = (uint8_t)(1 << dir);
+				bool closed		= (scratch.closed[jumpPoint / 64] & ((uint64_t)1 << (jumpPoint % 64))) != 0;
+
+				if (scratch.reachedIn[jumpPoint] != scratch.search || g < scratch.g[jumpPoint]) {
+					scratch.parent[jumpPoint]	= best;
+					scratch.g[jumpPoint]		= g;
+					scratch.f[jumpPoint]		= g + (float)(std::abs(jumpX - goalX) + std::abs(jumpY - goalY));
+					scratch.arrivals[jumpPoint] = arrival;
+					if (scratch.reachedIn[jumpPoint] == scratch.search && !closed) {
+						scratch.Decrease(jumpPoint);
+						continue;
+					}
+				}
+				else if (g == scratch.g[jumpPoint] && !(scratch.arrivals[jumpPoint] & arrival)) {
+					scratch.arrivals[jumpPoint] |= arrival;
+					if (!closed) {
+						continue;
+					}
+				}
+				else {
+					continue;
+				}
+				scratch.reachedIn[jumpPoint] = scratch.search;
+				scratch.closed[jumpPoint / 64] &= ~((uint64_t)1 << (jumpPoint % 64));
+				scratch.Push(jumpPoint);
+			}
+		}
+	}
+	return false;
+}
@@ -1,19 +1,16 @@
 #pragma once
 #include "NavigationMap.h"
+#include <cstdint>
 #include <string>
+#include <vector>
 namespace NCL {
 	namespace CSC8503 {
 		struct GridNode {
-			GridNode* parent;
-
 			GridNode* connected[4];
 			int		  costs[4];
 
 			Vector3		position;
 
-			float f;
-			float g;
-
 			int type;
 
 			GridNode() {
@@ -21,31 +18,140 @@ namespace NCL {
 					connected[i] = nullptr;
 					costs[i] = 0;
 				}
-				f = 0;
-				g = 0;
 				type = 0;
-				parent = nullptr;
 			}
 			~GridNode() {	}
 		};
 
+		/*
+		Everything an A* search needs to remember about the nodes it's been
+		through, kept apart from the grid, so the grid itself is never
+		written to, and any number of searches can run over it at once, as
+		long as each has its own scratch.
+
+		Nodes are referred to by their index in the grid. Rather than
+		clearing every node's costs before each search, each node is stamped
+		with the search that last reached it - a node that isn't stamped
+		with this search's number hasn't been reached yet, whatever its
+		costs say. The open list is a binary heap of node indices, ordered
+		by f, with heapIndex saying where each open node is in it, so a
+		node can be moved up when a better route to it is found.
+		*/
+		struct GridSearchScratch {
+			std::vector<float>		g;
+			std::vector<float>		f;
+			std::vector<int>		parent;
+			std::vector<int>		heapIndex;
+			std::vector<uint32_t>	reachedIn;	//Which search last reached each node
+			std::vector<uint8_t>	arrivals;	//Jump point searches only - which ways each node was reached
+			std::vector<uint64_t>	closed;		//One bit per node
+			std::vector<int>		heap;
+			uint32_t				search = 0;
+			int						expansions = 0;	//How many nodes the last search took off the open list
+
+			//Gets ready for a new search over nodeCount nodes
+			void Begin(int nodeCount);
+
+			//The open list
+			void	Push(int node);
+			int		Pop();
+			void	Decrease(int node);	//Moves an open node up, after its f has gone down
+		};
+
+		enum class GridPathMode {
+			AStar,
+			JumpPoint,
+			JumpPointPlus
+		};
+
 		class NavigationGrid : public NavigationMap	{
 		public:
 			NavigationGrid();
 			NavigationGrid(const std::string&filename);
+			//nodeTypes is gridWidth * gridHeight of the same characters as the files use, a row at a time
+			NavigationGrid(int nodeSize, int gridWidth, int gridHeight, const std::vector<char>& nodeTypes);
 			~NavigationGrid();
 
+			//Uses scratch belonging to the calling thread, so can be called from any number of threads at once
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearchScratch& scratch) const;
+
+			/*
+			Jump point search - on a grid where every step costs the same,
+			most nodes along a straight run can't be on a shorter path than
+			the nodes either side of them, so rather than putting every node
+			on the open list, the search jumps straight along each run until
+			it reaches somewhere a turn might be worth making (a jump point),
+			and only those go on the open list. Paths always come out as
+			short as possible, with a waypoint at every node, as FindPath's
+			do.
+
+			With usePrecomputed (JPS+), how far it is to the next jump point
+			(or wall) from every node, in every direction, is worked out when
+			the grid is loaded, so each jump is a lookup rather than a walk.
+
+			On grids where steps don't all cost the same, this just calls
+			FindPath instead.
+			*/
+			bool FindJumpPointPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearchScratch& scratch, bool usePrecomputed = true) const;
+
+			//Which search the NavigationMap FindPath uses
+			void SetPathMode(GridPathMode mode) {
+				pathMode = mode;
+			}
+
+			bool IsUniformCost() const {
+				return unevenNodes == 0;
+			}
+
+			/*
+			Changes the type of the node at x, y, and reconnects it and its
+			neighbours to match, keeping the JPS+ distances up to date too.
+			Nothing can be searching the grid while this happens.
+			*/
+			void SetNodeType(int x, int y, char type);
+
+			int GetWidth() const {
+				return gridWidth;
+			}
+			int GetHeight() const {
+				return gridHeight;
+			}
+			int GetNodeSize() const {
+				return nodeSize;
+			}
+			const GridNode& GetNode(int index) const {
+				return allNodes[index];
+			}
+
+			bool		GetNodeIndex(const Vector3& position, int& index) const;
+			bool		IsWalkable(int x, int y) const;
 				
 		protected:
-			bool		NodeInList(GridNode* n, std::vector<GridNode*>& list) const;
-			GridNode*	RemoveBestNode(std::vector<GridNode*>& list) const;
-			float		Heuristic(GridNode* hNode, GridNode* endNode) const;
+			void		BuildConnections();
+			void		ConnectNode(int x, int y);
+			void		PrecomputeJumpDistances();
+			void		SweepRow(int y, int dir);
+			void		SweepColumn(int x, int dir);
+			bool		IsVerticalJumpPoint(int node) const;
+
+			float		Heuristic(const GridNode* hNode, const GridNode* endNode) const;
+
+			bool		IsForced(int x, int y, int dx) const;
+			int			JumpHorizontal(int x, int y, int dx, int goal) const;
+			int			JumpVertical(int x, int y, int dy, int goal) const;
+			int			GetJumpPoints(int node, int dir, int goal, bool usePrecomputed, int* jumpPoints) const;
+
 			int nodeSize;
 			int gridWidth;
 			int gridHeight;
 
 			GridNode* allNodes;
+
+			int					unevenNodes;	//Walkable nodes that aren't '.'
+			GridPathMode		pathMode;
+			std::vector<int>	jumpDistances;	//4 per node - see PrecomputeJumpDistances
 		};
 	}
 }
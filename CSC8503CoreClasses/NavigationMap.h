@@ -8,7 +8,7 @@ namespace NCL {
 		{
 		public:
 			NavigationMap() {}
-			~NavigationMap() {}
+			virtual ~NavigationMap() = default;	//Maps are deleted through NavigationMap pointers
 
 			virtual bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) = 0;
 		};
@@ -2,7 +2,7 @@
 #include "CollisionVolume.h"
 
 namespace NCL {
-	class OBBVolume : CollisionVolume
+	class OBBVolume : public CollisionVolume
 	{
 	public:
 		OBBVolume(const Maths::Vector3& halfDims = Maths::Vector3(1,1,1)) {
@@ -17,5 +17,6 @@ namespace NCL {
 	protected:
 		Maths::Vector3 halfSizes;
 	};
+	static_assert(sizeof(OBBVolume) <= CollisionVolume::PooledSize, "OBBVolume won't fit in a pooled volume block");
 }
 
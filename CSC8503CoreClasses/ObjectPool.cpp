@@ -0,0 +1,136 @@
+#include "ObjectPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <new>
+
+using namespace NCL;
+using namespace CSC8503;
+
+BlockPool::BlockPool(size_t size, size_t chunkSize) {
+	//Every block has to be big enough, and aligned enough, to hold a free list link
+	blockSize		= (std::max(size, sizeof(FreeBlock)) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	blocksPerChunk	= std::max(chunkSize / blockSize, (size_t)1);
+	currentChunk	= 0;
+	carved			= 0;
+	freeList		= nullptr;
+	liveCount		= 0;
+}
+
+//Anything still in use when the pool goes is left where it is, rather than being pulled out from under it
+BlockPool::~BlockPool() {
+	if (liveCount > 0) {
+		return;
+	}
+	for (char* c : chunks) {
+		::operator delete(c);
+	}
+}
+
+void* BlockPool::Allocate() {
+	liveCount++;
+	if (freeList) {
+		FreeBlock* block = freeList;
+		freeList = block->next;
+		return block;
+	}
+	if (currentChunk < chunks.size() && carved == blocksPerChunk) {
+		currentChunk++;
+		carved = 0;
+	}
+	if (currentChunk == chunks.size()) {
+		chunks.emplace_back((char*)::operator new(blockSize * blocksPerChunk));
+	}
+	return chunks[currentChunk] + (carved++ * blockSize);
+}
+
+void BlockPool::Free(void* p) {
+	FreeBlock* block = (FreeBlock*)p;
+	block->next = freeList;
+	freeList	= block;
+	liveCount--;
+}
+
+//The chunks are kept, ready for whatever comes next
+void BlockPool::Reset() {
+	if (liveCount > 0) {
+		return;
+	}
+	freeList		= nullptr;
+	currentChunk	= 0;
+	carved			= 0;
+}
+
+ObjectPools::TypePools& ObjectPools::GetPools(PoolType type) {
+	static TypePools pools[(int)PoolType::MaxPools];
+	return pools[(int)type];
+}
+
+int ObjectPools::GetSizeClass(size_t size) {
+	int sizeClass = 0;
+	while ((MinBlockSize << sizeClass) < size) {
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+//Nothing stops two threads using the pools at once, so debug builds at least catch it when they do
+static std::atomic<bool> poolsInUse = false;
+
+struct PoolUseCheck {
+#ifndef NDEBUG
+	PoolUseCheck() {
+		bool wasInUse = poolsInUse.exchange(true);
+		assert(!wasInUse && "Only one thread can use the object pools at a time");
+	}
+	~PoolUseCheck() {
+		poolsInUse = false;
+	}
+#endif
+};
+
+void* ObjectPools::Allocate(PoolType type, size_t size) {
+	[[maybe_unused]] PoolUseCheck check;
+	TypePools& pools = GetPools(type);
+	pools.stats.allocations++;
+	pools.stats.liveCount++;
+	if (size > MaxBlockSize) {
+		pools.stats.heapAllocations++;
+		return ::operator new(size);
+	}
+	BlockPool& pool = pools.sizeClasses[GetSizeClass(size)];
+	int chunks = pool.GetChunkCount();
+	void* p = pool.Allocate();
+	if (pool.GetChunkCount() != chunks) {
+		pools.stats.heapAllocations++;
+		pools.stats.chunkCount++;
+	}
+	return p;
+}
+
+void ObjectPools::Free(PoolType type, void* p, size_t size) {
+	if (!p) {
+		return;
+	}
+	[[maybe_unused]] PoolUseCheck check;
+	TypePools& pools = GetPools(type);
+	pools.stats.frees++;
+	pools.stats.liveCount--;
+	if (size > MaxBlockSize) {
+		::operator delete(p);
+		return;
+	}
+	pools.sizeClasses[GetSizeClass(size)].Free(p);
+}
+
+ObjectPools::Stats ObjectPools::GetStats(PoolType type) {
+	return GetPools(type).stats;
+}
+
+void ObjectPools::ResetEmptyPools() {
+	for (int t = 0; t < (int)PoolType::MaxPools; ++t) {
+		for (BlockPool& pool : GetPools((PoolType)t).sizeClasses) {
+			pool.Reset();
+		}
+	}
+}
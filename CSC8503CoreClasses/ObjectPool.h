@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Hands out blocks of one fixed size, carved out of much bigger chunks
+		taken from the heap. Freed blocks go on a free list, and are handed
+		out again before anything new is carved off, so once a game has
+		spawned as much as it ever has at once, spawning and despawning
+		never touches the heap again.
+
+		Reset rewinds the whole pool in one go, so the next level's objects
+		are laid out one after another from the start of the first chunk
+		again, rather than wherever the last level happened to leave holes.
+		It's only allowed while nothing from the pool is still in use.
+		*/
+		class BlockPool {
+		public:
+			BlockPool(size_t blockSize, size_t chunkSize = 64 * 1024);
+			BlockPool(const BlockPool& other) = delete;
+			~BlockPool();
+
+			void*	Allocate();
+			void	Free(void* p);
+
+			void	Reset();
+
+			size_t GetBlockSize() const {
+				return blockSize;
+			}
+
+			int GetLiveCount() const {
+				return liveCount;
+			}
+
+			int GetChunkCount() const {
+				return (int)chunks.size();
+			}
+
+		protected:
+			struct FreeBlock {
+				FreeBlock* next;
+			};
+
+			std::vector<char*> chunks;
+
+			size_t		blockSize;
+			size_t		blocksPerChunk;
+			size_t		currentChunk;	//The chunk new blocks are being carved from
+			size_t		carved;			//How many blocks have been carved from it
+			FreeBlock*	freeList;
+			int			liveCount;
+		};
+
+		enum class PoolType {
+			GameObjects,
+			PhysicsObjects,
+			RenderObjects,
+			CollisionVolumes,
+			MaxPools
+		};
+
+		/*
+		Where GameObjects and their components get their memory from - each
+		of those classes has its own operator new and delete that come here,
+		so they're all still made with new and deleted with delete as usual.
+
+		Each type gets its own set of pools, one per size class (powers of
+		two, from 32 to 1024 bytes) so objects of the same type end up next
+		to each other, and things that are spawned together, like a bullet's
+		components, end up near each other too. Anything bigger than the
+		largest size class just goes to the heap.
+
+		The counters are there to check that a game running steadily isn't
+		going to the heap every frame - heapAllocations only goes up when a
+		pool needs a new chunk, or something's too big to be pooled.
+
+		None of this is thread safe. Objects can be made and deleted from
+		any thread, but only one at a time - the game's frame graph makes
+		sure of that (the AI tasks that run side by side queue up what they
+		spawn for the physics task), and debug builds assert that it does.
+		*/
+		class ObjectPools {
+		public:
+			struct Stats {
+				long long	allocations		= 0;
+				long long	frees			= 0;
+				long long	heapAllocations = 0;
+				int			liveCount		= 0;
+				int			chunkCount		= 0;
+			};
+
+			static void*	Allocate(PoolType type, size_t size);
+			static void		Free(PoolType type, void* p, size_t size);
+
+			static Stats	GetStats(PoolType type);
+
+			//Rewinds every pool that has nothing left in it - see BlockPool::Reset
+			static void		ResetEmptyPools();
+
+		protected:
+			static constexpr int	SizeClassCount	= 6;
+			static constexpr size_t	MinBlockSize	= 32;
+			static constexpr size_t	MaxBlockSize	= MinBlockSize << (SizeClassCount - 1);
+
+			struct TypePools {
+				BlockPool	sizeClasses[SizeClassCount] = { 32, 64, 128, 256, 512, 1024 };
+				Stats		stats;
+			};
+
+			static TypePools&	GetPools(PoolType type);
+			static int			GetSizeClass(size_t size);
+		};
+	}
+}
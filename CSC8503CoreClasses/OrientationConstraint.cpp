@@ -1,11 +1,12 @@
 #include "OrientationConstraint.h"
 #include "GameObject.h"
 #include "PhysicsObject.h"
+#include "RigidBodyStore.h"
 using namespace NCL;
 using namespace Maths;
 using namespace CSC8503;
 
-OrientationConstraint::OrientationConstraint(GameObject* a, GameObject* b,Vector3 angle)
+OrientationConstraint::OrientationConstraint(GameObject* a, GameObject* b,Vector3 angle) : Constraint(ConstraintType::Orientation)
 {
 	objectA = a;
 	objectB = b;
@@ -17,7 +18,6 @@ OrientationConstraint::~OrientationConstraint()
 {
 
 }
-#include <Window.h>
 void OrientationConstraint::UpdateConstraint(float dt) {
 	
 	Vector3 relativeOrientation = objectA->GetTransform().GetOrientation().ToEuler() - objectB->GetTransform().GetOrientation().ToEuler();
@@ -53,14 +53,41 @@ void OrientationConstraint::UpdateConstraint(float dt) {
 
 			physA->ApplyAngularImpulse(aImpulse);
 			physB->ApplyAngularImpulse(bImpulse);
-			if (Window::GetWindow()->GetKeyboard()->KeyDown(KeyboardKeys::L)) {
-				bool a = false;
+		}
+	}
+}
+
+void OrientationConstraint::Solve(RigidBodyStore& bodies, int bodyA, int bodyB, const Vector3& angle, float dt) {
+	Vector3 relativeOrientation = bodies.GetOrientation(bodyA).ToEuler() - bodies.GetOrientation(bodyB).ToEuler();
+	float offset = 1 - Vector3::Dot(relativeOrientation.Normalised(), angle);
+
+	if (abs(offset) > 0) {
+		Vector3 offsetDir = Vector3::Cross(angle, relativeOrientation);
+
+		float inverseMassA = bodies.GetInverseMass(bodyA);
+		float inverseMassB = bodies.GetInverseMass(bodyB);
+
+		float constraintMass = inverseMassA + inverseMassB;
+		if (constraintMass > 0) {
+			Vector3 relativeAngVel = Vector3::Cross(bodies.GetAngularVelocity(bodyA) - bodies.GetAngularVelocity(bodyB), angle);
+
+			float angVelDot = Vector3::Dot(relativeAngVel, offsetDir);
+			float biasFactor = 0.01f;
+			float bias = -(biasFactor / dt) * offset;
+			float lambda = -(angVelDot + bias) / constraintMass;
+			if (lambda != lambda) {
+				return;
 			}
-			if (Window::GetWindow()->GetMouse()->ButtonDown(MouseButtons::RIGHT)) {
-				bool a = false;
-				//std::cout << offsetDir << '\n';
+			if (lambda < 0) {
+				lambda = 0;
 			}
 
+			if (inverseMassA > 0.0f) {
+				bodies.SetAngularVelocity(bodyA, bodies.GetAngularVelocity(bodyA) + bodies.GetInertiaTensor(bodyA) * (offsetDir * lambda));
+			}
+			if (inverseMassB > 0.0f) {
+				bodies.SetAngularVelocity(bodyB, bodies.GetAngularVelocity(bodyB) - bodies.GetInertiaTensor(bodyB) * (offsetDir * lambda));
+			}
 		}
 	}
-}
\ No newline at end of file
+}
@@ -5,6 +5,7 @@ using namespace NCL::Maths;
 namespace NCL {
 	namespace CSC8503 {
 		class GameObject;
+		class RigidBodyStore;
 
 		class OrientationConstraint : public Constraint
 		{
@@ -14,6 +15,18 @@ namespace NCL {
 
 			void UpdateConstraint(float dt) override;
 
+			void GetObjects(GameObject*& a, GameObject*& b) const override {
+				a = objectA;
+				b = objectB;
+			}
+
+			Vector3 GetAngle() const {
+				return angle;
+			}
+
+			//Works straight on two bodies in a body store, like PositionConstraint::Solve
+			static void Solve(RigidBodyStore& bodies, int bodyA, int bodyB, const Vector3& angle, float dt);
+
 		protected:
 			GameObject* objectA;
 			GameObject* objectB;
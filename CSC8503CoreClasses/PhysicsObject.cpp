@@ -11,38 +11,84 @@ PhysicsObject::PhysicsObject(Transform* parentTransform, const CollisionVolume*
 	inverseMass = 1.0f;
 	elasticity	= 0.8f;
 	friction	= 0.8f;
+
+	continuousCollision = false;
+
+	bodyStore	= nullptr;
+	bodyIndex	= -1;
 }
 
 PhysicsObject::~PhysicsObject()	{
+	if (bodyStore) {
+		bodyStore->RemoveBody(bodyIndex);
+	}
+}
+
+void PhysicsObject::SetForce(const Vector3& f) {
+	if (bodyStore) {
+		bodyStore->SetForce(bodyIndex, f);
+	}
+	force = f;
+}
 
+void PhysicsObject::SetTorque(const Vector3& t) {
+	if (bodyStore) {
+		bodyStore->SetTorque(bodyIndex, t);
+	}
+	torque = t;
+}
+
+void PhysicsObject::SetInverseInertia(const Vector3& i) {
+	if (bodyStore) {
+		bodyStore->SetInverseInertia(bodyIndex, i);
+	}
+	inverseInertia = i;
+}
+
+/*
+Pushing an object wakes it up - unless it can't be moved, so that anything
+fixed in place can stay asleep however much is pushing against it. Impulses
+can't do anything at all to those, so they're skipped entirely.
+*/
+void PhysicsObject::WakeIfMovable() {
+	if (GetInverseMass() > 0.0f) {
+		Wake();
+	}
 }
 
 void PhysicsObject::ApplyAngularImpulse(const Vector3& force) {
-	angularVelocity += inverseInteriaTensor * force;
+	if (GetInverseMass() > 0.0f) {
+		SetAngularVelocity(GetAngularVelocity() + GetInertiaTensor() * force);
+	}
 }
 
 void PhysicsObject::ApplyLinearImpulse(const Vector3& force) {
-	linearVelocity += force * inverseMass;
+	if (GetInverseMass() > 0.0f) {
+		SetLinearVelocity(GetLinearVelocity() + force * GetInverseMass());
+	}
 }
 
 void PhysicsObject::AddForce(const Vector3& addedForce) {
-	force += addedForce;
+	WakeIfMovable();
+	SetForce(GetForce() + addedForce);
 }
 
 void PhysicsObject::AddForceAtPosition(const Vector3& addedForce, const Vector3& position) {
+	WakeIfMovable();
 	Vector3 localPos = position - transform->GetPosition();
 
-	force  += addedForce;
-	torque += Vector3::Cross(localPos, addedForce);
+	SetForce(GetForce() + addedForce);
+	SetTorque(GetTorque() + Vector3::Cross(localPos, addedForce));
 }
 
 void PhysicsObject::AddTorque(const Vector3& addedTorque) {
-	torque += addedTorque;
+	WakeIfMovable();
+	SetTorque(GetTorque() + addedTorque);
 }
 
 void PhysicsObject::ClearForces() {
-	force				= Vector3();
-	torque				= Vector3();
+	SetForce(Vector3());
+	SetTorque(Vector3());
 }
 
 void PhysicsObject::InitCubeInertia() {
@@ -52,16 +98,19 @@ void PhysicsObject::InitCubeInertia() {
 
 	Vector3 dimsSqr		= fullWidth * fullWidth;
 
-	inverseInertia.x = (12.0f * inverseMass) / (dimsSqr.y + dimsSqr.z);
-	inverseInertia.y = (12.0f * inverseMass) / (dimsSqr.x + dimsSqr.z);
-	inverseInertia.z = (12.0f * inverseMass) / (dimsSqr.x + dimsSqr.y);
+	float invMass = GetInverseMass();
+	Vector3 i;
+	i.x = (12.0f * invMass) / (dimsSqr.y + dimsSqr.z);
+	i.y = (12.0f * invMass) / (dimsSqr.x + dimsSqr.z);
+	i.z = (12.0f * invMass) / (dimsSqr.x + dimsSqr.y);
+	SetInverseInertia(i);
 }
 
 void PhysicsObject::InitSphereInertia() {
 	float radius	= transform->GetScale().GetMaxElement();
-	float i			= 2.5f * inverseMass / (radius*radius);
+	float i			= 2.5f * GetInverseMass() / (radius*radius);
 
-	inverseInertia	= Vector3(i, i, i);
+	SetInverseInertia(Vector3(i, i, i));
 }
 
 void PhysicsObject::UpdateInertiaTensor() {
@@ -70,5 +119,10 @@ void PhysicsObject::UpdateInertiaTensor() {
 	Matrix3 invOrientation	= Matrix3(q.Conjugate());
 	Matrix3 orientation		= Matrix3(q);
 
-	inverseInteriaTensor = orientation * Matrix3::Scale(inverseInertia) *invOrientation;
+	Vector3 localInertia = bodyStore ? bodyStore->GetInverseInertia(bodyIndex) : inverseInertia;
+
+	inverseInteriaTensor = orientation * Matrix3::Scale(localInertia) *invOrientation;
+	if (bodyStore) {
+		bodyStore->SetInertiaTensor(bodyIndex, inverseInteriaTensor);
+	}
 }
\ No newline at end of file
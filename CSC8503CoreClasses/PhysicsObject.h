@@ -1,4 +1,6 @@
 #pragma once
+#include "RigidBodyStore.h"
+#include "ObjectPool.h"
 using namespace NCL::Maths;
 
 namespace NCL {
@@ -10,30 +12,61 @@ namespace NCL {
 		class PhysicsObject	{
 		public:
 			PhysicsObject(Transform* parentTransform, const CollisionVolume* parentVolume);
+			PhysicsObject(const PhysicsObject& other) = delete;
 			~PhysicsObject();
 
+			PhysicsObject& operator=(const PhysicsObject& other) = delete;
+
+			static void* operator new(size_t size) {
+				return ObjectPools::Allocate(PoolType::PhysicsObjects, size);
+			}
+
+			static void operator delete(void* p, size_t size) {
+				ObjectPools::Free(PoolType::PhysicsObjects, p, size);
+			}
+
 			Vector3 GetLinearVelocity() const {
-				return linearVelocity;
+				return bodyStore ? bodyStore->GetLinearVelocity(bodyIndex) : linearVelocity;
 			}
 
 			Vector3 GetAngularVelocity() const {
-				return angularVelocity;
+				return bodyStore ? bodyStore->GetAngularVelocity(bodyIndex) : angularVelocity;
 			}
 
 			Vector3 GetTorque() const {
-				return torque;
+				return bodyStore ? bodyStore->GetTorque(bodyIndex) : torque;
 			}
 
 			Vector3 GetForce() const {
-				return force;
+				return bodyStore ? bodyStore->GetForce(bodyIndex) : force;
 			}
 
 			void SetInverseMass(float invMass) {
+				if (bodyStore) {
+					bodyStore->SetInverseMass(bodyIndex, invMass);
+				}
 				inverseMass = invMass;
 			}
 
 			float GetInverseMass() const {
-				return inverseMass;
+				return bodyStore ? bodyStore->GetInverseMass(bodyIndex) : inverseMass;
+			}
+
+			//How bouncy the object is - 0 stops dead on impact, 1 bounces back at full speed
+			void SetElasticity(float e) {
+				elasticity = e;
+			}
+
+			float GetElasticity() const {
+				return elasticity;
+			}
+
+			void SetFriction(float f) {
+				friction = f;
+			}
+
+			float GetFriction() const {
+				return friction;
 			}
 
 			void ApplyAngularImpulse(const Vector3& force);
@@ -49,20 +82,62 @@ namespace NCL {
 			void ClearForces();
 
 			void SetLinearVelocity(const Vector3& v) {
+				if (bodyStore) {
+					bodyStore->WakeBody(bodyIndex);
+					bodyStore->SetLinearVelocity(bodyIndex, v);
+				}
 				linearVelocity = v;
 			}
 
 			void SetAngularVelocity(const Vector3& v) {
+				if (bodyStore) {
+					bodyStore->WakeBody(bodyIndex);
+					bodyStore->SetAngularVelocity(bodyIndex, v);
+				}
 				angularVelocity = v;
 			}
 
+			/*
+			Objects that have been resting for a while are put to sleep by the
+			PhysicsSystem, and left out of the simulation until something hits
+			them, or they're pushed, moved or given a velocity.
+			*/
+			bool IsAsleep() const {
+				return bodyStore && !bodyStore->IsAwake(bodyIndex);
+			}
+
+			void Wake() {
+				if (bodyStore) {
+					bodyStore->WakeBody(bodyIndex);
+				}
+			}
+
+			/*
+			Objects that move far enough in a step to pass straight through
+			something should be swept from where they are to where they're
+			going, rather than only being tested where they end up - things
+			like bullets, or anything thrown hard. It costs a little more for
+			each object it's used on.
+			*/
+			void UseContinuousCollision(bool state) {
+				continuousCollision = state;
+			}
+
+			bool UsesContinuousCollision() const {
+				return continuousCollision;
+			}
+
 			void InitCubeInertia();
 			void InitSphereInertia();
 
 			void UpdateInertiaTensor();
 
 			Matrix3 GetInertiaTensor() const {
-				return inverseInteriaTensor;
+				return bodyStore ? bodyStore->GetInertiaTensor(bodyIndex) : inverseInteriaTensor;
+			}
+
+			bool IsInBodyStore() const {
+				return bodyStore != nullptr;
 			}
 
 			CollisionVolume* GetCollisionVolume() const {
@@ -70,12 +145,25 @@ namespace NCL {
 			}
 
 		protected:
+			friend class RigidBodyStore;
+
+			void WakeIfMovable();
+
+			void SetForce(const Vector3& f);
+			void SetTorque(const Vector3& t);
+			void SetInverseInertia(const Vector3& i);
+
 			const CollisionVolume* volume;
 			Transform*		transform;
 
+			//If set, the values below are out of date - the store has the real ones
+			RigidBodyStore* bodyStore;
+			int				bodyIndex;
+
 			float inverseMass;
 			float elasticity;
 			float friction;
+			bool  continuousCollision;
 
 			//linear stuff
 			Vector3 linearVelocity;
@@ -0,0 +1,262 @@
+#include "PhysicsProfiler.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+#ifdef PHYSICS_PROFILE_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#endif
+
+using namespace NCL;
+using namespace CSC8503;
+
+//Set while the profiler is storing what it's recorded, so it doesn't count itself
+static thread_local bool ignoreAllocations = false;
+
+#ifdef PHYSICS_PROFILE_ALLOCATIONS
+static std::atomic<long long> allocationCount = 0;
+
+static void CountAllocation() {
+	if (!ignoreAllocations) {
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/*
+The array and nothrow versions of new, and the matching deletes, all end
+up in these, so these are all that need replacing. Anything aligned past
+what malloc gives (like a SIMD batch) goes through the align_val_t ones,
+which need their own allocator - aligned_alloc only takes sizes that are
+a multiple of the alignment, and MSVC doesn't have it at all.
+*/
+void* operator new(std::size_t size) {
+	CountAllocation();
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	CountAllocation();
+	std::size_t align = (std::size_t)alignment;
+	size = size ? (size + align - 1) & ~(align - 1) : align;
+#ifdef _WIN32
+	void* p = _aligned_malloc(size, align);
+#else
+	void* p = std::aligned_alloc(align, size);
+#endif
+	if (p) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(p, alignment);
+}
+#endif
+
+PhysicsProfiler::PhysicsProfiler() {
+	firstPoint			= std::chrono::high_resolution_clock::now();
+	frameStart			= 0.0;
+	frameAllocations	= 0;
+	recording			= false;
+	for (double& t : phaseStarts) {
+		t = 0.0;
+	}
+	lastFrame = {};
+	Reset();
+}
+
+PhysicsProfiler::~PhysicsProfiler() {
+}
+
+double PhysicsProfiler::GetTime() const {
+	std::chrono::duration<double, std::milli> diff = std::chrono::high_resolution_clock::now() - firstPoint;
+	return diff.count();
+}
+
+long long PhysicsProfiler::GetAllocationCount() {
+#ifdef PHYSICS_PROFILE_ALLOCATIONS
+	return allocationCount.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+void PhysicsProfiler::Reset() {
+	frameCount	= 0;
+	current		= {};
+	totals		= {};
+}
+
+void PhysicsProfiler::BeginFrame() {
+	current				= {};
+	current.frame		= frameCount;
+	frameAllocations	= GetAllocationCount();
+	frameStart			= GetTime();
+	current.startTime	= frameStart;
+}
+
+void PhysicsProfiler::EndFrame() {
+	current.totalTime = (float)(GetTime() - frameStart);
+	current.counts[Allocations] = (int)(GetAllocationCount() - frameAllocations);
+
+	lastFrame = current;
+
+	totals.frame		= ++frameCount;
+	totals.totalTime	+= current.totalTime;
+	for (int i = 0; i < MaxPhases; ++i) {
+		totals.phaseTimes[i] += current.phaseTimes[i];
+	}
+	for (int i = 0; i < MaxCounters; ++i) {
+		totals.counts[i] += current.counts[i];
+	}
+
+	if (recording) {
+		recordedFrames.push_back(current);
+	}
+}
+
+void PhysicsProfiler::BeginPhase(Phase p) {
+	phaseStarts[p] = GetTime();
+}
+
+void PhysicsProfiler::EndPhase(Phase p) {
+	float duration = (float)(GetTime() - phaseStarts[p]);
+	current.phaseTimes[p] += duration;
+
+	if (recording) {
+		ignoreAllocations = true;
+		recordedPhases.push_back({ p, phaseStarts[p], duration });
+		ignoreAllocations = false;
+	}
+}
+
+void PhysicsProfiler::StartRecording() {
+	recording = true;
+}
+
+void PhysicsProfiler::StopRecording() {
+	recording = false;
+}
+
+void PhysicsProfiler::ClearRecording() {
+	recordedFrames.clear();
+	recordedPhases.clear();
+}
+
+const char* PhysicsProfiler::GetPhaseName(Phase p) {
+	switch (p) {
+		case SyncBodies:			return "SyncBodies";
+		case IntegrateAccel:		return "IntegrateAccel";
+		case BroadPhase:			return "BroadPhase";
+		case NarrowPhase:			return "NarrowPhase";
+		case BuildIslands:			return "BuildIslands";
+		case SolveConstraints:		return "SolveConstraints";
+		case IntegrateVelocity:		return "IntegrateVelocity";
+		case UpdateSleep:			return "UpdateSleep";
+		case UpdateCollisionList:	return "UpdateCollisionList";
+		default:					return "Unknown";
+	}
+}
+
+const char* PhysicsProfiler::GetCounterName(Counter c) {
+	switch (c) {
+		case Steps:				return "Steps";
+		case BroadphasePairs:	return "BroadphasePairs";
+		case Contacts:			return "Contacts";
+		case Manifolds:			return "Manifolds";
+		case Islands:			return "Islands";
+		case AwakeBodies:		return "AwakeBodies";
+		case Allocations:		return "Allocations";
+		default:				return "Unknown";
+	}
+}
+
+bool PhysicsProfiler::WriteCSV(const std::string& filename) const {
+	std::ofstream file(filename);
+	if (!file) {
+		return false;
+	}
+	file << "Frame,StartTime,TotalTime";
+	for (int i = 0; i < MaxPhases; ++i) {
+		file << "," << GetPhaseName((Phase)i);
+	}
+	for (int i = 0; i < MaxCounters; ++i) {
+		file << "," << GetCounterName((Counter)i);
+	}
+	file << "\n" << std::fixed << std::setprecision(4);
+
+	for (const Frame& f : recordedFrames) {
+		file << f.frame << "," << f.startTime << "," << f.totalTime;
+		for (int i = 0; i < MaxPhases; ++i) {
+			file << "," << f.phaseTimes[i];
+		}
+		for (int i = 0; i < MaxCounters; ++i) {
+			file << "," << f.counts[i];
+		}
+		file << "\n";
+	}
+	return file.good();
+}
+
+/*
+The Trace Event Format - each Update and each phase is a complete ("X")
+event, and the tracer nests the phases inside their Update as they're all
+on the same thread. The counts are counter ("C") events, which show up
+as a graph underneath. Times are in microseconds.
+*/
+bool PhysicsProfiler::WriteChromeTrace(const std::string& filename) const {
+	std::ofstream file(filename);
+	if (!file) {
+		return false;
+	}
+	file << "{\"traceEvents\":[\n" << std::fixed << std::setprecision(3);
+
+	bool first = true;
+	auto beginEvent = [&]() -> std::ofstream& {
+		file << (first ? "" : ",\n");
+		first = false;
+		return file;
+	};
+
+	for (const Frame& f : recordedFrames) {
+		beginEvent() << "{\"name\":\"PhysicsSystem::Update\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+			<< ",\"ts\":" << f.startTime * 1000.0 << ",\"dur\":" << f.totalTime * 1000.0
+			<< ",\"args\":{\"frame\":" << f.frame << "}}";
+
+		beginEvent() << "{\"name\":\"Physics\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":" << f.startTime * 1000.0 << ",\"args\":{";
+		for (int i = 0; i < MaxCounters; ++i) {
+			file << (i ? "," : "") << "\"" << GetCounterName((Counter)i) << "\":" << f.counts[i];
+		}
+		file << "}}";
+	}
+	for (const PhaseEvent& e : recordedPhases) {
+		beginEvent() << "{\"name\":\"" << GetPhaseName(e.phase) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+			<< ",\"ts\":" << e.startTime * 1000.0 << ",\"dur\":" << e.duration * 1000.0 << "}";
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return file.good();
+}
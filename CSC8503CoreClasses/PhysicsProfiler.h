@@ -0,0 +1,137 @@
+#pragma once
+#include "GameTimer.h"
+#include <string>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Times each phase of the PhysicsSystem's Update, and counts how much
+		work each one had to do, so that it's possible to see where the time
+		is going without attaching a profiler.
+
+		Every Update is one frame - its phase times are added up over however
+		many steps it took, and Steps says how many that was. The counts are
+		added up over the steps too, apart from Manifolds, Islands and
+		AwakeBodies, which are how things stood at the end of the last step.
+
+		The last frame, and the totals since the last Reset, are always kept.
+		While recording, every frame and every phase is kept as well, so they
+		can be written out afterwards - as a CSV with a row per frame, or as a
+		trace that can be opened in chrome://tracing (or Perfetto) to see each
+		phase of each step on a timeline.
+
+		Allocations are only counted if PHYSICS_PROFILE_ALLOCATIONS is defined
+		when building PhysicsProfiler.cpp (the CSC8503_PROFILE_ALLOCATIONS
+		CMake option) - that replaces the global operator new, so it counts
+		everything allocated while the Update runs, on any thread, apart from
+		the profiler's own recording. Otherwise they're always 0.
+		*/
+		class PhysicsProfiler {
+		public:
+			enum Phase {
+				SyncBodies,
+				IntegrateAccel,
+				BroadPhase,
+				NarrowPhase,
+				BuildIslands,
+				SolveConstraints,
+				IntegrateVelocity,
+				UpdateSleep,
+				UpdateCollisionList,
+				MaxPhases
+			};
+
+			enum Counter {
+				Steps,
+				BroadphasePairs,
+				Contacts,
+				Manifolds,
+				Islands,
+				AwakeBodies,
+				Allocations,
+				MaxCounters
+			};
+
+			struct Frame {
+				int		frame;
+				double	startTime;	//In milliseconds, since the profiler was made
+				float	totalTime;	//Every time is in milliseconds
+				float	phaseTimes[MaxPhases];
+				int		counts[MaxCounters];
+			};
+
+			PhysicsProfiler();
+			~PhysicsProfiler();
+
+			void BeginFrame();
+			void EndFrame();
+
+			void BeginPhase(Phase p);
+			void EndPhase(Phase p);
+
+			void AddCount(Counter c, int count) {
+				current.counts[c] += count;
+			}
+
+			void SetCount(Counter c, int count) {
+				current.counts[c] = count;
+			}
+
+			const Frame& GetLastFrame() const {
+				return lastFrame;
+			}
+
+			//Every frame since the last Reset added together - frame is how many there were
+			const Frame& GetTotals() const {
+				return totals;
+			}
+
+			void Reset();
+
+			void StartRecording();
+			void StopRecording();
+			void ClearRecording();
+
+			bool IsRecording() const {
+				return recording;
+			}
+
+			const std::vector<Frame>& GetRecordedFrames() const {
+				return recordedFrames;
+			}
+
+			bool WriteCSV(const std::string& filename) const;
+			bool WriteChromeTrace(const std::string& filename) const;
+
+			static const char* GetPhaseName(Phase p);
+			static const char* GetCounterName(Counter c);
+
+			//Always 0 unless PHYSICS_PROFILE_ALLOCATIONS is defined
+			static long long GetAllocationCount();
+
+		protected:
+			struct PhaseEvent {
+				Phase	phase;
+				double	startTime;
+				float	duration;
+			};
+
+			double GetTime() const;
+
+			Timepoint	firstPoint;
+			double		frameStart;
+			double		phaseStarts[MaxPhases];
+			long long	frameAllocations;
+
+			int		frameCount;
+			Frame	current;
+			Frame	lastFrame;
+			Frame	totals;
+
+			bool					recording;
+			std::vector<Frame>		recordedFrames;
+			std::vector<PhaseEvent>	recordedPhases;
+		};
+	}
+}
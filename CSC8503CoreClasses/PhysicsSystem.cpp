@@ -7,8 +7,9 @@
 #include "Constraint.h"
 
 #include "Debug.h"
-#include "Window.h"
 #include <functional>
+#include <cmath>
+#include <algorithm>
 using namespace NCL;
 using namespace CSC8503;
 
@@ -18,8 +19,14 @@ PhysicsSystem::PhysicsSystem(GameWorld& g) : gameWorld(g)	{
 	applyGravity	= false;
 	useBroadPhase	= false;	
 	dTOffset		= 0.0f;
+	fixedDT			= 1.0f / 120.0f;
+	stepDT			= fixedDT;
 	globalDamping	= 0.995f;
 	SetGravity(Vector3(0.0f, -9.8f, 0.0f));
+
+	for (int i = 0; i < CollisionBatch::PairTypeCount; ++i) {
+		pairBatches.emplace_back((CollisionBatch::PairType)i);
+	}
 }
 
 PhysicsSystem::~PhysicsSystem()	{
@@ -40,109 +47,152 @@ any collisions they are in.
 
 */
 void PhysicsSystem::Clear() {
-	allCollisions.clear();
+	contactSolver.Clear();
+	bodies.Clear();
+	bodiesWorldStateID = -1;
+	allCollisions.Clear();
+	broadphaseCollisions.Clear();
+	dynamicTree.Clear();
+	treeProxies.clear();
+	treeWorldStateID = -1;
+	sweepAndPrune.Clear();
+	sweepProxies.clear();
+	sweepWorldStateID = -1;
 }
 
 /*
 
 This is the core of the physics engine update
 
-*/
-
-bool useSimpleContainer = false;
+The world is always moved forward in steps of exactly fixedDT, however long
+the frame took - frame time builds up in dTOffset, and a step is taken for
+each whole fixedDT of it. Two runs given the same frame times will then do
+exactly the same steps, which replays and networked games rely on.
 
-int constraintIterationCount = 10;
+If a frame took so long that catching up would take more than
+maxCatchUpSteps steps, the rest of the time is dropped instead - the game
+slows down for a moment, rather than every frame taking longer than the
+last as physics tries to catch up.
 
-//This is the fixed timestep we'd LIKE to have
-const int   idealHZ = 120;
-const float idealDT = 1.0f / idealHZ;
+Whatever time is left over in dTOffset is how far the world is into the
+next step, which is used to draw everything in between where it was
+before the last step and where it is now.
 
-/*
-This is the fixed update we actually have...
-If physics takes too long it starts to kill the framerate, it'll drop the 
-iteration count down until the FPS stabilises, even if that ends up
-being at a low rate. 
 */
-int realHZ		= idealHZ;
-float realDT	= idealDT;
-
 void PhysicsSystem::Update(float dt) {	
-	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::B)) {
-		useBroadPhase = !useBroadPhase;
-		std::cout << "Setting broadphase to " << useBroadPhase << std::endl;
+	dTOffset += dt; //We accumulate time delta here - there might be remainders from previous frame!
+
+	profiler.BeginFrame();
+
+	profiler.BeginPhase(PhysicsProfiler::SyncBodies);
+	SyncBodies();
+	if (useBroadPhase) {
+		UpdateObjectAABBs();
 	}
-	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::N)) {
-		useSimpleContainer = !useSimpleContainer;
-		std::cout << "Setting broad container to " << useSimpleContainer << std::endl;
+	profiler.EndPhase(PhysicsProfiler::SyncBodies);
+
+	int stepCount = 0;
+	while (dTOffset >= stepDT && stepCount < maxCatchUpSteps) {
+		Step(stepDT);
+		dTOffset -= stepDT;
+		stepCount++;
 	}
-	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::I)) {
-		constraintIterationCount--;
-		std::cout << "Setting constraint iterations to " << constraintIterationCount << std::endl;
+	if (dTOffset >= stepDT) {
+		dTOffset = std::fmod(dTOffset, stepDT);
+#ifdef PHYSICS_DEBUG
+		std::cout << "Physics fell too far behind, dropping time\n";
+#endif
 	}
-	if (Window::GetKeyboard()->KeyPressed(KeyboardKeys::O)) {
-		constraintIterationCount++;
-		std::cout << "Setting constraint iterations to " << constraintIterationCount << std::endl;
+	bodies.SetRenderAlpha(dTOffset / stepDT);
+	if (stepCount > 0) {
+		gameWorld.ObjectsMoved();
 	}
 
-	dTOffset += dt; //We accumulate time delta here - there might be remainders from previous frame!
+	ClearForces();	//Once we've finished with the forces, reset them to zero
 
-	GameTimer t;
-	t.GetTimeDeltaSeconds();
+	profiler.BeginPhase(PhysicsProfiler::UpdateCollisionList);
+	UpdateCollisionList(); //Remove any old collisions
+	profiler.EndPhase(PhysicsProfiler::UpdateCollisionList);
 
-	if (useBroadPhase) {
-		UpdateObjectAABBs();
+	profiler.EndFrame();
+
+	if (adaptiveTimestep) {
+		AdaptTimestep(dt, profiler.GetLastFrame().totalTime / 1000.0f);
 	}
-	int iteratorCount = 0;
-	while(dTOffset > realDT) {
-		IntegrateAccel(realDT); //Update accelerations from external forces
-		if (useBroadPhase) {
-			BroadPhase();
-			NarrowPhase();
-		}
-		else {
-			BasicCollisionDetection();
-		}
+}
 
-		//This is our simple iterative solver - 
-		//we just run things multiple times, slowly moving things forward
-		//and then rechecking that the constraints have been met		
-		float constraintDt = realDT /  (float)constraintIterationCount;
-		for (int i = 0; i < constraintIterationCount; ++i) {
-			UpdateConstraints(constraintDt);	
-		}
-		IntegrateVelocity(realDT); //update positions from new velocity changes
+void PhysicsSystem::Step(float dt) {
+	bodies.SavePreviousState();
+	profiler.AddCount(PhysicsProfiler::Steps, 1);
+
+	profiler.BeginPhase(PhysicsProfiler::IntegrateAccel);
+	IntegrateAccel(dt); //Update accelerations from external forces
+	profiler.EndPhase(PhysicsProfiler::IntegrateAccel);
 
-		dTOffset -= realDT;
-		iteratorCount++;
+	if (useBroadPhase) {
+		profiler.BeginPhase(PhysicsProfiler::BroadPhase);
+		BroadPhase();
+		profiler.EndPhase(PhysicsProfiler::BroadPhase);
+		profiler.AddCount(PhysicsProfiler::BroadphasePairs, broadphaseCollisions.GetPairCount());
+
+		profiler.BeginPhase(PhysicsProfiler::NarrowPhase);
+		NarrowPhase();
+		profiler.EndPhase(PhysicsProfiler::NarrowPhase);
+	}
+	else {
+		profiler.BeginPhase(PhysicsProfiler::NarrowPhase);
+		BasicCollisionDetection();
+		profiler.EndPhase(PhysicsProfiler::NarrowPhase);
 	}
 
-	ClearForces();	//Once we've finished with the forces, reset them to zero
+	//Contacts and constraints are solved island by island, and resting islands are put to sleep
+	profiler.BeginPhase(PhysicsProfiler::BuildIslands);
+	BuildIslands();
+	profiler.EndPhase(PhysicsProfiler::BuildIslands);
 
-	UpdateCollisionList(); //Remove any old collisions
+	profiler.BeginPhase(PhysicsProfiler::SolveConstraints);
+	contactSolver.PreSolve(dt);
+	SolveIslands(dt);
+	profiler.EndPhase(PhysicsProfiler::SolveConstraints);
+
+	profiler.BeginPhase(PhysicsProfiler::IntegrateVelocity);
+	IntegrateVelocity(dt); //update positions from new velocity changes
+	profiler.EndPhase(PhysicsProfiler::IntegrateVelocity);
 
-	t.Tick();
-	float updateTime = t.GetTimeDeltaSeconds();
+	profiler.BeginPhase(PhysicsProfiler::SolveConstraints);
+	contactSolver.ApplyLateBounces();
+	profiler.EndPhase(PhysicsProfiler::SolveConstraints);
 
+	profiler.BeginPhase(PhysicsProfiler::UpdateSleep);
+	UpdateSleep(dt);
+	profiler.EndPhase(PhysicsProfiler::UpdateSleep);
+
+	profiler.SetCount(PhysicsProfiler::Manifolds,	contactSolver.GetManifoldCount());
+	profiler.SetCount(PhysicsProfiler::Islands,		islands.GetIslandCount());
+	profiler.SetCount(PhysicsProfiler::AwakeBodies, bodies.GetAwakeCount());
+}
+
+/*
+The old way of stepping, for when keeping the frame rate up matters more
+than the simulation being repeatable...
+If physics takes too long it starts to kill the framerate, so it'll make
+the steps longer until the FPS stabilises, even if that ends up being at
+a low rate, and then shorten them back down to fixedDT when there's time.
+*/
+void PhysicsSystem::AdaptTimestep(float dt, float updateTime) {
 	//Uh oh, physics is taking too long...
-	if (updateTime > realDT) {
-		realHZ /= 2;
-		realDT *= 2;
+	if (updateTime > stepDT) {
+		stepDT *= 2;
 #ifdef PHYSICS_DEBUG
-		std::cout << "Dropping iteration count due to long physics time...(now " << realHZ << ")\n";
+		std::cout << "Dropping iteration count due to long physics time...(now " << 1.0f / stepDT << ")\n";
 #endif
 	}
-	else if(dt*2 < realDT) { //we have plenty of room to increase iteration count!
-		int temp = realHZ;
-		realHZ *= 2;
-		realDT /= 2;
-
-		if (realHZ > idealHZ) {
-			realHZ = idealHZ;
-			realDT = idealDT;
-		}
-		if (temp != realHZ) {
+	else if (dt * 2 < stepDT) { //we have plenty of room to increase iteration count!
+		float temp = stepDT;
+		stepDT = std::max(stepDT / 2, fixedDT);
+		if (temp != stepDT) {
 #ifdef PHYSICS_DEBUG
-			std::cout << "Raising iteration count due to short physics time...(now " << realHZ << ")\n";
+			std::cout << "Raising iteration count due to short physics time...(now " << 1.0f / stepDT << ")\n";
 #endif
 		}
 	}
@@ -150,43 +200,89 @@ void PhysicsSystem::Update(float dt) {
 
 /*
 Later on we're going to need to keep track of collisions
-across multiple frames, so we store them in a set.
+across multiple frames, so we store them in a pair cache.
 
 The first time they are added, we tell the objects they are colliding.
 The frame they are to be removed, we tell them they're no longer colliding.
+Each pair is stamped with the collision frame it was added on, and is
+removed numCollisionFrames later - adding a pair that's already in the
+cache doesn't refresh its stamp.
+
+Rather than calling into the objects as we walk the cache, the events are
+gathered up first, and sent out together once the cache is done with, so
+the callbacks are free to do what they like to the world. Pairs are kept
+by handle, so an object that's been removed (or deleted) since - maybe by
+an earlier callback - is just skipped, rather than called into. Pairs with
+an object that's gone are dropped without any events.
 
 From this simple mechanism, we we build up gameplay interactions inside the
 OnCollisionBegin / OnCollisionEnd functions (removing health when hit by a 
 rocket launcher, gaining a point when the player hits the gold coin, and so on).
 */
 void PhysicsSystem::UpdateCollisionList() {
-	for (std::set<CollisionDetection::CollisionInfo>::iterator i = allCollisions.begin(); i != allCollisions.end(); ) {
-		if ((*i).framesLeft == numCollisionFrames) {
-			i->a->OnCollisionBegin(i->b);
-			i->b->OnCollisionBegin(i->a);
-			if (i->a->deleteOnTrigger || i->b->deleteOnTrigger) { i = allCollisions.erase(i); continue; }
-		}
-
-		CollisionDetection::CollisionInfo& in = const_cast<CollisionDetection::CollisionInfo&>(*i);
-		in.framesLeft--;
-		
-		if ((*i).framesLeft < 0){// && i->a != nullptr && i->b != nullptr) {
-			//std::cout << i->a;
-			i->a->OnCollisionEnd(i->b);
-			i->b->OnCollisionEnd(i->a);
-			i = allCollisions.erase(i);
+	collisionsBegun.clear();
+	collisionsEnded.clear();
+
+	for (int i = 0; i < allCollisions.GetSlotCount(); ++i) {
+		if (!allCollisions.IsSlotUsed(i)) {
+			continue;
+		}
+		GameObjectHandle handleA = allCollisions.GetHandleA(i);
+		GameObjectHandle handleB = allCollisions.GetHandleB(i);
+		GameObject* a = gameWorld.GetGameObject(handleA);
+		GameObject* b = gameWorld.GetGameObject(handleB);
+		if (!a || !b) {
+			allCollisions.Remove(i);
+			continue;
+		}
+		int age = collisionFrame - allCollisions.GetFrameStamp(i);
+
+		if (age == 0) {
+			collisionsBegun.emplace_back(handleA, handleB);
+			if (a->deleteOnTrigger || b->deleteOnTrigger) {
+				allCollisions.Remove(i);
+			}
+		}
+		else if (age >= numCollisionFrames) {
+			collisionsEnded.emplace_back(handleA, handleB);
+			allCollisions.Remove(i);
+		}
+	}
+	collisionFrame++;
+
+	//Looked up again before every call, as the last one might have removed either of them
+	auto send = [&](GameObjectHandle to, GameObjectHandle other, bool begun) {
+		GameObject* a = gameWorld.GetGameObject(to);
+		GameObject* b = gameWorld.GetGameObject(other);
+		if (!a || !b) {
+			return;
+		}
+		if (begun) {
+			a->OnCollisionBegin(b);
 		}
 		else {
-			++i;
+			a->OnCollisionEnd(b);
 		}
+	};
+	for (auto& [a, b] : collisionsBegun) {
+		send(a, b, true);
+		send(b, a, true);
+	}
+	for (auto& [a, b] : collisionsEnded) {
+		send(a, b, false);
+		send(b, a, false);
 	}
 }
 
+//Sleeping objects haven't moved, so their boxes are still right. Each object only writes its own box, so they're split across the pool
 void PhysicsSystem::UpdateObjectAABBs() {
-	gameWorld.OperateOnContents(
-		[](GameObject* g) {
-			g->UpdateBroadphaseAABB();
-		}
+	gameWorld.ParallelForEach<const CollisionVolume>(
+		[](GameObject* g, const CollisionVolume* /*volume*/) {
+			PhysicsObject* object = g->GetPhysicsObject();
+			if (object == nullptr || !object->IsAsleep()) {
+				g->UpdateBroadphaseAABB();
+			}
+		}, 256, &threadPool
 	);
 }
 
@@ -195,33 +291,27 @@ void PhysicsSystem::UpdateObjectAABBs() {
 This is how we'll be doing collision detection in tutorial 4.
 We step thorugh every pair of objects once (the inner for loop offset 
 ensures this), and determine whether they collide, and if so, add them
-to the collision set for later processing. The set will guarantee that
+to the collision cache for later processing. The cache will guarantee that
 a particular pair will only be added once, so objects colliding for
-multiple frames won't flood the set with duplicates.
+multiple frames won't flood the cache with duplicates.
 */
 void PhysicsSystem::BasicCollisionDetection() {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-	for (auto i = first; i != last; i++)
+	const std::vector<GameObject*>& objects = gameWorld.GetPhysicsComponents().GetOwners();
+	for (auto i = objects.begin(); i != objects.end(); i++)
 	{
-		if ((*i)->GetPhysicsObject() == nullptr) continue;
-
-
-		for (auto j = i + 1; j != last; j++)
+		for (auto j = i + 1; j != objects.end(); j++)
 		{
-			if ((*j)->GetPhysicsObject() == nullptr)continue;
+			if (IsAsleep(*i) && IsAsleep(*j) && !(*i)->isTrigger && !(*j)->isTrigger) continue;
 			CollisionDetection::CollisionInfo info;
 			if (CollisionDetection::ObjectIntersection(*i, *j, info)) {
+				profiler.AddCount(PhysicsProfiler::Contacts, 1);
 				if (!(*i)->isTrigger && !(*j)->isTrigger) {
-					NCL::VolumeType typeA = info.a->GetPhysicsObject()->GetCollisionVolume()->type;
-					NCL::VolumeType typeB = info.b->GetPhysicsObject()->GetCollisionVolume()->type;
-					//if (typeA == typeB && typeA == NCL::VolumeType::Sphere)ProjectionResolveCollision(*info.a, *info.b, point);
-					//else	ImpulseResolveCollision(*info.a, *info.b, point);
-					ImpulseResolveCollision(*info.a, *info.b, info.point);
+					contactSolver.AddContact(info);
 				}
-				info.framesLeft = numCollisionFrames;
-				allCollisions.insert(info);
+				allCollisions.Insert(info, collisionFrame);
+			}
+			else if (UsesContinuousCollision(*i) || UsesContinuousCollision(*j)) {
+				SweptCollision(*i, *j);
 			}
 
 		}
@@ -332,16 +422,54 @@ compare the collisions that we absolutely need to.
 
 */
 void PhysicsSystem::BroadPhase() {
-	broadphaseCollisions.clear();
+	broadphaseCollisions.Clear();
+	switch (broadPhaseContainer) {
+		case BroadPhaseContainer::QuadTree:		QuadTreeBroadPhase(); break;
+		case BroadPhaseContainer::DynamicTree:	PersistentBroadPhase(dynamicTree, treeProxies, treeWorldStateID); break;
+		case BroadPhaseContainer::SweepAndPrune:PersistentBroadPhase(sweepAndPrune, sweepProxies, sweepWorldStateID); break;
+	}
+}
+
+/*
+Which object of a pair is 'a' decides which way round the contacts are
+solved, so it has to come out the same every run - going by the address
+would depend on where the objects happened to be allocated. The world
+ID is handed out in the order objects are added, so use that instead.
+*/
+static void SetPairObjects(CollisionDetection::CollisionInfo& info, GameObject* a, GameObject* b) {
+	if (b->GetWorldID() < a->GetWorldID() || (b->GetWorldID() == a->GetWorldID() && b < a)) {
+		std::swap(a, b);
+	}
+	info.a = a;
+	info.b = b;
+}
+
+/*
+Objects using continuous collision get a box around everywhere they'll go
+this step, rather than just where they are, so anything they might pass
+through on the way is paired up with them.
+*/
+bool PhysicsSystem::GetBroadphaseBox(GameObject* object, Vector3& pos, Vector3& halfSizes) const {
+	if (!object->GetBroadphaseAABB(halfSizes)) {
+		return false;
+	}
+	pos = object->GetTransform().GetPosition();
+	if (UsesContinuousCollision(object)) {
+		Vector3 displacement = object->GetPhysicsObject()->GetLinearVelocity() * stepDT;
+		pos			+= displacement * 0.5f;
+		halfSizes	+= Vector3(std::abs(displacement.x), std::abs(displacement.y), std::abs(displacement.z)) * 0.5f;
+	}
+	return true;
+}
+
+void PhysicsSystem::QuadTreeBroadPhase() {
 	QuadTree<GameObject*> tree(Vector2(1024, 1024), 7, 6);
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-	for (auto i = first; i != last; i++)
+	const std::vector<GameObject*>& objects = gameWorld.GetCollisionComponents().GetOwners();
+	for (auto i = objects.begin(); i != objects.end(); i++)
 	{
+		Vector3 pos;
 		Vector3 halfSizes;
-		if (!(*i)->GetBroadphaseAABB(halfSizes))continue;
-		Vector3 pos = (*i)->GetTransform().GetPosition();
+		if (!GetBroadphaseBox(*i, pos, halfSizes))continue;
 		tree.Insert(*i, pos, halfSizes);
 	}
 	tree.OperateOnContents(
@@ -352,9 +480,8 @@ void PhysicsSystem::BroadPhase() {
 				for (auto j = std::next(i); j != data.end(); j++)
 				{
 					
-					info.a = std::min((*i).object, (*j).object);
-					info.b = std::max((*i).object, (*j).object);
-					broadphaseCollisions.insert(info);
+					SetPairObjects(info, (*i).object, (*j).object);
+					broadphaseCollisions.Insert(info, collisionFrame);
 					
 				}
 			}
@@ -362,65 +489,372 @@ void PhysicsSystem::BroadPhase() {
 	);
 }
 
+/*
+Unlike the quadtree, the dynamic tree and the sweep and prune lists are kept
+from one step to the next, so rather than inserting everything again we just
+tell them where each object is now. For the tree, most of the time an object
+is still inside its fat AABB, and nothing changes at all. Objects that have
+left the world since last time are found by comparing against the world's
+state counter, and pulled out.
+*/
+template<class Container>
+void PhysicsSystem::PersistentBroadPhase(Container& container, std::unordered_map<GameObject*, int>& proxies, int& worldStateID) {
+	const std::vector<GameObject*>& objects = gameWorld.GetCollisionComponents().GetOwners();
+	auto first	= objects.begin();
+	auto last	= objects.end();
+
+	if (worldStateID != gameWorld.GetWorldStateID()) {
+		std::unordered_map<GameObject*, int> liveProxies;
+		for (auto i = first; i != last; i++) {
+			auto proxy = proxies.find(*i);
+			if (proxy != proxies.end()) {
+				liveProxies.insert(*proxy);
+				proxies.erase(proxy);
+			}
+		}
+		std::vector<int> deadProxies;
+		for (auto& [object, proxy] : proxies) {
+			deadProxies.push_back(proxy);
+		}
+		std::sort(deadProxies.begin(), deadProxies.end()); //Same order every run
+		for (int proxy : deadProxies) {
+			container.DestroyProxy(proxy);
+		}
+		proxies.swap(liveProxies);
+		worldStateID = gameWorld.GetWorldStateID();
+	}
+
+	for (auto i = first; i != last; i++) {
+		Vector3 pos;
+		Vector3 halfSizes;
+		if (!GetBroadphaseBox(*i, pos, halfSizes))continue;
+
+		auto proxy = proxies.find(*i);
+		if (proxy == proxies.end()) {
+			proxies.emplace(*i, container.CreateProxy(*i, pos, halfSizes));
+			continue;
+		}
+		if (IsAsleep(*i)) {
+			continue;
+		}
+		Vector3 displacement;
+		if ((*i)->GetPhysicsObject()) {
+			displacement = (*i)->GetPhysicsObject()->GetLinearVelocity() * stepDT;
+		}
+		container.MoveProxy(proxy->second, pos, halfSizes, displacement);
+	}
+
+	CollisionDetection::CollisionInfo info;
+	container.OperateOnPairs(
+		[&](GameObject* a, GameObject* b) {
+			SetPairObjects(info, a, b);
+			broadphaseCollisions.Insert(info, collisionFrame);
+		}
+	);
+}
+
 /*
 
 The broadphase will now only give us likely collisions, so we can now go through them,
 and work out if they are truly colliding, and if so, add them into the main collision list
+
+The pairs are first sorted into a CollisionBatch per combination of volume
+types, so each batch can be run through one of the SIMD batched tests in
+CollisionDetection, several pairs at a time.
+
+Testing a pair doesn't change anything, so each batch is split up across the
+thread pool, with each chunk of pairs writing what it finds into its own
+contact buffer. Once they're all done, the buffers are gathered up in batch
+then chunk order, and handed to the contact solver on this thread - the
+chunks are contiguous runs of their batch, so that's the same order a single
+thread would have found them in, however many threads there are.
 */
 void PhysicsSystem::NarrowPhase() {
-	for (std::set<CollisionDetection::CollisionInfo>::iterator i = broadphaseCollisions.begin(); i != broadphaseCollisions.end(); i++)
-	{
-		CollisionDetection::CollisionInfo info = *i;
-		if (CollisionDetection::ObjectIntersection(info.a, info.b, info)) {
-			info.framesLeft = numCollisionFrames;
-			if (!info.a->isTrigger && !info.b->isTrigger) ImpulseResolveCollision(*info.a,*info.b, info.point);
-			allCollisions.insert(info);
+	for (CollisionBatch& batch : pairBatches) {
+		batch.Clear();
+	}
+	sweptPairs.clear();
+	for (int i = 0; i < broadphaseCollisions.GetSlotCount(); ++i) {
+		const CollisionDetection::CollisionInfo& info = broadphaseCollisions.GetInfo(i);
+		//Two sleeping objects can't have moved into each other - unless one's a trigger, which still wants to know they're there
+		if (IsAsleep(info.a) && IsAsleep(info.b) && !info.a->isTrigger && !info.b->isTrigger) {
+			continue;
+		}
+		if (UsesContinuousCollision(info.a) || UsesContinuousCollision(info.b)) {
+			sweptPairs.push_back(i);
+		}
+		bool swapped;
+		CollisionBatch::PairType type = CollisionBatch::GetPairType(info.a, info.b, swapped);
+		if (swapped) {
+			pairBatches[type].AddPair(info.b, info.a);
+		}
+		else {
+			pairBatches[type].AddPair(info.a, info.b);
+		}
+	}
+
+	newContacts.clear();
+	contactBuffers.resize(threadPool.GetThreadCount());
+	for (CollisionBatch& batch : pairBatches) {
+		for (auto& contacts : contactBuffers) {
+			contacts.clear();
+		}
+		threadPool.ParallelFor(batch.GetPairCount(), 64,
+			[&](int chunk, int begin, int end) {
+				CollisionDetection::BatchIntersection(batch, begin, end, contactBuffers[chunk]);
+			}
+		);
+		for (auto& contacts : contactBuffers) {
+			newContacts.insert(newContacts.end(), contacts.begin(), contacts.end());
 		}
 	}
+
+	profiler.AddCount(PhysicsProfiler::Contacts, (int)newContacts.size());
+	for (CollisionDetection::CollisionInfo& info : newContacts) {
+		if (!info.a->isTrigger && !info.b->isTrigger) contactSolver.AddContact(info);
+		allCollisions.Insert(info, collisionFrame);
+	}
+	SweptCollisionDetection();
+}
+
+bool PhysicsSystem::UsesContinuousCollision(GameObject* object) const {
+	PhysicsObject* physics = object->GetPhysicsObject();
+	return physics && physics->UsesContinuousCollision() && !physics->IsAsleep();
 }
 
 /*
-Integration of acceleration and velocity is split up, so that we can
-move objects multiple times during the course of a PhysicsUpdate,
-without worrying about repeated forces accumulating etc. 
+Something moving fast enough can be on one side of a thin wall at the end
+of one step, and the other side at the end of the next, without ever being
+seen touching it. Pairs with an object using continuous collision in them
+that the tests above didn't find touching are swept instead, from where
+they are to where they'll be by the end of the step. Anything they'll hit
+on the way gets a contact straight away, with the gap that's left, so the
+solver stops them when they get there - and triggers hear about it, even
+if the object would have gone right through.
+*/
+void PhysicsSystem::SweptCollisionDetection() {
+	if (sweptPairs.empty()) {
+		return;
+	}
+	//Contacts can come back the other way round to the broadphase pair, so try both
+	touchingPairs.assign(broadphaseCollisions.GetSlotCount(), false);
+	for (const CollisionDetection::CollisionInfo& info : newContacts) {
+		if (!UsesContinuousCollision(info.a) && !UsesContinuousCollision(info.b)) {
+			continue;
+		}
+		int slot = broadphaseCollisions.Find(info.a, info.b);
+		if (slot == CollisionPairCache::NullSlot) {
+			slot = broadphaseCollisions.Find(info.b, info.a);
+		}
+		if (slot != CollisionPairCache::NullSlot) {
+			touchingPairs[slot] = true;
+		}
+	}
+	for (int slot : sweptPairs) {
+		if (!touchingPairs[slot]) {
+			const CollisionDetection::CollisionInfo& info = broadphaseCollisions.GetInfo(slot);
+			SweptCollision(info.a, info.b);
+		}
+	}
+}
 
-This function will update both linear and angular acceleration,
-based on any forces that have been accumulated in the objects during
-the course of the previous game frame.
+void PhysicsSystem::SweptCollision(GameObject* a, GameObject* b) {
+	Vector3 displacement;
+	if (a->GetPhysicsObject()) {
+		displacement += a->GetPhysicsObject()->GetLinearVelocity() * stepDT;
+	}
+	if (b->GetPhysicsObject()) {
+		displacement -= b->GetPhysicsObject()->GetLinearVelocity() * stepDT;
+	}
+	CollisionDetection::CollisionInfo info;
+	if (CollisionDetection::SweptIntersection(a, b, displacement, info)) {
+		profiler.AddCount(PhysicsProfiler::Contacts, 1);
+		if (!a->isTrigger && !b->isTrigger) {
+			contactSolver.AddContact(info);
+		}
+		allCollisions.Insert(info, collisionFrame);
+	}
+}
+
+/*
+Every object with a PhysicsObject gets a body in the RigidBodyStore, which
+is what the integration functions below work on. Objects that have left
+the world are handed back their values and taken out of the store. Objects
+that are deleted take themselves out, in the PhysicsObject destructor.
+
+The damping values still belong to the GameObject, so they're copied into
+the store once per update, rather than looked up on every sub-step.
 */
-void PhysicsSystem::IntegrateAccel(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
+void PhysicsSystem::SyncBodies() {
+	if (bodiesWorldStateID != gameWorld.GetWorldStateID()) {
+		for (int b = bodies.GetBodyCount() - 1; b >= 0; --b) {
+			if (!gameWorld.Contains(bodies.GetOwner(b))) {
+				bodies.RemoveBody(b);
+			}
+		}
+		contactSolver.RemoveManifolds([&](GameObjectHandle h) { return gameWorld.GetGameObject(h) == nullptr; });
+		bodiesWorldStateID = gameWorld.GetWorldStateID();
+	}
 
-	for (auto i = first; i != last; i++) {
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)continue;
-		
-		float inverseMass = object->GetInverseMass();
-		Vector3 linearVel = object->GetLinearVelocity();
-		Vector3 force = object->GetForce();
-		Vector3 accel = force * inverseMass;
+	const ComponentSet<PhysicsObject*>& physicsObjects = gameWorld.GetPhysicsComponents();
+	for (int i = 0; i < physicsObjects.GetCount(); ++i) {
+		if (!physicsObjects.GetComponents()[i]->IsInBodyStore()) {
+			bodies.AddBody(physicsObjects.GetOwners()[i]);
+		}
+	}
 
-		if (applyGravity && inverseMass > 0) accel += gravity;
-		linearVel += accel * dt;
-		object->SetLinearVelocity(linearVel);
+	for (int b = 0; b < bodies.GetBodyCount(); ++b) {
+		bodies.linearDamping[b]		= bodies.owners[b]->linearDamping;
+		bodies.angularDamping[b]	= bodies.owners[b]->angularDamping;
+	}
+}
 
-		Vector3 torque = object->GetTorque();
-		Vector3 angVel = object->GetAngularVelocity();
+/*
+The integration loops themselves. They're kept in their own functions as
+compilers will only really trust __restrict on function parameters - without
+it, they have to assume every array might overlap every other one, and give
+up on vectorising.
+*/
+static void IntegrateLinearAccel(int count, float dt, float gravityX, float gravityY, float gravityZ,
+	float* __restrict velX, float* __restrict velY, float* __restrict velZ,
+	const float* __restrict forceX, const float* __restrict forceY, const float* __restrict forceZ,
+	const float* __restrict inverseMass, const float* __restrict gravityScale) {
+	for (int i = 0; i < count; ++i) {
+		float invMass	= inverseMass[i];
+		float gScale	= gravityScale[i];
+
+		velX[i] += (forceX[i] * invMass + gravityX * gScale) * dt;
+		velY[i] += (forceY[i] * invMass + gravityY * gScale) * dt;
+		velZ[i] += (forceZ[i] * invMass + gravityZ * gScale) * dt;
+	}
+}
+
+//World space inverse inertia is R * I * R^T, with R built from the orientation
+static void UpdateInertiaTensors(int count,
+	const float* __restrict orientX, const float* __restrict orientY, const float* __restrict orientZ, const float* __restrict orientW,
+	const float* __restrict invInertiaX, const float* __restrict invInertiaY, const float* __restrict invInertiaZ,
+	float* __restrict tensorXX, float* __restrict tensorYY, float* __restrict tensorZZ,
+	float* __restrict tensorXY, float* __restrict tensorXZ, float* __restrict tensorYZ) {
+	for (int i = 0; i < count; ++i) {
+		float x = orientX[i], y = orientY[i], z = orientZ[i], w = orientW[i];
+
+		float r00 = 1 - 2 * y * y - 2 * z * z;
+		float r01 = 2 * x * y - 2 * z * w;
+		float r02 = 2 * x * z + 2 * y * w;
+		float r10 = 2 * x * y + 2 * z * w;
+		float r11 = 1 - 2 * x * x - 2 * z * z;
+		float r12 = 2 * y * z - 2 * x * w;
+		float r20 = 2 * x * z - 2 * y * w;
+		float r21 = 2 * y * z + 2 * x * w;
+		float r22 = 1 - 2 * x * x - 2 * y * y;
+
+		float ix = invInertiaX[i], iy = invInertiaY[i], iz = invInertiaZ[i];
+
+		tensorXX[i] = r00 * r00 * ix + r01 * r01 * iy + r02 * r02 * iz;
+		tensorYY[i] = r10 * r10 * ix + r11 * r11 * iy + r12 * r12 * iz;
+		tensorZZ[i] = r20 * r20 * ix + r21 * r21 * iy + r22 * r22 * iz;
+		tensorXY[i] = r00 * r10 * ix + r01 * r11 * iy + r02 * r12 * iz;
+		tensorXZ[i] = r00 * r20 * ix + r01 * r21 * iy + r02 * r22 * iz;
+		tensorYZ[i] = r10 * r20 * ix + r11 * r21 * iy + r12 * r22 * iz;
+	}
+}
 
-		object->UpdateInertiaTensor();
+static void IntegrateAngularAccel(int count, float dt,
+	float* __restrict angVelX, float* __restrict angVelY, float* __restrict angVelZ,
+	const float* __restrict torqueX, const float* __restrict torqueY, const float* __restrict torqueZ,
+	const float* __restrict tensorXX, const float* __restrict tensorYY, const float* __restrict tensorZZ,
+	const float* __restrict tensorXY, const float* __restrict tensorXZ, const float* __restrict tensorYZ) {
+	for (int i = 0; i < count; ++i) {
+		float tx = torqueX[i], ty = torqueY[i], tz = torqueZ[i];
+		angVelX[i] += (tensorXX[i] * tx + tensorXY[i] * ty + tensorXZ[i] * tz) * dt;
+		angVelY[i] += (tensorXY[i] * tx + tensorYY[i] * ty + tensorYZ[i] * tz) * dt;
+		angVelZ[i] += (tensorXZ[i] * tx + tensorYZ[i] * ty + tensorZZ[i] * tz) * dt;
+	}
+}
 
-		Vector3 angAccel = object->GetInertiaTensor() * torque;
+static void IntegrateLinearVelocity(int count, float dt,
+	float* __restrict posX, float* __restrict posY, float* __restrict posZ,
+	float* __restrict velX, float* __restrict velY, float* __restrict velZ,
+	const float* __restrict linearDamping) {
+	for (int i = 0; i < count; ++i) {
+		posX[i] += velX[i] * dt;
+		posY[i] += velY[i] * dt;
+		posZ[i] += velZ[i] * dt;
+
+		float frameLinearDamping = 1 - (linearDamping[i] * dt);
+		velX[i] *= frameLinearDamping;
+		velY[i] *= frameLinearDamping;
+		velZ[i] *= frameLinearDamping;
+	}
+}
 
-		angVel += angAccel * dt;
-		object->SetAngularVelocity(angVel);
-		/*if ((*i)->GetWorldID() == 999) {
-			std::cout << "processing player torque\n";
-		}*/
+static void IntegrateAngularVelocity(int count, float dt,
+	float* __restrict orientX, float* __restrict orientY, float* __restrict orientZ, float* __restrict orientW,
+	float* __restrict angVelX, float* __restrict angVelY, float* __restrict angVelZ,
+	const float* __restrict angularDamping) {
+	for (int i = 0; i < count; ++i) {
+		//orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0) * orientation)
+		float ax = angVelX[i] * dt * 0.5f;
+		float ay = angVelY[i] * dt * 0.5f;
+		float az = angVelZ[i] * dt * 0.5f;
+		float x = orientX[i], y = orientY[i], z = orientZ[i], w = orientW[i];
+
+		float nx = x + (ax * w + ay * z - az * y);
+		float ny = y + (ay * w + az * x - ax * z);
+		float nz = z + (az * w + ax * y - ay * x);
+		float nw = w - (ax * x + ay * y + az * z);
+
+		//Only a small nudge from a unit quaternion, so it's never near zero length
+		float t = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+		orientX[i] = nx * t;
+		orientY[i] = ny * t;
+		orientZ[i] = nz * t;
+		orientW[i] = nw * t;
+
+		float frameAngularDamping = 1 - (angularDamping[i] * dt);
+		angVelX[i] *= frameAngularDamping;
+		angVelY[i] *= frameAngularDamping;
+		angVelZ[i] *= frameAngularDamping;
 	}
 }
 
+/*
+Integration of acceleration and velocity is split up, so that we can
+move objects multiple times during the course of a PhysicsUpdate,
+without worrying about repeated forces accumulating etc. 
+
+This function will update both linear and angular acceleration,
+based on any forces that have been accumulated in the objects during
+the course of the previous game frame.
+
+Both integration functions run straight over the body store's arrays,
+with no branches in their loops, so the compiler is free to do several
+bodies at once with SIMD instructions. Only the awake bodies are stepped -
+the store keeps them all at the front.
+*/
+void PhysicsSystem::IntegrateAccel(float dt) {
+	RigidBodyStore& b = bodies;
+	const int count = b.GetAwakeCount();
+
+	Vector3 g = applyGravity ? gravity : Vector3();
+	IntegrateLinearAccel(count, dt, g.x, g.y, g.z,
+		b.linVelX.data(), b.linVelY.data(), b.linVelZ.data(),
+		b.forceX.data(), b.forceY.data(), b.forceZ.data(),
+		b.inverseMass.data(), b.gravityScale.data());
+
+	UpdateInertiaTensors(count,
+		b.orientX.data(), b.orientY.data(), b.orientZ.data(), b.orientW.data(),
+		b.invInertiaX.data(), b.invInertiaY.data(), b.invInertiaZ.data(),
+		b.tensorXX.data(), b.tensorYY.data(), b.tensorZZ.data(),
+		b.tensorXY.data(), b.tensorXZ.data(), b.tensorYZ.data());
+
+	IntegrateAngularAccel(count, dt,
+		b.angVelX.data(), b.angVelY.data(), b.angVelZ.data(),
+		b.torqueX.data(), b.torqueY.data(), b.torqueZ.data(),
+		b.tensorXX.data(), b.tensorYY.data(), b.tensorZZ.data(),
+		b.tensorXY.data(), b.tensorXZ.data(), b.tensorYZ.data());
+}
+
 /*
 This function integrates linear and angular velocity into
 position and orientation. It may be called multiple times
@@ -428,40 +862,18 @@ throughout a physics update, to slowly move the objects through
 the world, looking for collisions.
 */
 void PhysicsSystem::IntegrateVelocity(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-
-	
-	for (auto i = first; i != last; i++)
-	{
-		float frameLinearDamping = 1 - ((*i)->linearDamping * dt);
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)continue;
-		Transform& transform = (*i)->GetTransform();
-		Vector3 pos = transform.GetPosition();
-		Vector3 linearVel = object->GetLinearVelocity();
-		pos += linearVel * dt;
-		transform.SetPosition(pos);
-		linearVel *= frameLinearDamping;
-		object->SetLinearVelocity(linearVel);
-
-		Quaternion orientation = transform.GetOrientation();
-		Vector3 angVel = object->GetAngularVelocity();
-
-		orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0) * orientation);
-		orientation.Normalise();
-		transform.SetOrientation(orientation);
-
-		
-
-		float frameAngularDamping = 1 - ((*i)->angularDamping * dt);
-		angVel *= frameAngularDamping;
-		object->SetAngularVelocity(angVel);
-		/*if ((*i)->GetWorldID() == 999) {
-			std::cout << "processing player angvel\n";
-		}*/
-	}
+	RigidBodyStore& b = bodies;
+	const int count = b.GetAwakeCount();
+
+	IntegrateLinearVelocity(count, dt,
+		b.posX.data(), b.posY.data(), b.posZ.data(),
+		b.linVelX.data(), b.linVelY.data(), b.linVelZ.data(),
+		b.linearDamping.data());
+
+	IntegrateAngularVelocity(count, dt,
+		b.orientX.data(), b.orientY.data(), b.orientZ.data(), b.orientW.data(),
+		b.angVelX.data(), b.angVelY.data(), b.angVelZ.data(),
+		b.angularDamping.data());
 }
 
 /*
@@ -470,11 +882,12 @@ clear out any accumulated forces, ready to receive new
 ones in the next 'game' frame.
 */
 void PhysicsSystem::ClearForces() {
-	gameWorld.OperateOnContents(
-		[](GameObject* o) {
-			if(o->GetPhysicsObject() != NULL)o->GetPhysicsObject()->ClearForces();
-		}
-	);
+	std::fill(bodies.forceX.begin(), bodies.forceX.end(), 0.0f);
+	std::fill(bodies.forceY.begin(), bodies.forceY.end(), 0.0f);
+	std::fill(bodies.forceZ.begin(), bodies.forceZ.end(), 0.0f);
+	std::fill(bodies.torqueX.begin(), bodies.torqueX.end(), 0.0f);
+	std::fill(bodies.torqueY.begin(), bodies.torqueY.end(), 0.0f);
+	std::fill(bodies.torqueZ.begin(), bodies.torqueZ.end(), 0.0f);
 }
 
 
@@ -484,13 +897,238 @@ As part of the final physics tutorials, we add in the ability
 to constrain objects based on some extra calculation, allowing
 us to model springs and ropes etc. 
 
+Contacts are solved island by island - islands don't share any moving
+objects, so they're split up across the thread pool. Constraints are
+sorted into batches by the constraint solver instead, as a long rope or
+bridge is all one island, but most of its links can still be solved at
+the same time. Each iteration runs the constraints, a batch at a time,
+then the contacts, so each gets to see what the other did.
+
+Constraints of a type the constraint solver doesn't know, or that don't
+say what objects they act on, could be touching anything, so they're
+run one at a time on this thread, before each iteration's batches. They
+might wake objects up too, so wakes are held until the end - moving a
+body into the awake run would move it out from under the batches.
+
 */
-void PhysicsSystem::UpdateConstraints(float dt) {
+void PhysicsSystem::SolveIslands(float dt) {
+	bodies.HoldWakes();
+	islands.Build(bodies.GetAwakeCount());
+	contactSolver.ForEachManifold(
+		[&](int manifold, GameObject* a, GameObject* b) {
+			int body = GetIslandBody(a, b);
+			if (body >= 0) {
+				islands.AddManifold(body, manifold);
+			}
+		}
+	);
+	islands.Finish();
+
+	solveIslands.clear();
+	for (int i = 0; i < islands.GetIslandCount(); ++i) {
+		if (islands.GetIsland(i).manifoldCount > 0) {
+			solveIslands.push_back(i);
+		}
+	}
+
 	std::vector<Constraint*>::const_iterator first;
 	std::vector<Constraint*>::const_iterator last;
 	gameWorld.GetConstraintIterators(first, last);
 
+	constraintSolver.Reset(bodies);
+	serialConstraints.clear();
 	for (auto i = first; i != last; ++i) {
-		(*i)->UpdateConstraint(dt);
+		GameObject* a;
+		GameObject* b;
+		(*i)->GetObjects(a, b);
+		if (a == nullptr || b == nullptr) {
+			serialConstraints.push_back(*i);
+			continue;
+		}
+		if (GetIslandBody(a, b) < 0) {
+			continue; //Asleep, or can't move
+		}
+		int bodyA = bodies.GetBody(a);
+		int bodyB = bodies.GetBody(b);
+		if (bodyA < 0 || bodyB < 0 || !constraintSolver.Add(*i, bodyA, bodyB)) {
+			serialConstraints.push_back(*i);
+		}
 	}
-}
\ No newline at end of file
+
+	float constraintDt = dt / (float)constraintIterationCount;
+	if (constraintSolver.IsEmpty() && serialConstraints.empty()) {
+		threadPool.ParallelFor((int)solveIslands.size(), 16,
+			[&](int /*chunk*/, int begin, int end) {
+				for (int i = begin; i < end; ++i) {
+					SolveIsland(solveIslands[i], constraintIterationCount);
+				}
+			}
+		);
+		bodies.ReleaseWakes();
+		return;
+	}
+	for (int iteration = 0; iteration < constraintIterationCount; ++iteration) {
+		for (Constraint* c : serialConstraints) {
+			c->UpdateConstraint(constraintDt);
+		}
+		for (int batch = 0; batch < constraintSolver.GetBatchCount(); ++batch) {
+			int size = constraintSolver.GetBatchSize(batch);
+			if (!constraintSolver.IsBatchParallel(batch)) {
+				constraintSolver.SolveBatch(batch, 0, size, constraintDt);
+				continue;
+			}
+			threadPool.ParallelFor(size, 64,
+				[&](int /*chunk*/, int begin, int end) {
+					constraintSolver.SolveBatch(batch, begin, end, constraintDt);
+				}
+			);
+		}
+		threadPool.ParallelFor((int)solveIslands.size(), 16,
+			[&](int /*chunk*/, int begin, int end) {
+				for (int i = begin; i < end; ++i) {
+					SolveIsland(solveIslands[i], 1);
+				}
+			}
+		);
+	}
+	//The solvers are done with their body indices, so anything the constraints woke can move over now
+	bodies.ReleaseWakes();
+}
+
+//This is our simple iterative solver - we just run things multiple times, rechecking that the constraints have been met
+void PhysicsSystem::SolveIsland(int i, int iterations) {
+	const IslandBuilder::Island& island = islands.GetIsland(i);
+	const int* manifolds = islands.GetManifolds() + island.firstManifold;
+
+	for (int iteration = 0; iteration < iterations; ++iteration) {
+		contactSolver.SolveVelocities(manifolds, island.manifoldCount);
+	}
+}
+
+bool PhysicsSystem::IsAsleep(GameObject* object) const {
+	PhysicsObject* physics = object->GetPhysicsObject();
+	return physics && physics->IsAsleep();
+}
+
+/*
+Objects that can't move don't join islands together - everything resting
+on the floor would otherwise end up in one big island, which could never
+sleep while anything on it was moving. A contact or constraint belongs to
+the island of whichever of its objects can move, or to none if neither is
+awake and movable.
+*/
+int PhysicsSystem::GetIslandBody(GameObject* a, GameObject* b) const {
+	for (GameObject* object : { a, b }) {
+		int body = bodies.GetBody(object);
+		if (body >= 0 && bodies.IsAwake(body) && bodies.GetInverseMass(body) > 0.0f) {
+			return body;
+		}
+	}
+	return -1;
+}
+
+void PhysicsSystem::JoinIslands() {
+	islands.Reset(bodies.GetBodyCount());
+
+	auto join = [&](GameObject* a, GameObject* b) {
+		int bodyA = bodies.GetBody(a);
+		int bodyB = bodies.GetBody(b);
+		if (bodyA >= 0 && bodyB >= 0 && bodies.GetInverseMass(bodyA) > 0.0f && bodies.GetInverseMass(bodyB) > 0.0f) {
+			islands.Join(bodyA, bodyB);
+		}
+	};
+	contactSolver.ForEachManifold(
+		[&](int /*manifold*/, GameObject* a, GameObject* b) {
+			join(a, b);
+		}
+	);
+
+	std::vector<Constraint*>::const_iterator first;
+	std::vector<Constraint*>::const_iterator last;
+	gameWorld.GetConstraintIterators(first, last);
+	for (auto i = first; i != last; ++i) {
+		GameObject* a;
+		GameObject* b;
+		(*i)->GetObjects(a, b);
+		if (a && b) {
+			join(a, b);
+		}
+	}
+}
+
+/*
+Anything joined to an awake object has to wake up too - a sleeping stack
+that's been hit is woken all the way up, not just where it was hit.
+*/
+bool PhysicsSystem::WakeIslands() {
+	const int count = bodies.GetBodyCount();
+	const int awake = bodies.GetAwakeCount();
+
+	std::vector<bool> awakeRoots(count, false);
+	for (int b = 0; b < awake; ++b) {
+		awakeRoots[islands.Find(b)] = true;
+	}
+
+	std::vector<GameObject*> waking;
+	for (int b = awake; b < count; ++b) {
+		if (!useSleeping || awakeRoots[islands.Find(b)]) {
+			waking.push_back(bodies.GetOwner(b));
+		}
+	}
+	for (GameObject* object : waking) {
+		bodies.WakeBody(bodies.GetBody(object));
+	}
+	return !waking.empty();
+}
+
+/*
+Waking bodies up moves them around in the body store, so if anything
+woke up, the bodies have to be joined up again from scratch.
+*/
+void PhysicsSystem::BuildIslands() {
+	JoinIslands();
+	if (WakeIslands()) {
+		JoinIslands();
+	}
+}
+
+/*
+Each body keeps track of how long it's been moving slowly. Once every body
+in an island has been slow for long enough, the whole island goes to sleep.
+The islands are the ones that were just solved, as nothing has joined or
+left them since.
+*/
+void PhysicsSystem::UpdateSleep(float dt) {
+	if (!useSleeping) {
+		return;
+	}
+	const float linearSq	= sleepLinearSpeed * sleepLinearSpeed;
+	const float angularSq	= sleepAngularSpeed * sleepAngularSpeed;
+
+	fallingAsleep.clear();
+	for (int i = 0; i < islands.GetIslandCount(); ++i) {
+		const IslandBuilder::Island& island = islands.GetIsland(i);
+		const int* islandBodies = islands.GetBodies() + island.firstBody;
+
+		float minSleepTime = FLT_MAX;
+		for (int j = 0; j < island.bodyCount; ++j) {
+			int body = islandBodies[j];
+			if (bodies.GetLinearVelocity(body).LengthSquared() > linearSq ||
+				bodies.GetAngularVelocity(body).LengthSquared() > angularSq) {
+				bodies.sleepTime[body] = 0.0f;
+			}
+			else {
+				bodies.sleepTime[body] += dt;
+			}
+			minSleepTime = std::min(minSleepTime, bodies.sleepTime[body]);
+		}
+		if (minSleepTime >= timeToSleep) {
+			for (int j = 0; j < island.bodyCount; ++j) {
+				fallingAsleep.push_back(bodies.GetOwner(islandBodies[j]));
+			}
+		}
+	}
+	for (GameObject* object : fallingAsleep) {
+		bodies.SleepBody(bodies.GetBody(object));
+	}
+}
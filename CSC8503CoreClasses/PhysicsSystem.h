@@ -1,8 +1,25 @@
 #pragma once
 #include "GameWorld.h"
+#include "DynamicAABBTree.h"
+#include "SweepAndPrune.h"
+#include "CollisionPairCache.h"
+#include "ThreadPool.h"
+#include "RigidBodyStore.h"
+#include "ContactSolver.h"
+#include "ConstraintSolver.h"
+#include "IslandBuilder.h"
+#include "PhysicsProfiler.h"
+#include <unordered_map>
+#include <algorithm>
 
 namespace NCL {
 	namespace CSC8503 {
+		enum class BroadPhaseContainer {
+			QuadTree,
+			DynamicTree,
+			SweepAndPrune
+		};
+
 		class PhysicsSystem	{
 		public:
 			PhysicsSystem(GameWorld& g);
@@ -21,17 +38,121 @@ namespace NCL {
 			}
 
 			void SetGravity(const Vector3& g);
+
+			void UseBroadPhase(bool state) {
+				useBroadPhase = state;
+			}
+
+			bool IsUsingBroadPhase() const {
+				return useBroadPhase;
+			}
+
+			void SetBroadPhaseContainer(BroadPhaseContainer c) {
+				broadPhaseContainer = c;
+			}
+
+			BroadPhaseContainer GetBroadPhaseContainer() const {
+				return broadPhaseContainer;
+			}
+
+			//The length of every physics step - the default is 120 steps a second
+			void SetFixedTimestep(float dt) {
+				fixedDT = dt;
+				stepDT	= dt;
+			}
+
+			float GetFixedTimestep() const {
+				return fixedDT;
+			}
+
+			//The most steps a single Update will take to catch up on a long frame
+			void SetMaxCatchUpSteps(int steps) {
+				maxCatchUpSteps = steps;
+			}
+
+			/*
+			Lets the step length grow when physics is taking too long, and
+			shrink back down when it can. Keeps the frame rate up on slow
+			machines, but the same frame times won't always give the same
+			results any more.
+			*/
+			void UseAdaptiveTimestep(bool state) {
+				adaptiveTimestep	= state;
+				stepDT				= fixedDT;
+			}
+
+			void SetConstraintIterationCount(int count) {
+				constraintIterationCount = std::max(count, 1);
+			}
+
+			int GetConstraintIterationCount() const {
+				return constraintIterationCount;
+			}
+
+			/*
+			Groups of touching objects that have all been moving slower than
+			the given speeds for timeToSleep seconds are put to sleep, and
+			skipped until something wakes them.
+			*/
+			void UseSleeping(bool state) {
+				useSleeping = state;
+			}
+
+			void SetSleepThresholds(float linearSpeed, float angularSpeed) {
+				sleepLinearSpeed	= linearSpeed;
+				sleepAngularSpeed	= angularSpeed;
+			}
+
+			void SetTimeToSleep(float t) {
+				timeToSleep = t;
+			}
+
+			/*
+			How long each phase of the last Update took, and how much it had
+			to do. Start recording to keep every frame, to write out later.
+			*/
+			PhysicsProfiler& GetProfiler() {
+				return profiler;
+			}
+
+			const PhysicsProfiler& GetProfiler() const {
+				return profiler;
+			}
+
+			//The threads physics splits its work across - free for anything else to use between updates
+			ThreadPool& GetThreadPool() {
+				return threadPool;
+			}
 		protected:
 			void BasicCollisionDetection();
 			void BroadPhase();
+			void QuadTreeBroadPhase();
+			template<class Container>
+			void PersistentBroadPhase(Container& container, std::unordered_map<GameObject*, int>& proxies, int& worldStateID);
 			void NarrowPhase();
 
+			bool GetBroadphaseBox(GameObject* object, Vector3& pos, Vector3& halfSizes) const;
+			bool UsesContinuousCollision(GameObject* object) const;
+			void SweptCollisionDetection();
+			void SweptCollision(GameObject* a, GameObject* b);
+
+			void Step(float dt);
+			void AdaptTimestep(float dt, float updateTime);
+
+			void SyncBodies();
 			void ClearForces();
 
 			void IntegrateAccel(float dt);
 			void IntegrateVelocity(float dt);
 
-			void UpdateConstraints(float dt);
+			bool IsAsleep(GameObject* object) const;
+			int  GetIslandBody(GameObject* a, GameObject* b) const;
+			void JoinIslands();
+			bool WakeIslands();
+			void BuildIslands();
+			void SolveIslands(float dt);
+			void SolveIsland(int island, int iterations);
+			void UpdateSleep(float dt);
 
 			void UpdateCollisionList();
 			void UpdateObjectAABBs();
@@ -47,11 +168,55 @@ namespace NCL {
 			float	dTOffset;
 			float	globalDamping;
 
-			std::set<CollisionDetection::CollisionInfo> allCollisions;
-			std::set<CollisionDetection::CollisionInfo> broadphaseCollisions;
-			std::vector<CollisionDetection::CollisionInfo> broadphaseCollisionsVec;
+			float	fixedDT;
+			float	stepDT;	//Only differs from fixedDT when the timestep is adaptive
+			int		maxCatchUpSteps				= 8;
+			bool	adaptiveTimestep			= false;
+			int		constraintIterationCount	= 10;
+
+			CollisionPairCache allCollisions;
+			CollisionPairCache broadphaseCollisions;
 			bool useBroadPhase		= true;
 			int numCollisionFrames	= 5;
+			int collisionFrame		= 0;
+
+			std::vector<std::pair<GameObjectHandle, GameObjectHandle>> collisionsBegun;
+			std::vector<std::pair<GameObjectHandle, GameObjectHandle>> collisionsEnded;
+
+			ContactSolver		contactSolver;
+			ConstraintSolver	constraintSolver;
+
+			IslandBuilder				islands;
+			std::vector<int>			solveIslands;		//The islands that have any contacts to solve
+			std::vector<Constraint*>	serialConstraints;	//Constraints the constraint solver can't batch
+			std::vector<GameObject*>	fallingAsleep;
+
+			bool	useSleeping			= true;
+			float	sleepLinearSpeed	= 0.05f;
+			float	sleepAngularSpeed	= 0.05f;
+			float	timeToSleep			= 0.5f;
+
+			RigidBodyStore	bodies;
+			int				bodiesWorldStateID = -1;
+
+			PhysicsProfiler profiler;
+
+			ThreadPool threadPool;
+			std::vector<std::vector<CollisionDetection::CollisionInfo>> contactBuffers;
+			std::vector<CollisionDetection::CollisionInfo>				newContacts;
+			std::vector<CollisionBatch>									pairBatches;
+			std::vector<int>											sweptPairs;		//Broadphase slots of the pairs that might need sweeping
+			std::vector<bool>											touchingPairs;	//Per broadphase slot, whether the narrowphase found it touching
+
+			BroadPhaseContainer broadPhaseContainer = BroadPhaseContainer::QuadTree;
+
+			DynamicAABBTree<GameObject*>			dynamicTree;
+			std::unordered_map<GameObject*, int>	treeProxies;
+			int										treeWorldStateID = -1;
+
+			SweepAndPrune<GameObject*>				sweepAndPrune;
+			std::unordered_map<GameObject*, int>	sweepProxies;
+			int										sweepWorldStateID = -1;
 		};
 	}
 }
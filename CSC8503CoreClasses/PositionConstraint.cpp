@@ -2,6 +2,7 @@
 //#include "../../Common/Vector3.h"
 #include "GameObject.h"
 #include "PhysicsObject.h"
+#include "RigidBodyStore.h"
 //#include "Debug.h"
 
 
@@ -10,7 +11,7 @@ using namespace NCL;
 using namespace Maths;
 using namespace CSC8503;
 
-PositionConstraint::PositionConstraint(GameObject* a, GameObject* b, float d)
+PositionConstraint::PositionConstraint(GameObject* a, GameObject* b, float d) : Constraint(ConstraintType::Position)
 {
 	objectA		= a;
 	objectB		= b;
@@ -76,3 +77,34 @@ void PositionConstraint::UpdateConstraint(float dt)	{
 	}*/
 
 }
+
+void PositionConstraint::Solve(RigidBodyStore& bodies, int bodyA, int bodyB, float distance, float dt) {
+	Vector3 relativePos = bodies.GetPosition(bodyA) - bodies.GetPosition(bodyB);
+	float currentDistance = relativePos.Length();
+	if (currentDistance <= distance) {
+		return;
+	}
+	float offset = distance - currentDistance;
+	Vector3 offsetDir = relativePos / currentDistance;
+
+	float inverseMassA = bodies.GetInverseMass(bodyA);
+	float inverseMassB = bodies.GetInverseMass(bodyB);
+
+	float constraintMass = inverseMassA + inverseMassB;
+	if (constraintMass > 0) {
+		Vector3 relativeVel = bodies.GetLinearVelocity(bodyA) - bodies.GetLinearVelocity(bodyB);
+
+		float velocityDot = Vector3::Dot(relativeVel, offsetDir);
+		float biasFactor = 0.01f;
+		float bias = -(biasFactor / dt) * offset;
+		float lambda = -(velocityDot + bias) / constraintMass;
+
+		//Bodies that can't move are never written to, so they can be shared between batches
+		if (inverseMassA > 0.0f) {
+			bodies.SetLinearVelocity(bodyA, bodies.GetLinearVelocity(bodyA) + offsetDir * (lambda * inverseMassA));
+		}
+		if (inverseMassB > 0.0f) {
+			bodies.SetLinearVelocity(bodyB, bodies.GetLinearVelocity(bodyB) - offsetDir * (lambda * inverseMassB));
+		}
+	}
+}
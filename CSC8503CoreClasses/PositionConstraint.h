@@ -5,6 +5,7 @@ using namespace NCL::Maths;
 namespace NCL {
 	namespace CSC8503 {
 		class GameObject;
+		class RigidBodyStore;
 
 		class PositionConstraint : public Constraint	{
 		public:
@@ -13,6 +14,22 @@ namespace NCL {
 
 			void UpdateConstraint(float dt) override;
 
+			void GetObjects(GameObject*& a, GameObject*& b) const override {
+				a = objectA;
+				b = objectB;
+			}
+
+			float GetDistance() const {
+				return distance;
+			}
+
+			/*
+			The same as UpdateConstraint, but working straight on two bodies
+			in a body store, so the PhysicsSystem can run lots of these in a
+			batch without looking each object up.
+			*/
+			static void Solve(RigidBodyStore& bodies, int bodyA, int bodyB, float distance, float dt);
+
 		protected:
 			GameObject* objectA;
 			GameObject* objectB;
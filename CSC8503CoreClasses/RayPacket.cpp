@@ -0,0 +1,66 @@
+#include "RayPacket.h"
+#include "CollisionDetection.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+Written the same way as RayBoxIntersection, step for step, rather than as a
+neater slab test, so that every lane accepts and rejects exactly the same
+rays it does, with the same distances.
+*/
+int CollisionDetection::RayBoxPacketIntersection(const RayPacket& rays, const Vector3& boxPos, const Vector3& boxSize, float* distances) {
+	Vector3 boxMin = boxPos - boxSize;
+	Vector3 boxMax = boxPos + boxSize;
+
+	const SimdFloat* origins[3]	= { &rays.originX, &rays.originY, &rays.originZ };
+	const SimdFloat* dirs[3]	= { &rays.dirX, &rays.dirY, &rays.dirZ };
+
+	SimdFloat zero(0.0f);
+	SimdFloat tVals[3];
+	for (int i = 0; i < 3; ++i) {
+		const SimdFloat& o = *origins[i];
+		const SimdFloat& d = *dirs[i];
+		tVals[i] = Select(d > zero, (SimdFloat(boxMin[i]) - o) / d,
+			Select(d < zero, (SimdFloat(boxMax[i]) - o) / d, SimdFloat(-1.0f)));
+	}
+	SimdFloat bestT = Max(Max(tVals[0], tVals[1]), tVals[2]);
+
+	SimdMask hit = (zero <= bestT);
+
+	const SimdFloat epsilon(0.0001f);
+	for (int i = 0; i < 3; ++i) {
+		SimdFloat intersection = *origins[i] + (*dirs[i] * bestT);
+		hit = hit & (SimdFloat(boxMin[i]) <= intersection + epsilon) & (intersection - epsilon <= SimdFloat(boxMax[i]));
+	}
+	int lanes = hit.GetBits() & rays.activeLanes;
+	if (lanes) {
+		bestT.Store(distances);
+	}
+	return lanes;
+}
+
+int CollisionDetection::RaySpherePacketIntersection(const RayPacket& rays, const Vector3& spherePos, float sphereRadius, float* distances) {
+	SimdFloat dirX = SimdFloat(spherePos.x) - rays.originX;
+	SimdFloat dirY = SimdFloat(spherePos.y) - rays.originY;
+	SimdFloat dirZ = SimdFloat(spherePos.z) - rays.originZ;
+
+	SimdFloat sphereProj = (dirX * rays.dirX) + (dirY * rays.dirY) + (dirZ * rays.dirZ);
+
+	SimdFloat pointX = rays.originX + (rays.dirX * sphereProj) - SimdFloat(spherePos.x);
+	SimdFloat pointY = rays.originY + (rays.dirY * sphereProj) - SimdFloat(spherePos.y);
+	SimdFloat pointZ = rays.originZ + (rays.dirZ * sphereProj) - SimdFloat(spherePos.z);
+
+	SimdFloat sphereDist	= Sqrt((pointX * pointX) + (pointY * pointY) + (pointZ * pointZ));
+	SimdFloat radius		= SimdFloat(sphereRadius);
+
+	SimdMask hit = (SimdFloat(0.0f) <= sphereProj) & (sphereDist <= radius);
+
+	int lanes = hit.GetBits() & rays.activeLanes;
+	if (lanes) {
+		//Lanes that missed can go negative here, but their distances are never looked at
+		SimdFloat offset = Sqrt(Max((radius * radius) - (sphereDist * sphereDist), SimdFloat(0.0f)));
+		(sphereProj - offset).Store(distances);
+	}
+	return lanes;
+}
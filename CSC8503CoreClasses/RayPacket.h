@@ -0,0 +1,70 @@
+#pragma once
+#include "Ray.h"
+#include "SimdFloat.h"
+#include <cfloat>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		Up to a SIMD register's worth of rays, stored a component at a time,
+		so one box or sphere can be tested against all of them at once.
+
+		Lanes past the number of rays loaded are filled in with a copy of the
+		first ray, so every lane always holds sensible numbers, but they're
+		left out of activeLanes, and nothing they hit is ever used.
+
+		maxDistance is kept per lane as plain floats, as it's shortened one
+		lane at a time as each ray finds something closer.
+		*/
+		struct RayPacket {
+			SimdFloat originX, originY, originZ;
+			SimdFloat dirX, dirY, dirZ;
+			SimdFloat invDirX, invDirY, invDirZ;
+
+			float	maxDistance[SimdFloat::Width];
+			int		activeLanes;
+
+			void Load(const Ray* const* rays, int count) {
+				float values[9][SimdFloat::Width];
+				for (int lane = 0; lane < SimdFloat::Width; ++lane) {
+					const Ray& r	= *rays[lane < count ? lane : 0];
+					Vector3 origin	= r.GetPosition();
+					Vector3 dir		= r.GetDirection();
+					for (int i = 0; i < 3; ++i) {
+						values[i][lane]		= origin[i];
+						values[i + 3][lane] = dir[i];
+						//Axis aligned rays would divide by zero - a huge number gives the same answers
+						values[i + 6][lane] = std::abs(dir[i]) > 1e-20f ? 1.0f / dir[i] : 1e30f;
+					}
+					maxDistance[lane] = FLT_MAX;
+				}
+				originX = SimdFloat::Load(values[0]);
+				originY = SimdFloat::Load(values[1]);
+				originZ = SimdFloat::Load(values[2]);
+				dirX	= SimdFloat::Load(values[3]);
+				dirY	= SimdFloat::Load(values[4]);
+				dirZ	= SimdFloat::Load(values[5]);
+				invDirX = SimdFloat::Load(values[6]);
+				invDirY = SimdFloat::Load(values[7]);
+				invDirZ = SimdFloat::Load(values[8]);
+
+				activeLanes = (1 << count) - 1;
+			}
+
+			//The lanes whose rays pass through the box somewhere between 0 and their maxDistance
+			int HitsBox(const Vector3& boxMin, const Vector3& boxMax) const {
+				SimdFloat x0 = (SimdFloat(boxMin.x) - originX) * invDirX;
+				SimdFloat x1 = (SimdFloat(boxMax.x) - originX) * invDirX;
+				SimdFloat y0 = (SimdFloat(boxMin.y) - originY) * invDirY;
+				SimdFloat y1 = (SimdFloat(boxMax.y) - originY) * invDirY;
+				SimdFloat z0 = (SimdFloat(boxMin.z) - originZ) * invDirZ;
+				SimdFloat z1 = (SimdFloat(boxMax.z) - originZ) * invDirZ;
+
+				SimdFloat tMin = Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), SimdFloat(0.0f)));
+				SimdFloat tMax = Min(Min(Max(x0, x1), Max(y0, y1)), Min(Max(z0, z1), SimdFloat::Load(maxDistance)));
+				return (tMin <= tMax).GetBits() & activeLanes;
+			}
+		};
+	}
+}
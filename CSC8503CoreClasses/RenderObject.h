@@ -1,6 +1,7 @@
 #pragma once
 #include "TextureBase.h"
 #include "ShaderBase.h"
+#include "ObjectPool.h"
 
 namespace NCL {
 	using namespace NCL::Rendering;
@@ -16,6 +17,14 @@ namespace NCL {
 			RenderObject(Transform* parentTransform, MeshGeometry* mesh, TextureBase* tex, ShaderBase* shader);
 			~RenderObject();
 
+			static void* operator new(size_t size) {
+				return ObjectPools::Allocate(PoolType::RenderObjects, size);
+			}
+
+			static void operator delete(void* p, size_t size) {
+				ObjectPools::Free(PoolType::RenderObjects, p, size);
+			}
+
 			void SetDefaultTexture(TextureBase* t) {
 				texture = t;
 			}
@@ -0,0 +1,201 @@
+#include "RigidBodyStore.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+#include "Maths.h"
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+RigidBodyStore::RigidBodyStore() {
+	awakeCount		= 0;
+	renderAlpha		= 1.0f;
+	holdingWakes	= false;
+}
+
+RigidBodyStore::~RigidBodyStore() {
+	Clear();
+}
+
+void RigidBodyStore::Clear() {
+	for (int i = 0; i < GetBodyCount(); ++i) {
+		CopyOut(i);
+	}
+	owners.clear();
+	ForEachArray([](std::vector<float>& a) { a.clear(); });
+	heldWakes.clear();
+	awakeCount = 0;
+}
+
+int RigidBodyStore::AddBody(GameObject* owner) {
+	int body = (int)owners.size();
+	owners.push_back(owner);
+	ForEachArray([](std::vector<float>& a) { a.push_back(0.0f); });
+
+	Transform&		transform	= owner->GetTransform();
+	PhysicsObject*	object		= owner->GetPhysicsObject();
+
+	SetPosition(body, transform.position);
+	SetOrientation(body, transform.orientation);
+
+	SetLinearVelocity(body, object->linearVelocity);
+	SetAngularVelocity(body, object->angularVelocity);
+	SetForce(body, object->force);
+	SetTorque(body, object->torque);
+	SetInverseMass(body, object->inverseMass);
+	SetInverseInertia(body, object->inverseInertia);
+	SetInertiaTensor(body, object->inverseInteriaTensor);
+
+	linearDamping[body]		= owner->linearDamping;
+	angularDamping[body]	= owner->angularDamping;
+
+	transform.bodyStore = this;
+	object->bodyStore	= this;
+	SetViewIndex(body);
+
+	//New bodies start off awake
+	WakeBody(body);
+	return object->bodyIndex;
+}
+
+void RigidBodyStore::RemoveBody(int body) {
+	//Move it to the end of the awake run first, so taking it out leaves both runs packed
+	if (body < awakeCount) {
+		awakeCount--;
+		SwapBodies(body, awakeCount);
+		body = awakeCount;
+	}
+	CopyOut(body);
+
+	int last = GetBodyCount() - 1;
+	if (body != last) {
+		owners[body] = owners[last];
+		ForEachArray([&](std::vector<float>& a) { a[body] = a[last]; });
+		SetViewIndex(body);
+	}
+	owners.pop_back();
+	ForEachArray([](std::vector<float>& a) { a.pop_back(); });
+}
+
+void RigidBodyStore::WakeBody(int body) {
+	if (body < awakeCount) {
+		return;
+	}
+	if (holdingWakes) {
+		heldWakes.push_back(owners[body]);
+		return;
+	}
+	SwapBodies(body, awakeCount);
+	sleepTime[awakeCount] = 0.0f;
+	awakeCount++;
+}
+
+void RigidBodyStore::ReleaseWakes() {
+	holdingWakes = false;
+	for (GameObject* owner : heldWakes) {
+		WakeBody(GetBody(owner));
+	}
+	heldWakes.clear();
+}
+
+void RigidBodyStore::SleepBody(int body) {
+	if (body >= awakeCount) {
+		return;
+	}
+	awakeCount--;
+	SwapBodies(body, awakeCount);
+	SetLinearVelocity(awakeCount, Vector3());
+	SetAngularVelocity(awakeCount, Vector3());
+	//It won't be stepped again to catch its previous state up, so it's drawn where it stopped
+	SetPosition(awakeCount, GetPosition(awakeCount));
+	SetOrientation(awakeCount, GetOrientation(awakeCount));
+}
+
+int RigidBodyStore::GetBody(const GameObject* owner) const {
+	const PhysicsObject* object = owner->GetPhysicsObject();
+	if (object == nullptr || object->bodyStore != this) {
+		return -1;
+	}
+	return object->bodyIndex;
+}
+
+void RigidBodyStore::SwapBodies(int a, int b) {
+	if (a == b) {
+		return;
+	}
+	std::swap(owners[a], owners[b]);
+	ForEachArray([&](std::vector<float>& v) { std::swap(v[a], v[b]); });
+	SetViewIndex(a);
+	SetViewIndex(b);
+}
+
+//Tells a body's views where it is in the store now
+void RigidBodyStore::SetViewIndex(int body) {
+	owners[body]->GetTransform().bodyIndex		= body;
+	owners[body]->GetPhysicsObject()->bodyIndex = body;
+}
+
+//Hands the body's current values back to its own objects, and cuts them loose
+void RigidBodyStore::CopyOut(int body) {
+	Transform&		transform	= owners[body]->GetTransform();
+	PhysicsObject*	object		= owners[body]->GetPhysicsObject();
+
+	transform.bodyStore = nullptr;
+	transform.bodyIndex = -1;
+	transform.position		= GetPosition(body);
+	transform.orientation	= GetOrientation(body);
+	transform.UpdateMatrix();
+
+	object->bodyStore = nullptr;
+	object->bodyIndex = -1;
+	object->linearVelocity			= GetLinearVelocity(body);
+	object->angularVelocity			= GetAngularVelocity(body);
+	object->force					= GetForce(body);
+	object->torque					= GetTorque(body);
+	object->inverseMass				= GetInverseMass(body);
+	object->inverseInertia			= GetInverseInertia(body);
+	object->inverseInteriaTensor	= GetInertiaTensor(body);
+}
+
+Vector3 RigidBodyStore::GetRenderPosition(int body) const {
+	Vector3 previous(prevPosX[body], prevPosY[body], prevPosZ[body]);
+	return Maths::Lerp(previous, GetPosition(body), renderAlpha);
+}
+
+//A normalised lerp is close enough to a slerp over a single step
+Quaternion RigidBodyStore::GetRenderOrientation(int body) const {
+	Quaternion previous(prevOrientX[body], prevOrientY[body], prevOrientZ[body], prevOrientW[body]);
+	Quaternion q = Quaternion::Lerp(previous, GetOrientation(body), renderAlpha);
+	q.Normalise();
+	return q;
+}
+
+void RigidBodyStore::SavePreviousState() {
+	std::copy(posX.begin(), posX.begin() + awakeCount, prevPosX.begin());
+	std::copy(posY.begin(), posY.begin() + awakeCount, prevPosY.begin());
+	std::copy(posZ.begin(), posZ.begin() + awakeCount, prevPosZ.begin());
+	std::copy(orientX.begin(), orientX.begin() + awakeCount, prevOrientX.begin());
+	std::copy(orientY.begin(), orientY.begin() + awakeCount, prevOrientY.begin());
+	std::copy(orientZ.begin(), orientZ.begin() + awakeCount, prevOrientZ.begin());
+	std::copy(orientW.begin(), orientW.begin() + awakeCount, prevOrientW.begin());
+}
+
+Matrix3 RigidBodyStore::GetInertiaTensor(int body) const {
+	Matrix3 m;
+	m.array[0][0] = tensorXX[body];
+	m.array[1][1] = tensorYY[body];
+	m.array[2][2] = tensorZZ[body];
+	m.array[0][1] = m.array[1][0] = tensorXY[body];
+	m.array[0][2] = m.array[2][0] = tensorXZ[body];
+	m.array[1][2] = m.array[2][1] = tensorYZ[body];
+	return m;
+}
+
+void RigidBodyStore::SetInertiaTensor(int body, const Matrix3& m) {
+	tensorXX[body] = m.array[0][0];
+	tensorYY[body] = m.array[1][1];
+	tensorZZ[body] = m.array[2][2];
+	tensorXY[body] = m.array[0][1];
+	tensorXZ[body] = m.array[0][2];
+	tensorYZ[body] = m.array[1][2];
+}
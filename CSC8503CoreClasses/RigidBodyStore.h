@@ -0,0 +1,223 @@
+#pragma once
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "Matrix3.h"
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameObject;
+		class PhysicsObject;
+		class PhysicsSystem;
+
+		/*
+		Holds the state the physics integration works on - positions,
+		orientations, velocities, forces, masses and inertia - for every body
+		in a PhysicsSystem, with each component of each value in its own
+		contiguous float array. The integration loops can then step straight
+		through memory, a few bodies per SIMD register, instead of hopping
+		from GameObject to PhysicsObject to Transform for each one.
+
+		While an object is in the store, its Transform and PhysicsObject stop
+		using their own copies of these values and read and write the store
+		instead, so everything else can carry on using them as before. When
+		an object leaves the store, its current values are copied back out.
+
+		Bodies are kept packed - removing one moves the last body into its
+		place, and that body's views are told their new index.
+
+		They're also kept in two runs - every awake body comes before every
+		sleeping one - so the integration loops can just stop at
+		GetAwakeCount(), and skip sleeping bodies without checking each one.
+		Waking or sleeping a body swaps it over the boundary between them.
+		*/
+		class RigidBodyStore {
+		public:
+			RigidBodyStore();
+			~RigidBodyStore();
+
+			//Detaches every body, leaving their values in their own objects
+			void Clear();
+
+			int  AddBody(GameObject* owner);
+			void RemoveBody(int body);
+
+			int GetBodyCount() const {
+				return (int)owners.size();
+			}
+
+			int GetAwakeCount() const {
+				return awakeCount;
+			}
+
+			bool IsAwake(int body) const {
+				return body < awakeCount;
+			}
+
+			void WakeBody(int body);
+			//Sleeping bodies are stopped dead, so they're still stopped when they wake up
+			void SleepBody(int body);
+
+			/*
+			The solvers work out where every body they'll touch is before they
+			start, so nothing they run (like a custom constraint pushing a
+			sleeping object) can move bodies between the runs until they're
+			done. While wakes are held, a body that's woken stays where it is,
+			and is only moved over to the awake run by ReleaseWakes.
+			*/
+			void HoldWakes() {
+				holdingWakes = true;
+			}
+			void ReleaseWakes();
+
+			//The body owner has in this store, or -1 if it isn't in it
+			int GetBody(const GameObject* owner) const;
+
+			GameObject* GetOwner(int body) const {
+				return owners[body];
+			}
+
+			Vector3 GetPosition(int body) const {
+				return Vector3(posX[body], posY[body], posZ[body]);
+			}
+			//Moves the body straight there, rather than it being drawn moving there from where it was
+			void SetPosition(int body, const Vector3& v) {
+				posX[body] = v.x; posY[body] = v.y; posZ[body] = v.z;
+				prevPosX[body] = v.x; prevPosY[body] = v.y; prevPosZ[body] = v.z;
+			}
+
+			Quaternion GetOrientation(int body) const {
+				return Quaternion(orientX[body], orientY[body], orientZ[body], orientW[body]);
+			}
+			void SetOrientation(int body, const Quaternion& q) {
+				orientX[body] = q.x; orientY[body] = q.y; orientZ[body] = q.z; orientW[body] = q.w;
+				prevOrientX[body] = q.x; prevOrientY[body] = q.y; prevOrientZ[body] = q.z; prevOrientW[body] = q.w;
+			}
+
+			/*
+			Physics runs in fixed steps, which won't line up with the frames
+			being drawn - so bodies are drawn part of the way between where
+			they were before the last step and where they are now, by however
+			much of the next step has gone by. The renderer then never has to
+			wait for an extra step to be run just to have something to draw.
+			*/
+			Vector3		GetRenderPosition(int body) const;
+			Quaternion	GetRenderOrientation(int body) const;
+
+			void SetRenderAlpha(float a) {
+				renderAlpha = a;
+			}
+
+			//Remembers where every awake body is, before they're stepped again
+			void SavePreviousState();
+
+			Vector3 GetLinearVelocity(int body) const {
+				return Vector3(linVelX[body], linVelY[body], linVelZ[body]);
+			}
+			void SetLinearVelocity(int body, const Vector3& v) {
+				linVelX[body] = v.x; linVelY[body] = v.y; linVelZ[body] = v.z;
+			}
+
+			Vector3 GetAngularVelocity(int body) const {
+				return Vector3(angVelX[body], angVelY[body], angVelZ[body]);
+			}
+			void SetAngularVelocity(int body, const Vector3& v) {
+				angVelX[body] = v.x; angVelY[body] = v.y; angVelZ[body] = v.z;
+			}
+
+			Vector3 GetForce(int body) const {
+				return Vector3(forceX[body], forceY[body], forceZ[body]);
+			}
+			void SetForce(int body, const Vector3& v) {
+				forceX[body] = v.x; forceY[body] = v.y; forceZ[body] = v.z;
+			}
+
+			Vector3 GetTorque(int body) const {
+				return Vector3(torqueX[body], torqueY[body], torqueZ[body]);
+			}
+			void SetTorque(int body, const Vector3& v) {
+				torqueX[body] = v.x; torqueY[body] = v.y; torqueZ[body] = v.z;
+			}
+
+			float GetInverseMass(int body) const {
+				return inverseMass[body];
+			}
+			void SetInverseMass(int body, float m) {
+				inverseMass[body]	= m;
+				gravityScale[body]	= m > 0.0f ? 1.0f : 0.0f; //static objects don't fall
+			}
+
+			Vector3 GetInverseInertia(int body) const {
+				return Vector3(invInertiaX[body], invInertiaY[body], invInertiaZ[body]);
+			}
+			void SetInverseInertia(int body, const Vector3& v) {
+				invInertiaX[body] = v.x; invInertiaY[body] = v.y; invInertiaZ[body] = v.z;
+			}
+
+			Matrix3 GetInertiaTensor(int body) const;
+			void	SetInertiaTensor(int body, const Matrix3& m);
+
+		protected:
+			friend class PhysicsSystem;
+
+			template<class F>
+			void ForEachArray(F&& func) {
+				std::vector<float>* arrays[] = {
+					&posX, &posY, &posZ,
+					&orientX, &orientY, &orientZ, &orientW,
+					&prevPosX, &prevPosY, &prevPosZ,
+					&prevOrientX, &prevOrientY, &prevOrientZ, &prevOrientW,
+					&linVelX, &linVelY, &linVelZ,
+					&angVelX, &angVelY, &angVelZ,
+					&forceX, &forceY, &forceZ,
+					&torqueX, &torqueY, &torqueZ,
+					&inverseMass, &gravityScale,
+					&invInertiaX, &invInertiaY, &invInertiaZ,
+					&tensorXX, &tensorYY, &tensorZZ, &tensorXY, &tensorXZ, &tensorYZ,
+					&linearDamping, &angularDamping,
+					&sleepTime
+				};
+				for (std::vector<float>* a : arrays) {
+					func(*a);
+				}
+			}
+
+			void CopyOut(int body);
+			void SwapBodies(int a, int b);
+			void SetViewIndex(int body);
+
+			std::vector<GameObject*> owners;
+
+			bool						holdingWakes;
+			std::vector<GameObject*>	heldWakes;	//Owners, as a body can be asked to wake more than once
+
+			std::vector<float> posX, posY, posZ;
+			std::vector<float> orientX, orientY, orientZ, orientW;
+
+			std::vector<float> prevPosX, prevPosY, prevPosZ;
+			std::vector<float> prevOrientX, prevOrientY, prevOrientZ, prevOrientW;
+			float renderAlpha;
+
+			std::vector<float> linVelX, linVelY, linVelZ;
+			std::vector<float> angVelX, angVelY, angVelZ;
+			std::vector<float> forceX, forceY, forceZ;
+			std::vector<float> torqueX, torqueY, torqueZ;
+
+			std::vector<float> inverseMass;
+			std::vector<float> gravityScale;
+			std::vector<float> invInertiaX, invInertiaY, invInertiaZ;
+
+			//World space inverse inertia tensor - it's symmetric, so only 6 values are needed
+			std::vector<float> tensorXX, tensorYY, tensorZZ;
+			std::vector<float> tensorXY, tensorXZ, tensorYZ;
+
+			std::vector<float> linearDamping, angularDamping;
+
+			//How long each body has been moving slowly enough to sleep
+			std::vector<float> sleepTime;
+
+			int awakeCount;
+		};
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NCL_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NCL_SIMD_SSE
+#endif
+#include <cmath>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A group of floats that are all operated on at once - 8 of them when
+		built for AVX2, 4 with plain SSE (which every x64 CPU has), or just 1
+		if neither is available, so code written against it still compiles
+		anywhere.
+
+		Comparisons give back a SimdMask, with one flag per lane, which can
+		be combined, used to pick between two values with Select, or turned
+		into a bitfield with GetBits to find which lanes passed.
+
+		Everything is done with the plain IEEE operations, so each lane gets
+		exactly the same answer the scalar code would, barring the compiler
+		fusing multiplies and adds together.
+		*/
+#if defined(NCL_SIMD_AVX2)
+		struct SimdMask {
+			__m256 v;
+
+			SimdMask(__m256 m) : v(m) {}
+
+			static SimdMask All() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+
+			SimdMask operator&(const SimdMask& a) const { return _mm256_and_ps(v, a.v); }
+			SimdMask operator|(const SimdMask& a) const { return _mm256_or_ps(v, a.v); }
+			SimdMask operator!() const { return _mm256_xor_ps(v, All().v); }
+
+			int  GetBits()	const { return _mm256_movemask_ps(v); }
+			bool Any()		const { return GetBits() != 0; }
+		};
+
+		struct SimdFloat {
+			static constexpr int Width = 8;
+			__m256 v;
+
+			SimdFloat() : v(_mm256_setzero_ps()) {}
+			SimdFloat(float f) : v(_mm256_set1_ps(f)) {}
+			SimdFloat(__m256 f) : v(f) {}
+
+			static SimdFloat Load(const float* p)	{ return _mm256_loadu_ps(p); }
+			void Store(float* p) const				{ _mm256_storeu_ps(p, v); }
+
+			SimdFloat operator+(const SimdFloat& a) const { return _mm256_add_ps(v, a.v); }
+			SimdFloat operator-(const SimdFloat& a) const { return _mm256_sub_ps(v, a.v); }
+			SimdFloat operator*(const SimdFloat& a) const { return _mm256_mul_ps(v, a.v); }
+			SimdFloat operator/(const SimdFloat& a) const { return _mm256_div_ps(v, a.v); }
+			SimdFloat operator-() const { return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f)); }
+
+			SimdMask operator< (const SimdFloat& a) const { return _mm256_cmp_ps(v, a.v, _CMP_LT_OQ); }
+			SimdMask operator<=(const SimdFloat& a) const { return _mm256_cmp_ps(v, a.v, _CMP_LE_OQ); }
+			SimdMask operator> (const SimdFloat& a) const { return _mm256_cmp_ps(v, a.v, _CMP_GT_OQ); }
+			SimdMask operator!=(const SimdFloat& a) const { return _mm256_cmp_ps(v, a.v, _CMP_NEQ_UQ); }
+		};
+
+		inline SimdFloat Abs(const SimdFloat& a)						{ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+		inline SimdFloat Sqrt(const SimdFloat& a)						{ return _mm256_sqrt_ps(a.v); }
+		inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b)	{ return _mm256_min_ps(a.v, b.v); }
+		inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b)	{ return _mm256_max_ps(a.v, b.v); }
+		//Lanes where m is set get a, the rest get b
+		inline SimdFloat Select(const SimdMask& m, const SimdFloat& a, const SimdFloat& b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+
+#elif defined(NCL_SIMD_SSE)
+		struct SimdMask {
+			__m128 v;
+
+			SimdMask(__m128 m) : v(m) {}
+
+			static SimdMask All() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+			SimdMask operator&(const SimdMask& a) const { return _mm_and_ps(v, a.v); }
+			SimdMask operator|(const SimdMask& a) const { return _mm_or_ps(v, a.v); }
+			SimdMask operator!() const { return _mm_xor_ps(v, All().v); }
+
+			int  GetBits()	const { return _mm_movemask_ps(v); }
+			bool Any()		const { return GetBits() != 0; }
+		};
+
+		struct SimdFloat {
+			static constexpr int Width = 4;
+			__m128 v;
+
+			SimdFloat() : v(_mm_setzero_ps()) {}
+			SimdFloat(float f) : v(_mm_set1_ps(f)) {}
+			SimdFloat(__m128 f) : v(f) {}
+
+			static SimdFloat Load(const float* p)	{ return _mm_loadu_ps(p); }
+			void Store(float* p) const				{ _mm_storeu_ps(p, v); }
+
+			SimdFloat operator+(const SimdFloat& a) const { return _mm_add_ps(v, a.v); }
+			SimdFloat operator-(const SimdFloat& a) const { return _mm_sub_ps(v, a.v); }
+			SimdFloat operator*(const SimdFloat& a) const { return _mm_mul_ps(v, a.v); }
+			SimdFloat operator/(const SimdFloat& a) const { return _mm_div_ps(v, a.v); }
+			SimdFloat operator-() const { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+
+			SimdMask operator< (const SimdFloat& a) const { return _mm_cmplt_ps(v, a.v); }
+			SimdMask operator<=(const SimdFloat& a) const { return _mm_cmple_ps(v, a.v); }
+			SimdMask operator> (const SimdFloat& a) const { return _mm_cmpgt_ps(v, a.v); }
+			SimdMask operator!=(const SimdFloat& a) const { return _mm_cmpneq_ps(v, a.v); }
+		};
+
+		inline SimdFloat Abs(const SimdFloat& a)						{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+		inline SimdFloat Sqrt(const SimdFloat& a)						{ return _mm_sqrt_ps(a.v); }
+		inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b)	{ return _mm_min_ps(a.v, b.v); }
+		inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b)	{ return _mm_max_ps(a.v, b.v); }
+		//Lanes where m is set get a, the rest get b - SSE2 has no blend, so it's done with bitwise ops
+		inline SimdFloat Select(const SimdMask& m, const SimdFloat& a, const SimdFloat& b) {
+			return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v));
+		}
+
+#else
+		struct SimdMask {
+			bool v;
+
+			SimdMask(bool m) : v(m) {}
+
+			static SimdMask All() { return true; }
+
+			SimdMask operator&(const SimdMask& a) const { return v && a.v; }
+			SimdMask operator|(const SimdMask& a) const { return v || a.v; }
+			SimdMask operator!() const { return !v; }
+
+			int  GetBits()	const { return v ? 1 : 0; }
+			bool Any()		const { return v; }
+		};
+
+		struct SimdFloat {
+			static constexpr int Width = 1;
+			float v;
+
+			SimdFloat() : v(0.0f) {}
+			SimdFloat(float f) : v(f) {}
+
+			static SimdFloat Load(const float* p)	{ return *p; }
+			void Store(float* p) const				{ *p = v; }
+
+			SimdFloat operator+(const SimdFloat& a) const { return v + a.v; }
+			SimdFloat operator-(const SimdFloat& a) const { return v - a.v; }
+			SimdFloat operator*(const SimdFloat& a) const { return v * a.v; }
+			SimdFloat operator/(const SimdFloat& a) const { return v / a.v; }
+			SimdFloat operator-() const { return -v; }
+
+			SimdMask operator< (const SimdFloat& a) const { return v <  a.v; }
+			SimdMask operator<=(const SimdFloat& a) const { return v <= a.v; }
+			SimdMask operator> (const SimdFloat& a) const { return v >  a.v; }
+			SimdMask operator!=(const SimdFloat& a) const { return v != a.v; }
+		};
+
+		inline SimdFloat Abs(const SimdFloat& a)						{ return std::fabs(a.v); }
+		inline SimdFloat Sqrt(const SimdFloat& a)						{ return std::sqrt(a.v); }
+		inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b)	{ return a.v < b.v ? a.v : b.v; }
+		inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b)	{ return a.v > b.v ? a.v : b.v; }
+		inline SimdFloat Select(const SimdMask& m, const SimdFloat& a, const SimdFloat& b) { return m.v ? a : b; }
+#endif
+	}
+}
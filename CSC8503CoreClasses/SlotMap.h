@@ -0,0 +1,181 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Refers to a value in a SlotMap. A handle stays the same for as long
+		as its value is in the map, however much else is added or removed,
+		and once the value's gone, the handle just stops finding anything -
+		even if something new ends up in the same slot, as each slot counts
+		how many times it's been reused (its generation), and a handle only
+		matches the generation it was made with.
+
+		A default handle is null, and never matches anything.
+		*/
+		template<class T>
+		struct SlotHandle {
+			uint32_t index		= 0;
+			uint32_t generation = 0;
+
+			bool IsNull() const {
+				return generation == 0;
+			}
+
+			bool operator==(const SlotHandle& other) const {
+				return index == other.index && generation == other.generation;
+			}
+
+			bool operator!=(const SlotHandle& other) const {
+				return !(*this == other);
+			}
+		};
+
+		/*
+		Stores values in one tightly packed array, so walking over all of
+		them is just walking a vector, and hands back a handle for each one.
+
+		Adding and removing are both O(1) - a removed value has the last
+		value moved into its place, so the order values are walked in
+		changes as things are removed. Each slot knows where its value is
+		in the packed array, and each value knows which slot it belongs to.
+
+		A slot's generation is odd while it's in use, and even while it's
+		free, so a handle (which is always made with an odd generation) can
+		only ever match a slot that's in use.
+		*/
+		template<class T>
+		class SlotMap {
+		public:
+			typedef SlotHandle<T> Handle;
+			typedef typename std::vector<T>::const_iterator Iterator;
+
+			SlotMap() {
+				freeList = -1;
+			}
+			~SlotMap() {
+			}
+
+			Handle Insert(const T& value) {
+				int slotIndex = freeList;
+				if (slotIndex == -1) {
+					slotIndex = (int)slots.size();
+					slots.emplace_back();
+				}
+				else {
+					freeList = slots[slotIndex].next;
+				}
+				Slot& slot = slots[slotIndex];
+				slot.generation++;
+				slot.dense = (int)values.size();
+
+				values.emplace_back(value);
+				denseToSlot.emplace_back(slotIndex);
+
+				return Handle{ (uint32_t)slotIndex, slot.generation };
+			}
+
+			//Returns false if the handle didn't match anything
+			bool Remove(Handle h) {
+				if (!Contains(h)) {
+					return false;
+				}
+				Slot&	slot = slots[h.index];
+				int		dense = slot.dense;
+				int		last  = (int)values.size() - 1;
+				if (dense != last) {
+					values[dense]		= std::move(values[last]);
+					denseToSlot[dense]	= denseToSlot[last];
+					slots[denseToSlot[dense]].dense = dense;
+				}
+				values.pop_back();
+				denseToSlot.pop_back();
+				Free((int)h.index);
+				return true;
+			}
+
+			bool Contains(Handle h) const {
+				return h.index < slots.size() && slots[h.index].generation == h.generation && !h.IsNull();
+			}
+
+			//nullptr if the handle doesn't match anything
+			T* Get(Handle h) {
+				return Contains(h) ? &values[slots[h.index].dense] : nullptr;
+			}
+
+			const T* Get(Handle h) const {
+				return Contains(h) ? &values[slots[h.index].dense] : nullptr;
+			}
+
+			//The handle of the value at the given place in the packed array
+			Handle GetHandle(int denseIndex) const {
+				int slotIndex = denseToSlot[denseIndex];
+				return Handle{ (uint32_t)slotIndex, slots[slotIndex].generation };
+			}
+
+			/*
+			Removes everything - the slots are kept, and freed as if each
+			value had been removed, so no handle from before will ever match
+			anything put in afterwards.
+			*/
+			void Clear() {
+				for (int slotIndex : denseToSlot) {
+					Free(slotIndex);
+				}
+				values.clear();
+				denseToSlot.clear();
+			}
+
+			//Shuffles the packed array - every handle still finds its own value
+			template<class RNG>
+			void Shuffle(RNG& rng) {
+				for (int i = (int)values.size() - 1; i > 0; --i) {
+					int j = (int)(rng() % (i + 1));
+					std::swap(values[i], values[j]);
+					std::swap(denseToSlot[i], denseToSlot[j]);
+					slots[denseToSlot[i]].dense = i;
+					slots[denseToSlot[j]].dense = j;
+				}
+			}
+
+			int GetCount() const {
+				return (int)values.size();
+			}
+
+			const std::vector<T>& GetValues() const {
+				return values;
+			}
+
+			Iterator begin() const {
+				return values.begin();
+			}
+
+			Iterator end() const {
+				return values.end();
+			}
+
+		protected:
+			struct Slot {
+				uint32_t generation = 0;
+				union {
+					int dense;	//Where the value is, while the slot's in use
+					int next;	//The next free slot, while it isn't
+				};
+			};
+
+			void Free(int slotIndex) {
+				Slot& slot = slots[slotIndex];
+				slot.generation++;
+				slot.next	= freeList;
+				freeList	= slotIndex;
+			}
+
+			std::vector<T>		values;
+			std::vector<int>	denseToSlot;
+			std::vector<Slot>	slots;
+			int					freeList;
+		};
+	}
+}
@@ -2,7 +2,7 @@
 #include "CollisionVolume.h"
 
 namespace NCL {
-	class SphereVolume : CollisionVolume
+	class SphereVolume : public CollisionVolume
 	{
 	public:
 		SphereVolume(float sphereRadius = 1.0f) {
@@ -17,5 +17,6 @@ namespace NCL {
 	protected:
 		float	radius;
 	};
+	static_assert(sizeof(SphereVolume) <= CollisionVolume::PooledSize, "SphereVolume won't fit in a pooled volume block");
 }
 
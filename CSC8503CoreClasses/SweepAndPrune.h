@@ -0,0 +1,223 @@
+#pragma once
+#include "Vector3.h"
+#include <algorithm>
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		Sort and sweep broadphase. Every box is kept in a list sorted by its
+		minimum x value, so to find everything a box overlaps we only need to
+		walk forward through the list until we reach a box that starts past
+		our box's maximum x, and check the other two axes on the way.
+
+		The bounds are kept in packed float arrays in that sorted order, and
+		stay there from one step to the next - moving a proxy writes its new
+		bounds straight into its slot. Objects only move a little between
+		physics steps, so the arrays are almost sorted already, and an
+		insertion sort puts them right in close to linear time, instead of
+		n log n from scratch. The sweep is then a run of contiguous compares
+		rather than chasing pointers to each object's transform and volume.
+
+		Destroying a proxy just leaves a gap in the arrays, and the gaps are
+		all squeezed out in one pass before the next sort.
+		*/
+		template<class T>
+		class SweepAndPrune {
+		public:
+			static constexpr int NullProxy = -1;
+
+			SweepAndPrune() {
+				freeList	= NullProxy;
+				proxyCount	= 0;
+				gapCount	= 0;
+			}
+			~SweepAndPrune() {
+			}
+
+			void Clear() {
+				proxies.clear();
+				order.clear();
+				minXs.clear();
+				maxXs.clear();
+				minYs.clear();
+				maxYs.clear();
+				minZs.clear();
+				maxZs.clear();
+				freeList	= NullProxy;
+				proxyCount	= 0;
+				gapCount	= 0;
+			}
+
+			int CreateProxy(T object, const Vector3& pos, const Vector3& halfSize) {
+				int proxy;
+				if (freeList != NullProxy) {
+					proxy		= freeList;
+					freeList	= proxies[proxy].next;
+				}
+				else {
+					proxy = (int)proxies.size();
+					proxies.emplace_back();
+				}
+				Proxy& p	= proxies[proxy];
+				p.object	= object;
+				p.slot		= (int)order.size();
+				p.next		= NullProxy;
+				p.inUse		= true;
+
+				//Goes on the end, and the next sort moves it into place
+				order.push_back(proxy);
+				minXs.push_back(0.0f);
+				maxXs.push_back(0.0f);
+				minYs.push_back(0.0f);
+				maxYs.push_back(0.0f);
+				minZs.push_back(0.0f);
+				maxZs.push_back(0.0f);
+				SetBounds(p.slot, pos - halfSize, pos + halfSize);
+
+				proxyCount++;
+				return proxy;
+			}
+
+			void DestroyProxy(int proxy) {
+				order[proxies[proxy].slot] = NullProxy;
+				gapCount++;
+
+				proxies[proxy].slot		= NullProxy;
+				proxies[proxy].next		= freeList;
+				proxies[proxy].inUse	= false;
+				freeList				= proxy;
+				proxyCount--;
+			}
+
+			/*
+			Same signature as the dynamic tree, so the PhysicsSystem can drive
+			either one. There's no fat box here, so the box is always updated,
+			and the displacement isn't needed.
+			*/
+			bool MoveProxy(int proxy, const Vector3& pos, const Vector3& halfSize, const Vector3& /*displacement*/) {
+				SetBounds(proxies[proxy].slot, pos - halfSize, pos + halfSize);
+				return true;
+			}
+
+			T GetObject(int proxy) const {
+				return proxies[proxy].object;
+			}
+
+			int GetProxyCount() const {
+				return proxyCount;
+			}
+
+			/*
+			Calls func(a, b) once for every pair of proxies whose boxes overlap.
+			*/
+			template<class F>
+			void OperateOnPairs(F&& func) {
+				RemoveGaps();
+				SortAxis();
+
+				const int count = (int)order.size();
+				for (int i = 0; i < count; ++i) {
+					const float maxX = maxXs[i];
+					const float minY = minYs[i];
+					const float maxY = maxYs[i];
+					const float minZ = minZs[i];
+					const float maxZ = maxZs[i];
+
+					for (int j = i + 1; j < count && minXs[j] <= maxX; ++j) {
+						if (minYs[j] <= maxY && maxYs[j] >= minY &&
+							minZs[j] <= maxZ && maxZs[j] >= minZ) {
+							func(proxies[order[i]].object, proxies[order[j]].object);
+						}
+					}
+				}
+			}
+
+		protected:
+			struct Proxy {
+				T		object;
+				int		slot;	//where its bounds are in the sorted arrays
+				int		next;	//free list link
+				bool	inUse;
+			};
+
+			void SetBounds(int slot, const Vector3& min, const Vector3& max) {
+				minXs[slot] = min.x;
+				maxXs[slot] = max.x;
+				minYs[slot] = min.y;
+				maxYs[slot] = max.y;
+				minZs[slot] = min.z;
+				maxZs[slot] = max.z;
+			}
+
+			void MoveSlot(int from, int to) {
+				order[to] = order[from];
+				minXs[to] = minXs[from];
+				maxXs[to] = maxXs[from];
+				minYs[to] = minYs[from];
+				maxYs[to] = maxYs[from];
+				minZs[to] = minZs[from];
+				maxZs[to] = maxZs[from];
+				proxies[order[to]].slot = to;
+			}
+
+			//Keeps everything in the same order, so the arrays stay sorted
+			void RemoveGaps() {
+				if (gapCount == 0) {
+					return;
+				}
+				int count = 0;
+				for (int i = 0; i < (int)order.size(); ++i) {
+					if (order[i] != NullProxy) {
+						if (i != count) {
+							MoveSlot(i, count);
+						}
+						count++;
+					}
+				}
+				order.resize(count);
+				minXs.resize(count);
+				maxXs.resize(count);
+				minYs.resize(count);
+				maxYs.resize(count);
+				minZs.resize(count);
+				maxZs.resize(count);
+				gapCount = 0;
+			}
+
+			//Insertion sort on min x - cheap, as last step's order is nearly right
+			void SortAxis() {
+				for (int i = 1; i < (int)order.size(); ++i) {
+					if (minXs[i - 1] <= minXs[i]) {
+						continue;
+					}
+					int		proxy	= order[i];
+					float	bounds[6] = { minXs[i], maxXs[i], minYs[i], maxYs[i], minZs[i], maxZs[i] };
+
+					int j = i - 1;
+					while (j >= 0 && minXs[j] > bounds[0]) {
+						MoveSlot(j, j + 1);
+						--j;
+					}
+					order[j + 1] = proxy;
+					proxies[proxy].slot = j + 1;
+					SetBounds(j + 1, Vector3(bounds[0], bounds[2], bounds[4]), Vector3(bounds[1], bounds[3], bounds[5]));
+				}
+			}
+
+			std::vector<Proxy>	proxies;
+			std::vector<int>	order;		//which proxy is in each slot, NullProxy for a gap
+			int freeList;
+			int proxyCount;
+			int gapCount;
+
+			std::vector<float> minXs;
+			std::vector<float> maxXs;
+			std::vector<float> minYs;
+			std::vector<float> maxYs;
+			std::vector<float> minZs;
+			std::vector<float> maxZs;
+		};
+	}
+}
@@ -0,0 +1,54 @@
+#include "TaskGraph.h"
+#include <cassert>
+
+using namespace NCL;
+using namespace CSC8503;
+
+TaskGraph::TaskGraph() {
+}
+
+TaskGraph::~TaskGraph() {
+}
+
+TaskGraph::TaskID TaskGraph::AddTask(const std::string& name, const std::function<void()>& func, bool mainThreadOnly) {
+	Job& job = tasks.emplace_back();
+	job.func			= func;
+	job.counter			= &counter;
+	job.mainThreadOnly	= mainThreadOnly;
+
+	names.emplace_back(name);
+	dependencyCounts.emplace_back(0);
+	return (TaskID)tasks.size() - 1;
+}
+
+void TaskGraph::AddDependency(TaskID before, TaskID after) {
+	assert(before != after);
+	tasks[before].dependents.emplace_back(&tasks[after]);
+	dependencyCounts[after]++;
+}
+
+/*
+Every task's dependency count has to be set back up before any of them are
+started, as the first tasks to finish will start counting down the others.
+*/
+void TaskGraph::Run(JobSystem& jobs) {
+	if (tasks.empty()) {
+		return;
+	}
+	counter.count = (int)tasks.size();
+	for (int i = 0; i < (int)tasks.size(); ++i) {
+		tasks[i].pendingDependencies = dependencyCounts[i];
+	}
+	for (int i = 0; i < (int)tasks.size(); ++i) {
+		if (dependencyCounts[i] == 0) {
+			jobs.Submit(tasks[i]);
+		}
+	}
+	jobs.Wait(counter);
+}
+
+void TaskGraph::Clear() {
+	tasks.clear();
+	names.clear();
+	dependencyCounts.clear();
+}
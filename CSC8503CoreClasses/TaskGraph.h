@@ -0,0 +1,55 @@
+#pragma once
+#include "JobSystem.h"
+#include <deque>
+#include <string>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A description of a frame (or anything else run over and over) as a
+		set of named tasks, and which tasks have to finish before others can
+		start. It's built once, and then Run every frame - each run hands
+		every task to the JobSystem as a job, and tasks that don't depend on
+		each other are free to run at the same time, on whichever threads
+		get to them first.
+
+		Tasks are kept as jobs the whole time, so running the graph doesn't
+		allocate anything.
+		*/
+		class TaskGraph {
+		public:
+			typedef int TaskID;
+
+			TaskGraph();
+			~TaskGraph();
+
+			TaskID AddTask(const std::string& name, const std::function<void()>& func, bool mainThreadOnly = false);
+
+			//after won't be started until before has finished
+			void AddDependency(TaskID before, TaskID after);
+
+			/*
+			Runs every task, and returns once they've all finished. Has to be
+			called from the JobSystem's main thread if any of the tasks have
+			to be run on it.
+			*/
+			void Run(JobSystem& jobs);
+
+			void Clear();
+
+			int GetTaskCount() const {
+				return (int)tasks.size();
+			}
+
+			const std::string& GetTaskName(TaskID task) const {
+				return names[task];
+			}
+
+		protected:
+			std::deque<Job>				tasks;	//A deque, as jobs can't be moved once they've been made
+			std::vector<std::string>	names;
+			std::vector<int>			dependencyCounts;
+			JobCounter					counter;
+		};
+	}
+}
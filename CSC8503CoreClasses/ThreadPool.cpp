@@ -0,0 +1,145 @@
+#include "ThreadPool.h"
+#include "JobSystem.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+//The pool whose chunks the calling thread is in the middle of running, if any
+static thread_local const ThreadPool* runningPool = nullptr;
+
+ThreadPool::ThreadPool(int threadCount) {
+	if (threadCount <= 0) {
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	workerCount		= threadCount - 1;
+	jobSystem		= nullptr;
+	jobGeneration	= 0;
+	shuttingDown	= false;
+	job				= nullptr;
+	jobCount		= 0;
+	jobChunks		= 0;
+	activeWorkers	= 0;
+	nextChunk		= 0;
+	chunksDone		= 0;
+
+	StartWorkers();
+}
+
+ThreadPool::~ThreadPool() {
+	StopWorkers();
+}
+
+void ThreadPool::StartWorkers() {
+	for (int i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+void ThreadPool::StopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		shuttingDown = true;
+	}
+	jobStart.notify_all();
+	for (std::thread& t : workers) {
+		t.join();
+	}
+	workers.clear();
+	shuttingDown = false;
+}
+
+int ThreadPool::GetThreadCount() const {
+	return jobSystem ? jobSystem->GetThreadCount() : (int)workers.size() + 1;
+}
+
+void ThreadPool::UseJobSystem(JobSystem* jobs) {
+	std::lock_guard<std::mutex> caller(callerMutex);
+	if (jobs == jobSystem) {
+		return;
+	}
+	if (jobs) {
+		StopWorkers();
+	}
+	else {
+		StartWorkers();
+	}
+	jobSystem = jobs;
+}
+
+int ThreadPool::ParallelFor(int count, int minChunkSize, const ChunkFunc& func) {
+	if (count <= 0) {
+		return 0;
+	}
+	if (jobSystem) {
+		return jobSystem->ParallelFor(count, minChunkSize, func);
+	}
+	int chunks = std::min(GetThreadCount(), std::max(1, count / std::max(1, minChunkSize)));
+	if (chunks == 1 || runningPool == this) {
+		func(0, 0, count);
+		return 1;
+	}
+	std::lock_guard<std::mutex> caller(callerMutex);
+	{
+		std::unique_lock<std::mutex> lock(jobMutex);
+		//A worker that woke up late for the last job might still be on its way out
+		jobDone.wait(lock, [&]() { return activeWorkers == 0; });
+		job			= &func;
+		jobCount	= count;
+		jobChunks	= chunks;
+		nextChunk	= 0;
+		chunksDone	= 0;
+		jobGeneration++;
+	}
+	jobStart.notify_all();
+
+	RunChunks();
+
+	//Wait for the workers to leave the job too, so none of them can wander into the next one
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobDone.wait(lock, [&]() { return chunksDone == jobChunks && activeWorkers == 0; });
+	job = nullptr;
+	return chunks;
+}
+
+void ThreadPool::WorkerLoop() {
+	int seenGeneration;
+	{
+		//Workers started up again by UseJobSystem shouldn't go after a loop that's already done
+		std::lock_guard<std::mutex> lock(jobMutex);
+		seenGeneration = jobGeneration;
+	}
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobStart.wait(lock, [&]() { return shuttingDown || jobGeneration != seenGeneration; });
+			if (shuttingDown) {
+				return;
+			}
+			seenGeneration = jobGeneration;
+			activeWorkers++;
+		}
+		RunChunks();
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			activeWorkers--;
+		}
+		jobDone.notify_one();
+	}
+}
+
+//Grabs chunks until there are none left - whoever gets there first does the work
+void ThreadPool::RunChunks() {
+	const ThreadPool* previous = runningPool;	//A chunk of another pool's loop might have called this one
+	runningPool = this;
+	while (true) {
+		int chunk = nextChunk++;
+		if (chunk >= jobChunks) {
+			break;
+		}
+		int begin	= (int)(((long long)jobCount * chunk) / jobChunks);
+		int end		= (int)(((long long)jobCount * (chunk + 1)) / jobChunks);
+		(*job)(chunk, begin, end);
+		chunksDone++;
+	}
+	runningPool = previous;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		class JobSystem;
+
+		/*
+		A fixed set of worker threads that sleep until given a loop to split
+		up between them. The thread that calls ParallelFor joins in too, and
+		doesn't return until every chunk of the loop is done.
+
+		The range is always cut into the same contiguous chunks for a given
+		count, and each chunk is handed its index - so anything a chunk writes
+		into a per-chunk buffer can be stitched back together in chunk order,
+		giving the same result no matter which thread ran what.
+
+		The pool's own threads only work on one loop at a time, but loops
+		can still be nested. A chunk that calls ParallelFor on the pool it's
+		running on gets its loop run there and then, on its own thread, and
+		if two threads call ParallelFor at once, the second blocks until the
+		first loop is finished before starting its own. None of that applies
+		once the pool is using a JobSystem, which nests loops freely.
+		Anything that can run alongside other work on a JobSystem should
+		hand the pool that JobSystem with UseJobSystem, which also stops two
+		full sets of threads fighting over the same cores.
+		*/
+		class ThreadPool {
+		public:
+			typedef std::function<void(int chunk, int begin, int end)> ChunkFunc;
+
+			//0 threads means one per hardware thread, including the caller
+			ThreadPool(int threadCount = 0);
+			~ThreadPool();
+
+			int GetThreadCount() const;
+
+			/*
+			Runs every loop as jobs on the given JobSystem instead, which can
+			take any number of loops at once, and stops the pool's own threads.
+			nullptr starts them up again. Only call it while nothing's using
+			the pool.
+			*/
+			void UseJobSystem(JobSystem* jobs);
+
+			/*
+			Runs func over [0, count), split into at most GetThreadCount() chunks
+			of at least minChunkSize items. Returns the number of chunks used.
+			Small loops are just run on the calling thread as a single chunk.
+			*/
+			int ParallelFor(int count, int minChunkSize, const ChunkFunc& func);
+
+		protected:
+			void StartWorkers();
+			void StopWorkers();
+			void WorkerLoop();
+			void RunChunks();
+
+			std::vector<std::thread> workers;
+			int			workerCount;
+			JobSystem*	jobSystem;
+
+			std::mutex				callerMutex;	//Held for the whole loop, so only one runs at a time
+
+			std::mutex				jobMutex;
+			std::condition_variable	jobStart;
+			std::condition_variable	jobDone;
+			int		jobGeneration;
+			int		activeWorkers;
+			bool	shuttingDown;
+
+			const ChunkFunc*	job;
+			int					jobCount;
+			int					jobChunks;
+			std::atomic<int>	nextChunk;
+			std::atomic<int>	chunksDone;
+		};
+	}
+}
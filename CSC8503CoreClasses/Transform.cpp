@@ -3,7 +3,27 @@
 using namespace NCL::CSC8503;
 
 Transform::Transform()	{
-	scale = Vector3(1, 1, 1);
+	scale		= Vector3(1, 1, 1);
+	bodyStore	= nullptr;
+	bodyIndex	= -1;
+}
+
+Transform::Transform(const Transform& other) {
+	position	= other.GetPosition();
+	orientation = other.GetOrientation();
+	scale		= other.scale;
+	bodyStore	= nullptr;
+	bodyIndex	= -1;
+	UpdateMatrix();
+}
+
+Transform& Transform::operator=(const Transform& other) {
+	if (this != &other) {
+		scale = other.scale;
+		SetPosition(other.GetPosition());
+		SetOrientation(other.GetOrientation());
+	}
+	return *this;
 }
 
 Transform::~Transform()	{
@@ -12,12 +32,31 @@ Transform::~Transform()	{
 
 void Transform::UpdateMatrix() {
 	matrix =
-		Matrix4::Translation(position) *
-		Matrix4(orientation) *
+		Matrix4::Translation(GetPosition()) *
+		Matrix4(GetOrientation()) *
 		Matrix4::Scale(scale);
 }
 
+/*
+The physics integration writes straight into the body store, so if we're
+in one, the cached matrix might be out of date - build it fresh instead,
+from the store's interpolated state, so it's smooth to draw.
+*/
+Matrix4 Transform::GetMatrix() const {
+	if (bodyStore) {
+		return	Matrix4::Translation(bodyStore->GetRenderPosition(bodyIndex)) *
+				Matrix4(bodyStore->GetRenderOrientation(bodyIndex)) *
+				Matrix4::Scale(scale);
+	}
+	return matrix;
+}
+
 Transform& Transform::SetPosition(const Vector3& worldPos) {
+	if (bodyStore) {
+		bodyStore->WakeBody(bodyIndex); //Anything moved by hand has to be looked at again
+		bodyStore->SetPosition(bodyIndex, worldPos);
+		return *this;
+	}
 	position = worldPos;
 	UpdateMatrix();
 	return *this;
@@ -30,6 +69,11 @@ Transform& Transform::SetScale(const Vector3& worldScale) {
 }
 
 Transform& Transform::SetOrientation(const Quaternion& worldOrientation) {
+	if (bodyStore) {
+		bodyStore->WakeBody(bodyIndex);
+		bodyStore->SetOrientation(bodyIndex, worldOrientation);
+		return *this;
+	}
 	orientation = worldOrientation;
 	UpdateMatrix();
 	return *this;
@@ -1,4 +1,5 @@
 #pragma once
+#include "RigidBodyStore.h"
 
 using std::vector;
 
@@ -10,14 +11,18 @@ namespace NCL {
 		{
 		public:
 			Transform();
+			Transform(const Transform& other);
 			~Transform();
 
+			//Copies the values only - the copy is never part of a RigidBodyStore
+			Transform& operator=(const Transform& other);
+
 			Transform& SetPosition(const Vector3& worldPos);
 			Transform& SetScale(const Vector3& worldScale);
 			Transform& SetOrientation(const Quaternion& newOr);
 
 			Vector3 GetPosition() const {
-				return position;
+				return bodyStore ? bodyStore->GetPosition(bodyIndex) : position;
 			}
 
 			Vector3 GetScale() const {
@@ -25,19 +30,24 @@ namespace NCL {
 			}
 
 			Quaternion GetOrientation() const {
-				return orientation;
+				return bodyStore ? bodyStore->GetOrientation(bodyIndex) : orientation;
 			}
 
-			Matrix4 GetMatrix() const {
-				return matrix;
-			}
+			//What to draw with - anything with physics is drawn in between its last two physics steps
+			Matrix4 GetMatrix() const;
 			void UpdateMatrix();
 		protected:
+			friend class RigidBodyStore;
+
 			Matrix4		matrix;
 			Quaternion	orientation;
 			Vector3		position;
 
 			Vector3		scale;
+
+			//If set, position and orientation live in here instead
+			RigidBodyStore* bodyStore;
+			int				bodyIndex;
 		};
 	}
 }
@@ -0,0 +1,495 @@
+#include "NavigationGrid.h"
+#include "HierarchicalNavigationGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <queue>
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+
+Generates large grids, in the same format as TestGrid1.txt, and times the
+same set of random start / goal pairs on each with the NavigationGrid's
+A* (FindPath), jump point search, and JPS+ (FindJumpPointPath), and with
+a HierarchicalNavigationGrid (HPA*) over it.
+
+HPA* is timed the way an agent would use it - finding the abstract path,
+and refining just its first segment. The rest of the path is refined
+afterwards (not timed), to see how much longer than the shortest it is.
+After the searches, nodes are changed at random, to time how long it
+takes to change one, and rebuild the clusters around it.
+
+Every query's shortest path length is also worked out with a plain
+breadth first search, so each search can be checked against it. JPS and
+JPS+ should always match it. So should FindPath here, as the grids are made
+with a node size of 1 - with bigger nodes its heuristic (which is in world
+units) overestimates, and some of its paths come out longer. HPA*'s paths
+have to go through the cluster entrances, so plenty come out a bit longer.
+
+Usage: PathfindingBenchmark [options]
+	-map maze|caves|rooms|all	(default all)
+	-size n[,n...]				(default 256,1024) - maps are n by n nodes
+	-search astar|jps|jps+|hpa|all	(default all)
+	-cluster n					(default 32) - HPA* cluster size
+	-queries n					(default 1000)
+	-seed n						(default 0)
+
+A maze is a randomly carved maze, with a few extra walls knocked through so
+there's more than one way around. Caves are open ground with a random 30% of
+the nodes walled off. Rooms are split up into smaller and smaller rooms,
+with a door or two in every wall, more like a level would be - the mazes and
+caves have a way across between nearly every pair of nodes either side of a
+cluster's edge, which is as bad as it gets for HPA*.
+
+*/
+
+enum class MapType {
+	Maze,
+	Caves,
+	Rooms
+};
+
+enum class SearchType {
+	AStar,
+	JumpPoint,
+	JumpPointPlus,
+	Hierarchical
+};
+
+struct BenchmarkSettings {
+	std::vector<MapType>	maps		= { MapType::Maze, MapType::Caves, MapType::Rooms };
+	std::vector<int>		sizes		= { 256, 1024 };
+	std::vector<SearchType>	searches	= { SearchType::AStar, SearchType::JumpPoint, SearchType::JumpPointPlus, SearchType::Hierarchical };
+	int			clusterSize	= 32;
+	int			queries		= 1000;
+	int			edits		= 100;
+	unsigned	seed		= 0;
+};
+
+struct Query {
+	int start;
+	int end;
+	int shortest; //In steps, -1 for no path at all
+};
+
+static const char* GetMapName(MapType m) {
+	switch (m) {
+		case MapType::Maze:		return "Maze";
+		case MapType::Caves:	return "Caves";
+		case MapType::Rooms:	return "Rooms";
+	}
+	return "Unknown";
+}
+
+static const char* GetSearchName(SearchType s) {
+	switch (s) {
+		case SearchType::AStar:			return "A*";
+		case SearchType::JumpPoint:		return "JPS";
+		case SearchType::JumpPointPlus:	return "JPS+";
+		case SearchType::Hierarchical:	return "HPA*";
+	}
+	return "Unknown";
+}
+
+//Carves passages out of solid wall with a depth first walk, on every other node
+static void GenerateMaze(int size, std::mt19937& rng, std::vector<char>& nodes) {
+	nodes.assign(size * size, 'x');
+
+	int cells = (size - 1) / 2;
+	std::vector<int> stack;
+	std::vector<bool> visited(cells * cells, false);
+
+	visited[0] = true;
+	stack.emplace_back(0);
+	nodes[size + 1] = '.';
+
+	const int offsetX[4] = { 0, 0, -1, 1 };
+	const int offsetY[4] = { -1, 1, 0, 0 };
+
+	while (!stack.empty()) {
+		int cell	= stack.back();
+		int x		= cell % cells;
+		int y		= cell / cells;
+
+		int options[4];
+		int optionCount = 0;
+		for (int i = 0; i < 4; ++i) {
+			int nx = x + offsetX[i];
+			int ny = y + offsetY[i];
+			if (nx >= 0 && ny >= 0 && nx < cells && ny < cells && !visited[(ny * cells) + nx]) {
+				options[optionCount++] = i;
+			}
+		}
+		if (optionCount == 0) {
+			stack.pop_back();
+			continue;
+		}
+		int dir = options[rng() % optionCount];
+		int nx	= x + offsetX[dir];
+		int ny	= y + offsetY[dir];
+
+		visited[(ny * cells) + nx] = true;
+		nodes[(((y * 2) + 1 + offsetY[dir]) * size) + (x * 2) + 1 + offsetX[dir]] = '.';
+		nodes[(((ny * 2) + 1) * size) + (nx * 2) + 1] = '.';
+		stack.emplace_back((ny * cells) + nx);
+	}
+	//A perfect maze only has one way between any two places, which isn't much of a test
+	for (int y = 1; y < size - 1; ++y) {
+		for (int x = 1; x < size - 1; ++x) {
+			bool betweenRows	= nodes[((y - 1) * size) + x] == '.' && nodes[((y + 1) * size) + x] == '.';
+			bool betweenCols	= nodes[(y * size) + x - 1] == '.' && nodes[(y * size) + x + 1] == '.';
+			if (nodes[(y * size) + x] == 'x' && (betweenRows != betweenCols) && rng() % 10 == 0) {
+				nodes[(y * size) + x] = '.';
+			}
+		}
+	}
+}
+
+static void GenerateCaves(int size, std::mt19937& rng, std::vector<char>& nodes) {
+	nodes.assign(size * size, '.');
+	for (char& n : nodes) {
+		if (rng() % 100 < 30) {
+			n = 'x';
+		}
+	}
+}
+
+/*
+Keeps splitting the map in two with a wall, until the rooms are too small
+to split again. Walls only go along even rows and columns, and doors are
+only ever started on odd ones, so a wall can't be built across a door.
+*/
+static void GenerateRooms(int size, std::mt19937& rng, std::vector<char>& nodes) {
+	const int minRoomSize = 12;
+
+	struct Room {
+		int x, y, width, height;
+	};
+	nodes.assign(size * size, '.');
+
+	std::vector<Room> rooms = { { 0, 0, size, size } };
+	while (!rooms.empty()) {
+		Room r = rooms.back();
+		rooms.pop_back();
+
+		bool splitX = r.width > r.height;
+		int length	= splitX ? r.width : r.height;
+		if (length < minRoomSize * 2) {
+			continue;
+		}
+		int split = (splitX ? r.x : r.y) + minRoomSize + (int)(rng() % (length - (minRoomSize * 2) + 1));
+		split &= ~1;
+
+		int wallStart	= splitX ? r.y : r.x;
+		int wallLength	= splitX ? r.height : r.width;
+		for (int i = wallStart; i < wallStart + wallLength; ++i) {
+			nodes[splitX ? (i * size) + split : (split * size) + i] = 'x';
+		}
+		int doors = 1 + (int)(rng() % 2);
+		for (int d = 0; d < doors; ++d) {
+			int door	= (wallStart + (int)(rng() % wallLength)) | 1;
+			int width	= 1 + (int)(rng() % 3);
+			for (int i = door; i < std::min(door + width, wallStart + wallLength); ++i) {
+				nodes[splitX ? (i * size) + split : (split * size) + i] = '.';
+			}
+		}
+		if (splitX) {
+			rooms.push_back({ r.x, r.y, split - r.x, r.height });
+			rooms.push_back({ split + 1, r.y, r.x + r.width - split - 1, r.height });
+		}
+		else {
+			rooms.push_back({ r.x, r.y, r.width, split - r.y });
+			rooms.push_back({ r.x, split + 1, r.width, r.y + r.height - split - 1 });
+		}
+	}
+}
+
+//The number of steps on the shortest path from start to end, or -1 if there isn't one
+static int FindShortestPath(int size, const std::vector<char>& nodes, int start, int end) {
+	std::vector<int> distances(size * size, -1);
+	std::queue<int> open;
+
+	distances[start] = 0;
+	open.push(start);
+
+	while (!open.empty()) {
+		int node = open.front();
+		open.pop();
+		if (node == end) {
+			return distances[node];
+		}
+		int x = node % size;
+		int y = node / size;
+		int neighbours[4] = {
+			y > 0			? node - size	: -1,
+			y < size - 1	? node + size	: -1,
+			x > 0			? node - 1		: -1,
+			x < size - 1	? node + 1		: -1
+		};
+		for (int n : neighbours) {
+			if (n != -1 && nodes[n] != 'x' && distances[n] == -1) {
+				distances[n] = distances[node] + 1;
+				open.push(n);
+			}
+		}
+	}
+	return -1;
+}
+
+//Paths have a waypoint on every node, start included
+static int CountSteps(NavigationPath& path) {
+	int steps = -1;
+	Vector3 waypoint;
+	while (path.PopWaypoint(waypoint)) {
+		steps++;
+	}
+	return steps;
+}
+
+static void RunSearches(const NavigationGrid& grid, const HierarchicalNavigationGrid* hierarchy, SearchType search, int size, const std::vector<Query>& queries) {
+	GridSearchScratch			scratch;
+	HierarchicalSearchScratch	hierarchyScratch;
+	HierarchicalPath			route;
+
+	int			found		= 0;
+	int			longer		= 0;
+	int			wrong		= 0; //Found when it shouldn't have been, or the other way around
+	long long	expansions	= 0;
+	long long	pathLength	= 0;
+
+	std::vector<double> queryTimes;
+	queryTimes.reserve(queries.size());
+
+	for (const Query& q : queries) {
+		Vector3 from	= Vector3((float)(q.start % size), 0, (float)(q.start / size));
+		Vector3 to		= Vector3((float)(q.end % size), 0, (float)(q.end / size));
+		NavigationPath path;
+
+		bool success = false;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		switch (search) {
+			case SearchType::AStar:			success = grid.FindPath(from, to, path, scratch); break;
+			case SearchType::JumpPoint:		success = grid.FindJumpPointPath(from, to, path, scratch, false); break;
+			case SearchType::JumpPointPlus:	success = grid.FindJumpPointPath(from, to, path, scratch, true); break;
+			case SearchType::Hierarchical:
+				success = hierarchy->FindAbstractPath(from, to, route, hierarchyScratch) &&
+						  hierarchy->RefineNextSegment(route, path, hierarchyScratch);
+				break;
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		queryTimes.emplace_back(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+		expansions += search == SearchType::Hierarchical ? hierarchyScratch.abstractSearch.expansions : scratch.expansions;
+
+		if (success != (q.shortest != -1)) {
+			wrong++;
+			continue;
+		}
+		if (!success) {
+			continue;
+		}
+		int steps = CountSteps(path);
+		while (search == SearchType::Hierarchical && !route.IsFinished()) {
+			hierarchy->RefineNextSegment(route, path, hierarchyScratch);
+			steps += CountSteps(path);
+		}
+		found++;
+		pathLength += steps;
+		if (steps > q.shortest) {
+			longer++;
+		}
+		else if (steps < q.shortest) {
+			wrong++;
+		}
+	}
+	double total = 0.0;
+	for (double t : queryTimes) {
+		total += t;
+	}
+	std::sort(queryTimes.begin(), queryTimes.end());
+	double p99 = queryTimes.empty() ? 0.0 : queryTimes[std::min(queryTimes.size() - 1, (size_t)(0.99 * queryTimes.size()))];
+	int count = std::max(1, (int)queries.size());
+
+	std::cout << std::setw(8) << GetSearchName(search)
+		<< std::fixed << std::setprecision(4)
+		<< std::setw(12) << total / count
+		<< std::setw(12) << p99
+		<< std::setprecision(1)
+		<< std::setw(14) << (double)expansions / count
+		<< std::setw(12) << (double)pathLength / std::max(1, found)
+		<< std::setw(8) << found
+		<< std::setw(8) << longer
+		<< std::setw(8) << wrong
+		<< std::endl;
+}
+
+static void RunBenchmark(MapType map, int size, const BenchmarkSettings& settings) {
+	std::mt19937 rng(settings.seed);
+
+	std::vector<char> nodes;
+	switch (map) {
+		case MapType::Maze:		GenerateMaze(size, rng, nodes); break;
+		case MapType::Caves:	GenerateCaves(size, rng, nodes); break;
+		case MapType::Rooms:	GenerateRooms(size, rng, nodes); break;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	NavigationGrid grid(1, size, size, nodes);
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	bool useHierarchy = std::find(settings.searches.begin(), settings.searches.end(), SearchType::Hierarchical) != settings.searches.end();
+	HierarchicalNavigationGrid* hierarchy = nullptr;
+	double hierarchyTime = 0.0;
+	if (useHierarchy) {
+		auto hierarchyStart = std::chrono::high_resolution_clock::now();
+		hierarchy = new HierarchicalNavigationGrid(grid, settings.clusterSize);
+		hierarchyTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - hierarchyStart).count();
+	}
+
+	std::vector<int> open;
+	for (int i = 0; i < size * size; ++i) {
+		if (nodes[i] != 'x') {
+			open.emplace_back(i);
+		}
+	}
+	std::vector<Query> queries(open.empty() ? 0 : settings.queries);
+	for (Query& q : queries) {
+		q.start		= open[rng() % open.size()];
+		q.end		= open[rng() % open.size()];
+		q.shortest	= FindShortestPath(size, nodes, q.start, q.end);
+	}
+
+	std::cout << GetMapName(map) << " " << size << "x" << size
+		<< " - built in " << std::fixed << std::setprecision(1)
+		<< std::chrono::duration<double, std::milli>(endTime - startTime).count() << "ms" << std::endl;
+	if (hierarchy) {
+		std::cout << settings.clusterSize << "x" << settings.clusterSize << " clusters - built in " << hierarchyTime << "ms, "
+			<< hierarchy->GetEntranceCount() << " entrances" << std::endl;
+	}
+
+	std::cout << std::setw(8) << "Search"
+		<< std::setw(12) << "Avg ms"
+		<< std::setw(12) << "p99 ms"
+		<< std::setw(14) << "Expansions"
+		<< std::setw(12) << "Length"
+		<< std::setw(8) << "Found"
+		<< std::setw(8) << "Longer"
+		<< std::setw(8) << "Wrong"
+		<< std::endl;
+
+	for (SearchType s : settings.searches) {
+		RunSearches(grid, hierarchy, s, size, queries);
+	}
+
+	//Walls a node off, then puts it back, so the map's the same afterwards
+	if (hierarchy && !open.empty()) {
+		auto editStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < settings.edits; ++i) {
+			int node = open[rng() % open.size()];
+			hierarchy->SetNodeType(node % size, node / size, 'x');
+			hierarchy->SetNodeType(node % size, node / size, '.');
+		}
+		double editTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - editStart).count();
+		std::cout << "Changing a node and rebuilding its clusters takes " << std::setprecision(4)
+			<< editTime / (settings.edits * 2) << "ms" << std::endl;
+	}
+	delete hierarchy;
+	std::cout << std::endl;
+}
+
+static bool ParseMaps(const char* arg, std::vector<MapType>& maps) {
+	maps.clear();
+	if (!strcmp(arg, "all")) {
+		maps = { MapType::Maze, MapType::Caves, MapType::Rooms };
+	}
+	else if (!strcmp(arg, "maze"))	maps.emplace_back(MapType::Maze);
+	else if (!strcmp(arg, "caves"))	maps.emplace_back(MapType::Caves);
+	else if (!strcmp(arg, "rooms"))	maps.emplace_back(MapType::Rooms);
+	return !maps.empty();
+}
+
+static bool ParseSearches(const char* arg, std::vector<SearchType>& searches) {
+	searches.clear();
+	if (!strcmp(arg, "all")) {
+		searches = { SearchType::AStar, SearchType::JumpPoint, SearchType::JumpPointPlus, SearchType::Hierarchical };
+	}
+	else if (!strcmp(arg, "astar"))	searches.emplace_back(SearchType::AStar);
+	else if (!strcmp(arg, "jps"))	searches.emplace_back(SearchType::JumpPoint);
+	else if (!strcmp(arg, "jps+"))	searches.emplace_back(SearchType::JumpPointPlus);
+	else if (!strcmp(arg, "hpa"))	searches.emplace_back(SearchType::Hierarchical);
+	return !searches.empty();
+}
+
+static bool ParseSizes(const char* arg, std::vector<int>& sizes) {
+	sizes.clear();
+	std::string list(arg);
+	size_t start = 0;
+	while (start < list.size()) {
+		size_t end = list.find(',', start);
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		int size = atoi(list.substr(start, end - start).c_str());
+		if (size < 3) {
+			return false;
+		}
+		sizes.emplace_back(size);
+		start = end + 1;
+	}
+	return !sizes.empty();
+}
+
+static bool ParseArguments(int argc, char** argv, BenchmarkSettings& settings) {
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 >= argc) {
+			return false;
+		}
+		const char* option	= argv[i];
+		const char* value	= argv[++i];
+
+		if (!strcmp(option, "-map")) {
+			if (!ParseMaps(value, settings.maps)) return false;
+		}
+		else if (!strcmp(option, "-size")) {
+			if (!ParseSizes(value, settings.sizes)) return false;
+		}
+		else if (!strcmp(option, "-search")) {
+			if (!ParseSearches(value, settings.searches)) return false;
+		}
+		else if (!strcmp(option, "-cluster")) {
+			settings.clusterSize = std::max(2, atoi(value));
+		}
+		else if (!strcmp(option, "-queries")) {
+			settings.queries = std::max(1, atoi(value));
+		}
+		else if (!strcmp(option, "-seed")) {
+			settings.seed = (unsigned)atoi(value);
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	BenchmarkSettings settings;
+	if (!ParseArguments(argc, argv, settings)) {
+		std::cout << "Usage: PathfindingBenchmark [-map maze|caves|rooms|all] [-size n[,n...]] [-search astar|jps|jps+|hpa|all]\n"
+			<< "                            [-cluster n] [-queries n] [-seed n]" << std::endl;
+		return 1;
+	}
+
+	for (MapType m : settings.maps) {
+		for (int size : settings.sizes) {
+			RunBenchmark(m, size, settings);
+		}
+	}
+	return 0;
+}
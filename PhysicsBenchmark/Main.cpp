@@ -0,0 +1,658 @@
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "PhysicsSystem.h"
+#include "PhysicsObject.h"
+#include "PositionConstraint.h"
+#include "AABBVolume.h"
+#include "OBBVolume.h"
+#include "SphereVolume.h"
+#include "CollisionBatch.h"
+#include "CollisionDetection.h"
+#include "SimdFloat.h"
+#include "GameTimer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+
+Builds the same scenes as TutorialGame's InitSphereGridWorld,
+InitCubeGridWorld, InitMixedGridWorld and BridgeConstraintTest, without
+any meshes, textures or window, and steps them for a set number of frames.
+
+Each Update is given exactly one fixed step of time, so every frame is one
+physics step, and the latency of a step is the time its Update took. Run
+it before and after a physics change, with the same arguments, to see what
+the change did.
+
+Usage: PhysicsBenchmark [options]
+	-scene sphere|cube|mixed|bridge|all		(default all)
+	-bodies n[,n...]						(default 1000,10000,100000)
+	-frames n								(default 600)
+	-warmup n								(default 60, not measured)
+	-broadphase none|quadtree|tree|sap[,...]|all	(default tree)
+	-csv file / -trace file					write out every measured frame
+	-header 0								don't print the column names
+	-narrowphase n							time the narrowphase tests on n pairs instead
+
+Every scene is run with every body count and every broadphase asked for -
+all runs each of the broadphase containers in turn, to compare them (e.g.
+-scene sphere -bodies 256,1024,4096 -broadphase all). The csv and trace
+files get the scene, body count and broadphase added to their names.
+
+Peak MB is the most memory the process ever had in use, so when there's
+more than one run, each of them is run in its own process - the benchmark
+starts itself again with just that run's options (and -header 0, so it
+only prints its row), and waits for it to finish.
+
+-narrowphase doesn't step any scenes - it times the narrowphase tests for
+each combination of volume types the batched tests handle, comparing pairs
+per second through ObjectIntersection against BatchIntersection. The
+objects are scattered randomly in a small space, so a good share of the
+pairs overlap, and the hit counts of both are printed so they can be
+checked against each other.
+
+*/
+
+enum class Scene {
+	SphereGrid,
+	CubeGrid,
+	MixedGrid,
+	Bridge
+};
+
+struct BroadPhase {
+	const char*			name;
+	bool				enabled;
+	BroadPhaseContainer	container;
+};
+
+static const BroadPhase broadPhaseOptions[] = {
+	{ "none",		false,	BroadPhaseContainer::QuadTree },
+	{ "quadtree",	true,	BroadPhaseContainer::QuadTree },
+	{ "tree",		true,	BroadPhaseContainer::DynamicTree },
+	{ "sap",		true,	BroadPhaseContainer::SweepAndPrune }
+};
+
+struct BenchmarkSettings {
+	std::vector<Scene>				scenes		= { Scene::SphereGrid, Scene::CubeGrid, Scene::MixedGrid, Scene::Bridge };
+	std::vector<int>				bodyCounts	= { 1000, 10000, 100000 };
+	std::vector<const BroadPhase*>	broadPhases	= { &broadPhaseOptions[2] };
+	int		frames			= 600;
+	int		warmupFrames	= 60;
+	int		narrowPhasePairs	= 0;
+	bool	printHeader		= true;
+	std::string csvFile;
+	std::string traceFile;
+};
+
+static const char* GetSceneName(Scene s) {
+	switch (s) {
+		case Scene::SphereGrid:	return "SphereGrid";
+		case Scene::CubeGrid:	return "CubeGrid";
+		case Scene::MixedGrid:	return "MixedGrid";
+		case Scene::Bridge:		return "Bridge";
+	}
+	return "Unknown";
+}
+
+//What to pass to -scene to get just this one
+static const char* GetSceneOption(Scene s) {
+	switch (s) {
+		case Scene::SphereGrid:	return "sphere";
+		case Scene::CubeGrid:	return "cube";
+		case Scene::MixedGrid:	return "mixed";
+		case Scene::Bridge:		return "bridge";
+	}
+	return "all";
+}
+
+static size_t GetPeakMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return (size_t)usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+class PhysicsBenchmark {
+public:
+	PhysicsBenchmark() {
+		physics = new PhysicsSystem(world);
+	}
+
+	~PhysicsBenchmark() {
+		world.ClearAndErase();
+		delete physics;
+	}
+
+	void BuildScene(Scene s, int count) {
+		world.ClearAndErase();
+		physics->Clear();
+		srand(0); //The mixed grid should be the same mix every run
+		bodyCount = 0;
+
+		//The grid scenes are kept as square as possible
+		int cols = std::max(1, (int)std::sqrt((float)count));
+		int rows = std::max(1, (count + cols - 1) / cols);
+		float spacing = 3.5f;
+
+		switch (s) {
+			case Scene::SphereGrid:	InitSphereGridWorld(rows, cols, spacing, spacing, 1.0f); break;
+			case Scene::CubeGrid:	InitCubeGridWorld(rows, cols, spacing, spacing, Vector3(1, 1, 1)); break;
+			case Scene::MixedGrid:	InitMixedGridWorld(rows, cols, spacing, spacing); break;
+			case Scene::Bridge:		InitBridges(count); return;
+		}
+		//Without a floor the grids would just fall forever, and never touch anything
+		Vector3 gridHalfSize = Vector3((cols + 1) * spacing, 0, (rows + 1) * spacing) * 0.5f;
+		AddFloorToWorld(gridHalfSize + Vector3(0, -2, 0), gridHalfSize + Vector3(10, 2, 10));
+	}
+
+	PhysicsSystem& GetPhysics() {
+		return *physics;
+	}
+
+	int GetBodyCount() const {
+		return bodyCount;
+	}
+
+protected:
+	void InitSphereGridWorld(int numRows, int numCols, float rowSpacing, float colSpacing, float radius) {
+		for (int x = 0; x < numCols; ++x) {
+			for (int z = 0; z < numRows; ++z) {
+				Vector3 position = Vector3(x * colSpacing, 10.0f, z * rowSpacing);
+				AddSphereToWorld(position, radius, 1.0f);
+			}
+		}
+	}
+
+	void InitMixedGridWorld(int numRows, int numCols, float rowSpacing, float colSpacing) {
+		float sphereRadius = 1.0f;
+		Vector3 cubeDims = Vector3(1, 1, 1);
+
+		for (int x = 0; x < numCols; ++x) {
+			for (int z = 0; z < numRows; ++z) {
+				Vector3 position = Vector3(x * colSpacing, 10.0f, z * rowSpacing);
+
+				if (rand() % 2) {
+					AddCubeToWorld(position, cubeDims);
+				}
+				else {
+					AddSphereToWorld(position, sphereRadius);
+				}
+			}
+		}
+	}
+
+	void InitCubeGridWorld(int numRows, int numCols, float rowSpacing, float colSpacing, const Vector3& cubeDims) {
+		for (int x = 1; x < numCols + 1; ++x) {
+			for (int z = 1; z < numRows + 1; ++z) {
+				Vector3 position = Vector3(x * colSpacing, 10.0f, z * rowSpacing);
+				AddCubeToWorld(position, cubeDims, 1.0f);
+			}
+		}
+	}
+
+	//As many of BridgeConstraintTest's bridges as it takes, side by side
+	void InitBridges(int bodyCount) {
+		Vector3 cubeSize = Vector3(8, 8, 8);
+
+		float invCubeMass	= 5;
+		int numLinks		= 10;
+		float maxDistance	= 30;
+		float cubeDistance	= 20;
+
+		int numBridges = std::max(1, bodyCount / (numLinks + 2));
+
+		for (int b = 0; b < numBridges; ++b) {
+			Vector3 startPos = Vector3(50, 50, 50 + b * cubeSize.z * 3);
+
+			GameObject* start	= AddCubeToWorld(startPos, cubeSize, 0);
+			GameObject* end		= AddCubeToWorld(startPos + Vector3((numLinks + 2) * cubeDistance, 0, 0), cubeSize, 0);
+			GameObject* prev	= start;
+
+			for (int i = 0; i < numLinks; i++) {
+				GameObject* block = AddCubeToWorld(startPos + Vector3((i + 1) * cubeDistance, 0, 0), cubeSize, invCubeMass);
+				world.AddConstraint(new PositionConstraint(prev, block, maxDistance));
+				prev = block;
+			}
+			world.AddConstraint(new PositionConstraint(prev, end, maxDistance));
+		}
+	}
+
+	GameObject* AddFloorToWorld(const Vector3& position, const Vector3& floorSize) {
+		GameObject* floor = new GameObject();
+
+		AABBVolume* volume = new AABBVolume(floorSize);
+		floor->SetBoundingVolume((CollisionVolume*)volume);
+		floor->GetTransform()
+			.SetScale(floorSize * 2)
+			.SetPosition(position);
+
+		floor->SetPhysicsObject(new PhysicsObject(&floor->GetTransform(), floor->GetBoundingVolume()));
+
+		floor->GetPhysicsObject()->SetInverseMass(0);
+		floor->GetPhysicsObject()->InitCubeInertia();
+
+		world.AddGameObject(floor);
+		bodyCount++;
+
+		return floor;
+	}
+
+	GameObject* AddSphereToWorld(const Vector3& position, float radius, float inverseMass = 10.0f) {
+		GameObject* sphere = new GameObject();
+
+		SphereVolume* volume = new SphereVolume(radius);
+		sphere->SetBoundingVolume((CollisionVolume*)volume);
+
+		sphere->GetTransform()
+			.SetScale(Vector3(radius, radius, radius))
+			.SetPosition(position);
+
+		sphere->SetPhysicsObject(new PhysicsObject(&sphere->GetTransform(), sphere->GetBoundingVolume()));
+
+		sphere->GetPhysicsObject()->SetInverseMass(inverseMass);
+		sphere->GetPhysicsObject()->InitSphereInertia();
+
+		world.AddGameObject(sphere);
+		bodyCount++;
+
+		return sphere;
+	}
+
+	GameObject* AddCubeToWorld(const Vector3& position, Vector3 dimensions, float inverseMass = 10.0f) {
+		GameObject* cube = new GameObject();
+
+		AABBVolume* volume = new AABBVolume(dimensions);
+		cube->SetBoundingVolume((CollisionVolume*)volume);
+
+		cube->GetTransform()
+			.SetPosition(position)
+			.SetScale(dimensions * 2);
+
+		cube->SetPhysicsObject(new PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
+
+		cube->GetPhysicsObject()->SetInverseMass(inverseMass);
+		cube->GetPhysicsObject()->InitCubeInertia();
+
+		world.AddGameObject(cube);
+		bodyCount++;
+
+		return cube;
+	}
+
+	GameWorld		world;
+	PhysicsSystem*	physics;
+	int				bodyCount = 0;
+};
+
+static std::string AddToFilename(const std::string& filename, const std::string& suffix) {
+	size_t dot = filename.find_last_of('.');
+	if (dot == std::string::npos) {
+		return filename + suffix;
+	}
+	return filename.substr(0, dot) + suffix + filename.substr(dot);
+}
+
+static void RunBenchmark(PhysicsBenchmark& benchmark, Scene scene, int requestedBodies, const BroadPhase& broadPhase, const BenchmarkSettings& settings) {
+	benchmark.BuildScene(scene, requestedBodies);
+
+	PhysicsSystem&		physics		= benchmark.GetPhysics();
+	PhysicsProfiler&	profiler	= physics.GetProfiler();
+
+	physics.UseGravity(true);
+	physics.UseBroadPhase(broadPhase.enabled);
+	physics.SetBroadPhaseContainer(broadPhase.container);
+
+	float dt = physics.GetFixedTimestep();
+
+	for (int i = 0; i < settings.warmupFrames; ++i) {
+		physics.Update(dt);
+	}
+
+	profiler.Reset();
+	profiler.ClearRecording();
+	profiler.StartRecording();
+
+	std::vector<float> stepTimes;
+	stepTimes.reserve(settings.frames);
+	for (int i = 0; i < settings.frames; ++i) {
+		physics.Update(dt);
+		stepTimes.emplace_back(profiler.GetLastFrame().totalTime);
+	}
+	profiler.StopRecording();
+
+	const PhysicsProfiler::Frame& totals = profiler.GetTotals();
+	int steps = totals.counts[PhysicsProfiler::Steps];
+
+	std::sort(stepTimes.begin(), stepTimes.end());
+	auto percentile = [&](float p) {
+		if (stepTimes.empty()) {
+			return 0.0f;
+		}
+		int i = std::min((int)stepTimes.size() - 1, (int)(p * stepTimes.size()));
+		return stepTimes[i];
+	};
+
+	std::cout << std::left << std::setw(12) << GetSceneName(scene)
+		<< std::right << std::setw(8) << benchmark.GetBodyCount()
+		<< std::setw(12) << broadPhase.name
+		<< std::fixed << std::setprecision(1)
+		<< std::setw(12) << (totals.totalTime > 0.0f ? steps / (totals.totalTime / 1000.0f) : 0.0f)
+		<< std::setprecision(3)
+		<< std::setw(10) << percentile(0.5f)
+		<< std::setw(10) << percentile(0.99f)
+		<< std::setw(12) << totals.counts[PhysicsProfiler::Contacts] / std::max(1, steps)
+		<< std::setw(12) << GetPeakMemory() / (1024 * 1024)
+		<< std::endl;
+
+	std::string suffix = std::string("_") + GetSceneName(scene) + "_" + std::to_string(requestedBodies) + "_" + broadPhase.name;
+	if (!settings.csvFile.empty() && !profiler.WriteCSV(AddToFilename(settings.csvFile, suffix))) {
+		std::cout << "Couldn't write " << AddToFilename(settings.csvFile, suffix) << std::endl;
+	}
+	if (!settings.traceFile.empty() && !profiler.WriteChromeTrace(AddToFilename(settings.traceFile, suffix))) {
+		std::cout << "Couldn't write " << AddToFilename(settings.traceFile, suffix) << std::endl;
+	}
+	profiler.ClearRecording();
+}
+
+static std::string Quote(const std::string& arg) {
+	return "\"" + arg + "\"";
+}
+
+static bool RunInOwnProcess(const char* program, Scene scene, int requestedBodies, const BroadPhase& broadPhase, const BenchmarkSettings& settings) {
+	std::string command = Quote(program)
+		+ " -scene "		+ GetSceneOption(scene)
+		+ " -bodies "		+ std::to_string(requestedBodies)
+		+ " -broadphase "	+ broadPhase.name
+		+ " -frames "		+ std::to_string(settings.frames)
+		+ " -warmup "		+ std::to_string(settings.warmupFrames)
+		+ " -header 0";
+	if (!settings.csvFile.empty()) {
+		command += " -csv " + Quote(settings.csvFile);
+	}
+	if (!settings.traceFile.empty()) {
+		command += " -trace " + Quote(settings.traceFile);
+	}
+#ifdef _WIN32
+	command = Quote(command);	//cmd takes the first and last quotes off the whole line
+#endif
+	std::cout.flush();
+	return std::system(command.c_str()) == 0;
+}
+
+static GameObject* MakeNarrowPhaseObject(VolumeType type) {
+	GameObject* object = new GameObject();
+	Vector3 halfSize(0.3f + (rand() % 100) / 80.0f, 0.3f + (rand() % 100) / 80.0f, 0.3f + (rand() % 100) / 80.0f);
+	if (type == VolumeType::Sphere) {
+		object->SetBoundingVolume((CollisionVolume*)new SphereVolume(halfSize.x));
+	}
+	else if (type == VolumeType::AABB) {
+		object->SetBoundingVolume((CollisionVolume*)new AABBVolume(halfSize));
+	}
+	else {
+		object->SetBoundingVolume((CollisionVolume*)new OBBVolume(halfSize));
+		object->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion((float)(rand() % 360), (float)(rand() % 360), (float)(rand() % 360)));
+	}
+	object->GetTransform().SetScale(halfSize * 2.0f);
+	object->GetTransform().SetPosition(Vector3((rand() % 400) / 100.0f, (rand() % 400) / 100.0f, (rand() % 400) / 100.0f));
+	return object;
+}
+
+static void RunNarrowPhaseBenchmark(int pairCount) {
+	const int runCount = 20;
+
+	const VolumeType combos[][2] = {
+		{ VolumeType::Sphere,	VolumeType::Sphere },
+		{ VolumeType::AABB,		VolumeType::AABB },
+		{ VolumeType::AABB,		VolumeType::Sphere },
+		{ VolumeType::OBB,		VolumeType::Sphere },
+		{ VolumeType::OBB,		VolumeType::OBB },
+		{ VolumeType::OBB,		VolumeType::AABB }
+	};
+	const char* comboNames[] = { "Sphere/Sphere", "AABB/AABB", "AABB/Sphere", "OBB/Sphere", "OBB/OBB", "OBB/AABB" };
+
+	std::cout << "Batched tests are " << SimdFloat::Width << " pairs wide\n";
+	std::cout << std::left << std::setw(16) << "Volumes"
+		<< std::right << std::setw(14) << "Scalar M/s"
+		<< std::setw(14) << "Batched M/s"
+		<< std::setw(10) << "Speedup"
+		<< std::setw(14) << "Scalar hits"
+		<< std::setw(14) << "Batched hits"
+		<< std::endl;
+
+	srand(0);
+	for (int c = 0; c < 6; ++c) {
+		std::vector<GameObject*> objectsA;
+		std::vector<GameObject*> objectsB;
+		for (int i = 0; i < pairCount; ++i) {
+			objectsA.push_back(MakeNarrowPhaseObject(combos[c][0]));
+			objectsB.push_back(MakeNarrowPhaseObject(combos[c][1]));
+		}
+		bool swapped;
+		CollisionBatch batch(CollisionBatch::GetPairType(objectsA[0], objectsB[0], swapped));
+		for (int i = 0; i < pairCount; ++i) {
+			if (swapped) {
+				batch.AddPair(objectsB[i], objectsA[i]);
+			}
+			else {
+				batch.AddPair(objectsA[i], objectsB[i]);
+			}
+		}
+
+		std::vector<CollisionDetection::CollisionInfo> collisions;
+		collisions.reserve(pairCount);
+
+		int scalarHits = 0;
+		GameTimer timer;
+		for (int run = 0; run < runCount; ++run) {
+			collisions.clear();
+			for (int i = 0; i < pairCount; ++i) {
+				CollisionDetection::CollisionInfo info;
+				if (CollisionDetection::ObjectIntersection(objectsA[i], objectsB[i], info)) {
+					collisions.push_back(info);
+				}
+			}
+			scalarHits = (int)collisions.size();
+		}
+		timer.Tick();
+		float scalarTime = timer.GetTimeDeltaSeconds();
+
+		int batchHits = 0;
+		for (int run = 0; run < runCount; ++run) {
+			collisions.clear();
+			CollisionDetection::BatchIntersection(batch, 0, pairCount, collisions);
+			batchHits = (int)collisions.size();
+		}
+		timer.Tick();
+		float batchTime = timer.GetTimeDeltaSeconds();
+
+		float scalarRate	= (pairCount * runCount) / scalarTime / 1000000.0f;
+		float batchRate		= (pairCount * runCount) / batchTime / 1000000.0f;
+
+		std::cout << std::left << std::setw(16) << comboNames[c]
+			<< std::right << std::fixed << std::setprecision(2)
+			<< std::setw(14) << scalarRate
+			<< std::setw(14) << batchRate
+			<< std::setw(9) << batchRate / scalarRate << "x"
+			<< std::setw(14) << scalarHits
+			<< std::setw(14) << batchHits
+			<< std::endl;
+
+		for (int i = 0; i < pairCount; ++i) {
+			delete objectsA[i];
+			delete objectsB[i];
+		}
+	}
+}
+
+static bool ParseScenes(const char* arg, std::vector<Scene>& scenes) {
+	scenes.clear();
+	if (!strcmp(arg, "all")) {
+		scenes = { Scene::SphereGrid, Scene::CubeGrid, Scene::MixedGrid, Scene::Bridge };
+	}
+	else if (!strcmp(arg, "sphere"))	scenes.emplace_back(Scene::SphereGrid);
+	else if (!strcmp(arg, "cube"))		scenes.emplace_back(Scene::CubeGrid);
+	else if (!strcmp(arg, "mixed"))		scenes.emplace_back(Scene::MixedGrid);
+	else if (!strcmp(arg, "bridge"))	scenes.emplace_back(Scene::Bridge);
+	return !scenes.empty();
+}
+
+static bool ParseBodyCounts(const char* arg, std::vector<int>& counts) {
+	counts.clear();
+	std::string list(arg);
+	size_t start = 0;
+	while (start < list.size()) {
+		size_t end = list.find(',', start);
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		int count = atoi(list.substr(start, end - start).c_str());
+		if (count <= 0) {
+			return false;
+		}
+		counts.emplace_back(count);
+		start = end + 1;
+	}
+	return !counts.empty();
+}
+
+//all is just the containers - without a broadphase, the bigger scenes would take forever
+static bool ParseBroadPhases(const char* arg, std::vector<const BroadPhase*>& chosen) {
+	chosen.clear();
+	if (!strcmp(arg, "all")) {
+		chosen = { &broadPhaseOptions[1], &broadPhaseOptions[2], &broadPhaseOptions[3] };
+		return true;
+	}
+	std::string list(arg);
+	size_t start = 0;
+	while (start < list.size()) {
+		size_t end = list.find(',', start);
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		std::string name = list.substr(start, end - start);
+		auto found = std::find_if(std::begin(broadPhaseOptions), std::end(broadPhaseOptions), [&](const BroadPhase& b) {
+			return name == b.name;
+		});
+		if (found == std::end(broadPhaseOptions)) {
+			return false;
+		}
+		chosen.emplace_back(&*found);
+		start = end + 1;
+	}
+	return !chosen.empty();
+}
+
+static bool ParseArguments(int argc, char** argv, BenchmarkSettings& settings) {
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 >= argc) {
+			return false;
+		}
+		const char* option	= argv[i];
+		const char* value	= argv[++i];
+
+		if (!strcmp(option, "-scene")) {
+			if (!ParseScenes(value, settings.scenes)) return false;
+		}
+		else if (!strcmp(option, "-bodies")) {
+			if (!ParseBodyCounts(value, settings.bodyCounts)) return false;
+		}
+		else if (!strcmp(option, "-frames")) {
+			settings.frames = std::max(1, atoi(value));
+		}
+		else if (!strcmp(option, "-warmup")) {
+			settings.warmupFrames = std::max(0, atoi(value));
+		}
+		else if (!strcmp(option, "-broadphase")) {
+			if (!ParseBroadPhases(value, settings.broadPhases)) return false;
+		}
+		else if (!strcmp(option, "-csv")) {
+			settings.csvFile = value;
+		}
+		else if (!strcmp(option, "-trace")) {
+			settings.traceFile = value;
+		}
+		else if (!strcmp(option, "-narrowphase")) {
+			settings.narrowPhasePairs = atoi(value);
+			if (settings.narrowPhasePairs <= 0) return false;
+		}
+		else if (!strcmp(option, "-header")) {
+			settings.printHeader = atoi(value) != 0;
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	BenchmarkSettings settings;
+	if (!ParseArguments(argc, argv, settings)) {
+		std::cout << "Usage: PhysicsBenchmark [-scene sphere|cube|mixed|bridge|all] [-bodies n[,n...]] [-frames n] [-warmup n]\n"
+			<< "                        [-broadphase none|quadtree|tree|sap[,...]|all] [-csv file] [-trace file]\n"
+			<< "       PhysicsBenchmark -narrowphase n" << std::endl;
+		return 1;
+	}
+	if (settings.narrowPhasePairs > 0) {
+		RunNarrowPhaseBenchmark(settings.narrowPhasePairs);
+		return 0;
+	}
+
+	if (settings.printHeader) {
+		std::cout << std::left << std::setw(12) << "Scene"
+			<< std::right << std::setw(8) << "Bodies"
+			<< std::setw(12) << "Broadphase"
+			<< std::setw(12) << "Steps/sec"
+			<< std::setw(10) << "p50 ms"
+			<< std::setw(10) << "p99 ms"
+			<< std::setw(12) << "Contacts"
+			<< std::setw(12) << "Peak MB"
+			<< std::endl;
+	}
+
+	size_t runCount = settings.scenes.size() * settings.bodyCounts.size() * settings.broadPhases.size();
+	if (runCount == 1) {
+		PhysicsBenchmark benchmark;
+		RunBenchmark(benchmark, settings.scenes[0], settings.bodyCounts[0], *settings.broadPhases[0], settings);
+		return 0;
+	}
+
+	int failed = 0;
+	for (Scene s : settings.scenes) {
+		for (int count : settings.bodyCounts) {
+			for (const BroadPhase* b : settings.broadPhases) {
+				if (!RunInOwnProcess(argv[0], s, count, *b, settings)) {
+					std::cout << GetSceneName(s) << " with " << count << " bodies and broadphase " << b->name << " failed" << std::endl;
+					failed++;
+				}
+			}
+		}
+	}
+	return failed > 0 ? 1 : 0;
+}